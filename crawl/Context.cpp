@@ -17,11 +17,15 @@ Context::NetContext::start(net::SessionHandler &s)
     oop::Session *session = static_cast<oop::Session*>(&s);
     const Link l(context, session);
 
+    session->set_format(context->format);
     session->register_crawler();
 }
 
 // Context
-Context::Context(const string &name, uint16_t cores) :
+Context::Context(const string &name,
+                 uint16_t cores,
+                 net::oop::Message::Format format) :
+    format(format),
     crawler(name, cores),
     net_context(this),
     creator(net_context),
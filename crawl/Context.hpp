@@ -19,7 +19,9 @@ class Context : public Linker
 {
     public:
         /* Member functions/methods */
-        Context(const std::string &name, uint16_t cores);
+        Context(const std::string &name,
+                uint16_t cores,
+                net::oop::Message::Format format = net::oop::Message::Binary);
 
         Crawler& get_crawler() { return crawler; }
 
@@ -37,6 +39,7 @@ class Context : public Linker
         };
         
         /* Member variables/attributes */
+        const net::oop::Message::Format format; // Of the messages sent
 
         /*
          * Asynchronous task dispatcher
@@ -1,8 +1,14 @@
 // oodles
 #include "Crawler.hpp"
+#include "utility/hash.hpp"
 
 // STL
+using std::map;
+using std::pair;
+using std::deque;
 using std::string;
+using std::vector;
+using std::make_pair;
 
 namespace oodles {
 namespace crawl {
@@ -19,6 +25,42 @@ Crawler::fetch(const url::URL &url)
     urls[url.domain_id()].push_back(url);
 }
 
+void
+Crawler::fetch(const vector<url::URL> &host)
+{
+    if (host.empty())
+        return;
+
+    deque<url::URL> &q = urls[host.front().domain_id()];
+    q.insert(q.end(), host.begin(), host.end());
+}
+
+/*
+ * Record the fingerprint of the content fetched from url. Returns true if
+ * it differs from that of the previous fetch (or there was none).
+ */
+bool
+Crawler::fingerprint(const url::URL &url, const string &content)
+{
+#ifdef HAS_64_BITS
+    const url::URL::hash_t current = fnv64(content.data(), content.size());
+#else
+    const url::URL::hash_t current = fnv32(content.data(), content.size());
+#endif
+    const pair<map<url::URL::hash_t, url::URL::hash_t>::iterator, bool>
+        i = fingerprints.insert(make_pair(url.page_id(), current));
+
+    if (i.second)
+        return true; // First fetch
+
+    if (i.first->second == current)
+        return false;
+
+    i.first->second = current;
+
+    return true;
+}
+
 } // crawl
 } // oodles
 
@@ -6,8 +6,9 @@
 
 // STL
 #include <map>
-#include <list>
+#include <deque>
 #include <string>
+#include <vector>
 
 namespace oodles {
 namespace crawl {
@@ -22,11 +23,14 @@ class Crawler
         const std::string& id() const { return name; }
 
         void fetch(const url::URL &url);
+        void fetch(const std::vector<url::URL> &host); // URLs of one host
+        bool fingerprint(const url::URL &url, const std::string &content);
     private:
         /* Member variables/attributes */
         const uint16_t cpus;
         const std::string name;
-        std::map<url::URL::hash_t, std::list<url::URL> > urls;
+        std::map<url::URL::hash_t, std::deque<url::URL> > urls; // By domain
+        std::map<url::URL::hash_t, url::URL::hash_t> fingerprints; // By page
 };
 
 } // crawl
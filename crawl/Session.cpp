@@ -5,6 +5,7 @@
 
 // STL
 using std::list;
+using std::pair;
 using std::string;
 using std::vector;
 using std::make_pair;
@@ -56,16 +57,19 @@ Session::register_crawler()
 }
 
 void
-Session::end_crawl(const list<url::URL> &urls)
+Session::end_crawl(const list<pair<url::URL, EndCrawl::Result> > &urls,
+                   const EndCrawl::ResponseTimes &times)
 {
     EndCrawl *m = new EndCrawl;
-    list<url::URL>::const_iterator i = urls.begin(), j = urls.end();
+    list<pair<url::URL, EndCrawl::Result> >::const_iterator i = urls.begin(),
+                                                            j = urls.end();
     
     while (i != j) {
-        m->scheduled_urls.push_back(make_pair(i->page_id(), true)); // FIXME
+        m->scheduled_urls.push_back(make_pair(i->first.page_id(), i->second));
         ++i;
     }
 
+    m->response_times = times;
     send(m);
 }
 
@@ -135,12 +139,8 @@ Session::continue_dialog(const BeginCrawl &m)
      * all URLs given in m as scheduled by the Scheduler that
      * sent this message.
      */
-    list<url::URL*>::const_iterator i = m.urls.begin(), j = m.urls.end();
-
-    while (i != j) {
-        const url::URL &u = *(*i);
-        crawler().fetch(u);
-    }
+    for (size_t i = 0 ; i < m.hosts.size() ; ++i)
+        crawler().fetch(m.hosts[i]);
 }
 
 } // oop
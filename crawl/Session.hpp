@@ -40,11 +40,16 @@ class Session : public net::oop::Session
 
         /*
          * The crawler will return a list of URLs to the scheduler once it
-         * has (attmpted) to crawl them. The state (success/failure) of the
-         * URL is sent along with it. Generally the list of URLs provided here
-         * will be from the same domain.
+         * has (attmpted) to crawl them. The result (failure, or whether the
+         * content changed) of the URL is sent along with it. Generally the
+         * list of URLs provided here will be from the same domain. How long
+         * each URL fetched took to respond, if measured, goes with them in
+         * times; the scheduler adapts its delay for the host from them.
          */
-        void end_crawl(const std::list<url::URL> &urls);
+        void end_crawl(const std::list<std::pair<url::URL,
+                                                 EndCrawl::Result> > &urls,
+                       const EndCrawl::ResponseTimes &times =
+                           EndCrawl::ResponseTimes());
     private:
         /* Member functions/methods */
         void send(Message *m);
@@ -10,6 +10,9 @@
 // Boost.bind
 #include <boost/bind.hpp>
 
+// Boost.thread
+#include <boost/thread/locks.hpp>
+
 // Boost.asio
 #include <boost/asio/placeholders.hpp>
 
@@ -52,6 +55,8 @@ Endpoint::Metric::update(size_t bytes)
 }
 
 Endpoint::Endpoint(Dispatcher &d) :
+    held(false),
+    stalled(false),
     dispatcher(d),
     session(NULL),
     protocol(NULL),
@@ -118,6 +123,27 @@ Endpoint::print_metrics(std::ostream *s) const
        << '\n';
 }
 
+void
+Endpoint::hold_recv()
+{
+    const boost::lock_guard<boost::mutex> lock(hold_guard);
+    held = true;
+}
+
+void
+Endpoint::release_recv()
+{
+    const boost::lock_guard<boost::mutex> lock(hold_guard);
+
+    held = false;
+
+    if (stalled) {
+        stalled = false;
+        dispatcher.io_service().post(bind(&Endpoint::resume_recv,
+                                          shared_from_this()));
+    }
+}
+
 void
 Endpoint::set_session(SessionHandler *s)
 {
@@ -180,6 +206,12 @@ Endpoint::async_send(const char *ptr, size_t max)
                               placeholders::bytes_transferred));
 }
 
+void
+Endpoint::resume_recv()
+{
+    protocol->receive_data();
+}
+
 void
 Endpoint::raw_recv_callback(const error_code& e, size_t b)
 {
@@ -191,12 +223,21 @@ Endpoint::raw_recv_callback(const error_code& e, size_t b)
         
         n = inbound.consumer().consume_buffer(u);
         protocol->handle_messages(dispatcher);
-        
+        recv_rate.update(b);
+
         /*
-         * Re-register any further reads and update running statistics
+         * Re-register any further reads, unless held back
          */
+        {
+            const boost::lock_guard<boost::mutex> lock(hold_guard);
+
+            if (held) {
+                stalled = true; // See release_recv()
+                return;
+            }
+        }
+
         protocol->receive_data();
-        recv_rate.update(b);
     } else {
         if (e == boost::asio::error::operation_aborted)
             return;
@@ -232,7 +273,13 @@ Endpoint::raw_send_callback(const error_code& e, size_t b)
         
         stop();
         
-        if (e != boost::asio::error::eof)
+        /*
+         * A peer gone is found here, rather than by a read, whilst reads
+         * are held (see hold_recv())
+         */
+        if (e != boost::asio::error::eof &&
+            e != boost::asio::error::broken_pipe &&
+            e != boost::asio::error::connection_reset)
             throw WriteError("Endpoint::raw_send_callback",
                              e.value(),
                              e.message().c_str());
@@ -66,6 +66,15 @@ class Endpoint : public boost::enable_shared_from_this<Endpoint>
         void stop(); // Close socket cancelling pending handlers
         void start(CallerContext &c); // Must be called to prepare reads/writes
         void print_metrics(std::ostream *s) const; // Print raw TCP I/O  metrics
+
+        /*
+         * Backpressure: whilst held, no further reads are registered once
+         * the one pending completes, so the peer is left to fill the socket
+         * buffers. Released, any read held back is registered once more.
+         * Either may be called from any thread.
+         */
+        void hold_recv();
+        void release_recv();
     private:
         /* Internal Data Structures */
         struct Metric 
@@ -99,6 +108,8 @@ class Endpoint : public boost::enable_shared_from_this<Endpoint>
         Buffer<NBS> outbound;
         Metric recv_rate, send_rate;
         boost::mutex recv_guard, send_guard;
+        boost::mutex hold_guard; // Of held and stalled
+        bool held, stalled; // Reads held back, a read is yet to be registered
         
         Dispatcher &dispatcher;
         SessionHandler *session;
@@ -124,6 +135,7 @@ class Endpoint : public boost::enable_shared_from_this<Endpoint>
          */
         void async_recv(char *ptr, size_t max);
         void async_send(const char *ptr, size_t max);
+        void resume_recv(); // Register the read held back
 
         /*
          * Handler executed by io_service when read operation is performed.
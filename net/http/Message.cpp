@@ -9,6 +9,7 @@
 #include <string.h> // For memchr() etc.
 #include <assert.h> // For assert() etc.
 #include <strings.h> // For strncasecmp() etc.
+#include <unistd.h> // For read(), write()
 
 // STL
 using std::string;
@@ -78,6 +79,18 @@ Message::Message(int fd, size_t size) :
         add_header("content-length", to_string<size_t>(size));
 }
 
+Message::Message(const string &body) :
+    fd(-1),
+    content(body),
+    mode(-1),
+    version(0),
+    buffered(0),
+    body_offset(0),
+    body_size(body.size())
+{
+    add_header("content-length", to_string<size_t>(body.size()));
+}
+
 uint16_t
 Message::response_code() const
 {
@@ -184,10 +197,14 @@ Message::to_buffer(char *buffer, size_t max)
     if (!headers_sent())
         used = write_headers(buffer, max);
 
-    if (used < max)
-        used += write_body(buffer + used, max - used);
+    buffered += used; // So pending() counts the body alone
 
-    buffered += used;
+    if (used < max) {
+        const size_t n = write_body(buffer + used, max - used);
+
+        used += n;
+        buffered += n;
+    }
     
     return used;
 }
@@ -330,10 +347,16 @@ Message::read_headers(const char *buffer, size_t max) throw (HeaderError)
 size_t
 Message::write_body(char *buffer, size_t max)
 {
-    if (fd == -1)
-        return 0;
-
     size_t x = pending();
+
+    if (fd == -1) {
+        if (x > max)
+            x = max;
+
+        memcpy(buffer, content.data() + (content.size() - pending()), x);
+        return x;
+    }
+
     return read(fd, buffer, x < max ? x : max);
 }
 
@@ -356,7 +379,7 @@ Message::write_headers(char *buffer, size_t max)
         k = i + 1;
         n = i->key.size() + i->value.size() + 3 + (k == j ? 2 : 0);
 
-        if (n > max)
+        if (x + n > max)
             break; // We can't fit any more full-line headers
 
         memcpy(buffer + x, i->key.c_str(), i->key.size());
@@ -370,8 +393,8 @@ Message::write_headers(char *buffer, size_t max)
         memcpy(buffer + x + 1, &LF, 1);
         x += 2;
 
-        headers.erase(i);
-        i = k;
+        i = headers.erase(i); // Now the header that followed it
+        j = headers.end();
     }
 
     /*
@@ -22,13 +22,15 @@ namespace http {
  * descriptor and the offset saved within Message as an X-header.
  *
  * The fd may point to any external resource such as a regular file,
- * a socket or pipe, a shared memory location etc.
+ * a socket or pipe, a shared memory location etc. A body to be sent may
+ * instead be given as a string, when it is generated in memory.
  */
 class Message
 {
     public:
         /* Member functions/methods */
         Message(int fd = -1, size_t size = 0);
+        explicit Message(const std::string &body); // Sent from memory
 
         /* Client-side interface */
         uint16_t response_code() const;
@@ -101,6 +103,7 @@ class Message
 
         /* Member variables/attributes */
         int fd;
+        std::string content; // Body, when there's no fd
         int mode;
         float version;
         Trigram start_line;
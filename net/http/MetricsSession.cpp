@@ -0,0 +1,49 @@
+// oodles
+#include "Message.hpp"
+#include "MetricsSession.hpp"
+
+// STL
+#include <sstream>
+
+// STL
+using std::string;
+using std::ostringstream;
+
+namespace oodles {
+namespace net {
+namespace http {
+
+// MetricsSession
+void
+MetricsSession::handle_message(Message *m)
+{
+    const MetricsContext &c =
+        *static_cast<MetricsContext*>(coupling->complement_of(*this));
+    const string &resource = m->request_URI();
+    ostringstream body;
+
+    if (m->request_method() != "GET") {
+        send_response(405, "", "text/plain");
+    } else if (resource == "/metrics") {
+        c.registry.write_text(body);
+        send_response(200, body.str(), "text/plain; version=0.0.4");
+    } else if (resource == "/metrics.json") {
+        c.registry.write_json(body);
+        send_response(200, body.str(), "application/json");
+    } else {
+        send_response(404, "", "text/plain");
+    }
+
+    delete m;
+}
+
+// MetricsContext
+void
+MetricsContext::start(SessionHandler &s)
+{
+    const Link l(this, static_cast<MetricsSession*>(&s));
+}
+
+} // http
+} // net
+} // oodles
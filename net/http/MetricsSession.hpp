@@ -0,0 +1,39 @@
+#ifndef OODLES_NET_HTTP_METRICSSESSION_HPP
+#define OODLES_NET_HTTP_METRICSSESSION_HPP
+
+// oodles
+#include "Session.hpp"
+#include "utility/Linker.hpp"
+#include "utility/Metrics.hpp"
+#include "net/core/CallerContext.hpp"
+
+namespace oodles {
+namespace net {
+namespace http {
+
+/*
+ * Serves the metrics of a Registry to be scraped: GET /metrics returns
+ * them in the Prometheus text format and GET /metrics.json as a JSON
+ * object. Any other resource is not found.
+ */
+class MetricsSession : public Session
+{
+    public:
+        void handle_message(Message *m);
+};
+
+struct MetricsContext : public CallerContext, public Linker
+{
+    metrics::Registry &registry;
+
+    MetricsContext(metrics::Registry &r = metrics::Registry::global()) :
+        registry(r) {}
+
+    void start(SessionHandler &s);
+};
+
+} // http
+} // net
+} // oodles
+
+#endif
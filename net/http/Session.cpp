@@ -40,6 +40,20 @@ Session::send_response(uint16_t code, int data_fd, size_t data_size)
     p.push_message(m);
 }
 
+void
+Session::send_response(uint16_t code,
+                       const std::string &body,
+                       const std::string &type)
+{
+    Protocol &p = *static_cast<Protocol*>(get_endpoint()->get_protocol());
+    static const ResponseCodes &messages = ResponseCodes::instance();
+    Message *m = new Message(body);
+
+    m->add_header("content-type", type);
+    m->respond(code, messages[code]);
+    p.push_message(m);
+}
+
 
 } // http
 } // net
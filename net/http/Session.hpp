@@ -17,6 +17,9 @@ class Session : public Linker, public SessionHandler
         void handle_messages();
         void send_request(const std::string &resource, int response_fd);
         void send_response(uint16_t code, int data_fd, size_t data_size);
+        void send_response(uint16_t code,
+                           const std::string &body,
+                           const std::string &type);
         
         virtual void handle_message(Message *m) = 0; // Ownership transferred
 };
@@ -4,10 +4,15 @@
 // oodles
 #include "url/URL.hpp"
 #include "Accessor.hpp"
+#include "LabelTable.hpp"
+#include "common/Exceptions.hpp"
 
 // Boost.serialization
 #include <boost/serialization/string.hpp>
-#include <boost/serialization/vector.hpp>
+
+// STL
+#include <string>
+#include <vector>
 
 namespace oodles {
 namespace net {
@@ -15,45 +20,313 @@ namespace oop {
 
 struct Accessor
 {
+    /*
+     * A URL on its own has its labels sent as their text
+     */
     template<class Archive>
     static
     void load(Archive &archive, url::URL &url, unsigned int version)
     {
-        archive >> url.id.page;
-        archive >> url.id.path;
-        archive >> url.id.domain;
-
-        archive >> url.attributes.ip;
+        load_ids(archive, url);
 
-        archive >> url.attributes.port;
-        archive >> url.attributes.page;
-        archive >> url.attributes.scheme;
-        archive >> url.attributes.username;
-        archive >> url.attributes.password;
+        load_label(archive, url.attributes.port);
+        load_label(archive, url.attributes.page);
+        load_label(archive, url.attributes.scheme);
+        load_label(archive, url.attributes.username);
+        load_label(archive, url.attributes.password);
 
-        archive >> url.attributes.path;
-        archive >> url.attributes.domain;
+        load_labels(archive, url.attributes.path);
+        load_labels(archive, url.attributes.domain);
     }
 
     template<class Archive>
     static
     void save(Archive &archive, const url::URL &url, unsigned int version)
     {
-        archive << url.id.page;
-        archive << url.id.path;
-        archive << url.id.domain;
+        save_ids(archive, url);
+
+        save_label(archive, url.attributes.port);
+        save_label(archive, url.attributes.page);
+        save_label(archive, url.attributes.scheme);
+        save_label(archive, url.attributes.username);
+        save_label(archive, url.attributes.password);
+
+        save_labels(archive, url.attributes.path);
+        save_labels(archive, url.attributes.domain);
+    }
+
+    /*
+     * The URLs of a message have their labels sent as indices to the
+     * LabelTable sent ahead of them, into which every label of each URL is
+     * first enrolled.
+     */
+    static
+    void enrol(const url::URL &url, LabelTable &labels)
+    {
+        labels.insert(url.attributes.port);
+        labels.insert(url.attributes.page);
+        labels.insert(url.attributes.scheme);
+        labels.insert(url.attributes.username);
+        labels.insert(url.attributes.password);
+
+        for (size_t i = 0 ; i < url.attributes.path.size() ; ++i)
+            labels.insert(url.attributes.path[i]);
+
+        for (size_t i = 0 ; i < url.attributes.domain.size() ; ++i)
+            labels.insert(url.attributes.domain[i]);
+    }
+
+    template<class Archive>
+    static
+    void load(Archive &archive,
+              url::URL &url,
+              const std::vector<Label> &labels)
+    {
+        load_ids(archive, url);
+
+        load_index(archive, url.attributes.port, labels);
+        load_index(archive, url.attributes.page, labels);
+        load_index(archive, url.attributes.scheme, labels);
+        load_index(archive, url.attributes.username, labels);
+        load_index(archive, url.attributes.password, labels);
+
+        load_indices(archive, url.attributes.path, labels);
+        load_indices(archive, url.attributes.domain, labels);
+    }
+
+    template<class Archive>
+    static
+    void save(Archive &archive, const url::URL &url, LabelTable &labels)
+    {
+        save_ids(archive, url);
+
+        archive << labels.insert(url.attributes.port);
+        archive << labels.insert(url.attributes.page);
+        archive << labels.insert(url.attributes.scheme);
+        archive << labels.insert(url.attributes.username);
+        archive << labels.insert(url.attributes.password);
 
+        save_indices(archive, url.attributes.path, labels);
+        save_indices(archive, url.attributes.domain, labels);
+    }
+
+    /*
+     * The URLs of a host are sent as the host, its components but for the
+     * path and page, once and then each path front-coded; the no. of its
+     * leading segments in common with the path before it, then the rest,
+     * then the page. The ids of each URL are not sent but computed once it
+     * is loaded.
+     */
+    template<class Archive>
+    static
+    void save_host(Archive &archive, const url::URL &url, LabelTable &labels)
+    {
         archive << url.attributes.ip;
 
-        archive << url.attributes.port;
-        archive << url.attributes.page;
-        archive << url.attributes.scheme;
-        archive << url.attributes.username;
-        archive << url.attributes.password;
+        archive << labels.insert(url.attributes.port);
+        archive << labels.insert(url.attributes.scheme);
+        archive << labels.insert(url.attributes.username);
+        archive << labels.insert(url.attributes.password);
 
-        archive << url.attributes.path;
-        archive << url.attributes.domain;
+        save_indices(archive, url.attributes.domain, labels);
     }
+
+    template<class Archive>
+    static
+    void load_host(Archive &archive,
+                   url::URL &url,
+                   const std::vector<Label> &labels)
+    {
+        archive >> url.attributes.ip;
+
+        load_index(archive, url.attributes.port, labels);
+        load_index(archive, url.attributes.scheme, labels);
+        load_index(archive, url.attributes.username, labels);
+        load_index(archive, url.attributes.password, labels);
+
+        load_indices(archive, url.attributes.domain, labels);
+    }
+
+    template<class Archive>
+    static
+    void save_path(Archive &archive,
+                   const url::URL &url,
+                   const url::URL *previous, // Of the host, if any
+                   LabelTable &labels)
+    {
+        const std::vector<Label> &path = url.attributes.path;
+        uint32_t shared = 0;
+
+        if (previous) {
+            const std::vector<Label> &p = previous->attributes.path;
+
+            while (shared < path.size() && shared < p.size() &&
+                   path[shared] == p[shared])
+                ++shared;
+        }
+
+        const uint32_t n = path.size() - shared;
+
+        archive << shared;
+        archive << n;
+
+        for (uint32_t i = shared ; i < path.size() ; ++i)
+            archive << labels.insert(path[i]);
+
+        archive << labels.insert(url.attributes.page);
+    }
+
+    /*
+     * The host of url must already be loaded
+     */
+    template<class Archive>
+    static
+    void load_path(Archive &archive,
+                   url::URL &url,
+                   const url::URL *previous, // Of the host, if any
+                   const std::vector<Label> &labels)
+    {
+        std::vector<Label> &path = url.attributes.path;
+        uint32_t shared = 0, n = 0;
+
+        archive >> shared;
+        archive >> n;
+
+        if (shared > (previous ? previous->attributes.path.size() : 0))
+            throw ReadError("Accessor::load_path", 0,
+                            "%u path segments shared of the %lu before.",
+                            shared,
+                            static_cast<unsigned long>(
+                                previous ? previous->attributes.path.size()
+                                         : 0));
+
+        if (n > archive.remaining()) // Each segment is at least a byte
+            throw ReadError("Accessor::load_path", 0,
+                            "%u path segments in the %lu bytes remaining.",
+                            n, static_cast<unsigned long>(archive.remaining()));
+
+        path.clear();
+
+        if (shared > 0)
+            path.assign(previous->attributes.path.begin(),
+                        previous->attributes.path.begin() + shared);
+
+        path.resize(shared + n);
+
+        for (uint32_t i = shared ; i < path.size() ; ++i)
+            load_index(archive, path[i], labels);
+
+        load_index(archive, url.attributes.page, labels);
+
+        url.id = previous ? url.identify(*previous) : url.identify();
+    }
+
+    private:
+        template<class Archive>
+        static
+        void load_ids(Archive &archive, url::URL &url)
+        {
+            archive >> url.id.page;
+            archive >> url.id.path;
+            archive >> url.id.domain;
+
+            archive >> url.attributes.ip;
+        }
+
+        template<class Archive>
+        static
+        void save_ids(Archive &archive, const url::URL &url)
+        {
+            archive << url.id.page;
+            archive << url.id.path;
+            archive << url.id.domain;
+
+            archive << url.attributes.ip;
+        }
+
+        template<class Archive>
+        static
+        void load_label(Archive &archive, Label &l)
+        {
+            std::string s;
+
+            archive >> s;
+            l = Label(s);
+        }
+
+        template<class Archive>
+        static
+        void save_label(Archive &archive, const Label &l)
+        {
+            const std::string s(l.str());
+            archive << s;
+        }
+
+        template<class Archive>
+        static
+        void load_labels(Archive &archive, std::vector<Label> &v)
+        {
+            uint32_t n = 0;
+
+            archive >> n;
+            v.resize(n);
+
+            for (uint32_t i = 0 ; i < n ; ++i)
+                load_label(archive, v[i]);
+        }
+
+        template<class Archive>
+        static
+        void save_labels(Archive &archive, const std::vector<Label> &v)
+        {
+            const uint32_t n = v.size();
+
+            archive << n;
+
+            for (uint32_t i = 0 ; i < n ; ++i)
+                save_label(archive, v[i]);
+        }
+
+        template<class Archive>
+        static
+        void load_index(Archive &archive,
+                        Label &l,
+                        const std::vector<Label> &labels)
+        {
+            uint32_t i = 0;
+
+            archive >> i;
+            l = labels.at(i); // Throws on an index beyond the table
+        }
+
+        template<class Archive>
+        static
+        void load_indices(Archive &archive,
+                          std::vector<Label> &v,
+                          const std::vector<Label> &labels)
+        {
+            uint32_t n = 0;
+
+            archive >> n;
+            v.resize(n);
+
+            for (uint32_t i = 0 ; i < n ; ++i)
+                load_index(archive, v[i], labels);
+        }
+
+        template<class Archive>
+        static
+        void save_indices(Archive &archive,
+                          const std::vector<Label> &v,
+                          LabelTable &labels)
+        {
+            const uint32_t n = v.size();
+
+            archive << n;
+
+            for (uint32_t i = 0 ; i < n ; ++i)
+                archive << labels.insert(v[i]);
+        }
 };
 
 } // oop
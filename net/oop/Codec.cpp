@@ -0,0 +1,76 @@
+// oodles
+#include "Codec.hpp"
+
+// STL
+using std::string;
+
+namespace oodles {
+namespace net {
+namespace oop {
+
+// Encoder
+Encoder&
+Encoder::operator<< (uint64_t i)
+{
+    char b[sizeof(uint64_t)];
+
+    for (size_t k = 0 ; k < sizeof(b) ; ++k, i >>= 8)
+        b[k] = static_cast<char>(i & 0xFF);
+
+    output.append(b, sizeof(b));
+
+    return *this;
+}
+
+Encoder&
+Encoder::operator<< (const string &s)
+{
+    put_varint(s.size());
+    output.append(s);
+
+    return *this;
+}
+
+// Decoder
+Decoder&
+Decoder::operator>> (uint16_t &i) throw (ReadError)
+{
+    const uint32_t v = get_varint();
+
+    if (v > 0xFFFF)
+        throw ReadError("Decoder::operator>>", 0,
+                        "%u at offset %lu is too wide for 16 bits.", v,
+                        static_cast<unsigned long>(reader.offset()));
+
+    i = static_cast<uint16_t>(v);
+
+    return *this;
+}
+
+Decoder&
+Decoder::operator>> (uint64_t &i) throw (ReadError)
+{
+    const uint8_t *b = reinterpret_cast<const uint8_t*>(
+                           reader.take(sizeof(uint64_t)));
+
+    i = 0;
+
+    for (size_t k = sizeof(uint64_t) ; k > 0 ; --k)
+        i = (i << 8) | b[k - 1];
+
+    return *this;
+}
+
+Decoder&
+Decoder::operator>> (string &s) throw (ReadError)
+{
+    const uint32_t n = get_varint();
+
+    s.assign(reader.take(n), n);
+
+    return *this;
+}
+
+} // oop
+} // net
+} // oodles
@@ -0,0 +1,144 @@
+#ifndef OODLES_NET_OOP_CODEC_HPP
+#define OODLES_NET_OOP_CODEC_HPP
+
+// oodles
+#include "utility/bytes.hpp"
+#include "common/Exceptions.hpp"
+
+// Boost
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_enum.hpp>
+
+// STL
+#include <list>
+#include <string>
+#include <utility>
+
+// libc
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+namespace net {
+namespace oop {
+
+/*
+ * The binary encoding of a message body. Encoder and Decoder take the
+ * same << and >> as the Boost text archives, so each message serializes
+ * itself to either through the one template.
+ *
+ * Integers of up to 32 bits, counts and enumerations are varints; seven
+ * bits to a byte, least significant first, the top bit set on all but
+ * the last. A 64-bit integer is the hash of a URL, as good as random, so
+ * it is written whole; eight bytes, least significant first. A string is
+ * its length, as a varint, and then its bytes; a list its length and then
+ * each of its items.
+ */
+class Encoder
+{
+    public:
+        /* Member functions/methods */
+        Encoder(std::string &output) : output(output) {}
+
+        Encoder& operator<< (bool b)
+        {
+            output.push_back(b ? 1 : 0);
+            return *this;
+        }
+
+        Encoder& operator<< (int i) // An enumeration, never negative
+        {
+            put_varint(static_cast<uint32_t>(i));
+            return *this;
+        }
+
+        Encoder& operator<< (uint16_t i) { put_varint(i); return *this; }
+        Encoder& operator<< (uint32_t i) { put_varint(i); return *this; }
+        Encoder& operator<< (uint64_t i);
+        Encoder& operator<< (const std::string &s);
+
+        template<class T, class U>
+        Encoder& operator<< (const std::pair<T, U> &p);
+
+        template<class T>
+        Encoder& operator<< (const std::list<T> &l);
+    private:
+        /* Member variables/attributes */
+        std::string &output;
+
+        /* Member functions/methods */
+        void put_varint(uint32_t i)
+        {
+            while (i >= 0x80) {
+                output.push_back(static_cast<char>(i | 0x80));
+                i >>= 7;
+            }
+
+            output.push_back(static_cast<char>(i));
+        }
+};
+
+class Decoder
+{
+    public:
+        /* Member functions/methods */
+        Decoder(const char *buffer, size_t size) : reader(buffer, size) {}
+
+        bool empty() const { return reader.empty(); }
+        size_t remaining() const { return reader.remaining(); } // Bytes
+
+        Decoder& operator>> (bool &b) throw (ReadError)
+        {
+            b = reader.get<uint8_t>() != 0;
+            return *this;
+        }
+
+        Decoder& operator>> (uint16_t &i) throw (ReadError);
+        Decoder& operator>> (uint32_t &i) throw (ReadError)
+        {
+            i = get_varint();
+            return *this;
+        }
+
+        Decoder& operator>> (uint64_t &i) throw (ReadError);
+        Decoder& operator>> (std::string &s) throw (ReadError);
+
+        template<class T>
+        typename boost::enable_if<boost::is_enum<T>, Decoder&>::type
+        operator>> (T &e) throw (ReadError);
+
+        template<class T, class U>
+        Decoder& operator>> (std::pair<T, U> &p) throw (ReadError);
+
+        template<class T>
+        Decoder& operator>> (std::list<T> &l) throw (ReadError);
+    private:
+        /* Member variables/attributes */
+        ByteReader reader;
+
+        /* Member functions/methods */
+        uint32_t get_varint() throw (ReadError)
+        {
+            uint32_t i = 0;
+
+            for (unsigned int shift = 0 ; shift < 35 ; shift += 7) {
+                const uint8_t b = reader.get<uint8_t>();
+
+                i |= static_cast<uint32_t>(b & 0x7F) << shift;
+
+                if (!(b & 0x80))
+                    return i;
+            }
+
+            throw ReadError("Decoder::get_varint", 0,
+                            "Varint at offset %lu is over 5 bytes.",
+                            static_cast<unsigned long>(reader.offset()));
+        }
+};
+
+} // oop
+} // net
+} // oodles
+
+#include "Codec.ipp" // Implementation
+
+#endif
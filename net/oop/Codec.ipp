@@ -0,0 +1,62 @@
+#ifndef OODLES_NET_OOP_CODEC_IPP // Implementation
+#define OODLES_NET_OOP_CODEC_IPP
+
+namespace oodles {
+namespace net {
+namespace oop {
+
+// Encoder
+template<class T, class U>
+Encoder&
+Encoder::operator<< (const std::pair<T, U> &p)
+{
+    return *this << p.first << p.second;
+}
+
+template<class T>
+Encoder&
+Encoder::operator<< (const std::list<T> &l)
+{
+    typename std::list<T>::const_iterator i(l.begin()), j(l.end());
+
+    put_varint(l.size());
+
+    for ( ; i != j ; ++i)
+        *this << *i;
+
+    return *this;
+}
+
+// Decoder
+template<class T>
+typename boost::enable_if<boost::is_enum<T>, Decoder&>::type
+Decoder::operator>> (T &e) throw (ReadError)
+{
+    e = static_cast<T>(get_varint());
+    return *this;
+}
+
+template<class T, class U>
+Decoder&
+Decoder::operator>> (std::pair<T, U> &p) throw (ReadError)
+{
+    return *this >> p.first >> p.second;
+}
+
+template<class T>
+Decoder&
+Decoder::operator>> (std::list<T> &l) throw (ReadError)
+{
+    for (uint32_t n = get_varint() ; n > 0 ; --n) {
+        l.push_back(T());
+        *this >> l.back();
+    }
+
+    return *this;
+}
+
+} // oop
+} // net
+} // oodles
+
+#endif
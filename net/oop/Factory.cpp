@@ -60,7 +60,7 @@ Factory::create(const Message::Header &h) const
     if (i == -1)
         return NULL;
     
-    return registry[i]->create(h.body_size);
+    return registry[i]->create(h.body_size, h.format);
 }
 
 } // oop
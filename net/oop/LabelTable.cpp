@@ -0,0 +1,26 @@
+// oodles
+#include "LabelTable.hpp"
+
+namespace oodles {
+namespace net {
+namespace oop {
+
+uint32_t
+LabelTable::insert(const Label &l)
+{
+    const uint32_t *i = indices.find(l.id());
+
+    if (i)
+        return *i;
+
+    const uint32_t index = table.size();
+
+    indices.insert(l.id(), index);
+    table.push_back(l);
+
+    return index;
+}
+
+} // oop
+} // net
+} // oodles
@@ -0,0 +1,47 @@
+#ifndef OODLES_NET_OOP_LABELTABLE_HPP
+#define OODLES_NET_OOP_LABELTABLE_HPP
+
+// oodles
+#include "utility/FlatHashMap.hpp"
+#include "utility/StringInterner.hpp"
+
+// STL
+#include <vector>
+
+// libc
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+namespace net {
+namespace oop {
+
+/*
+ * The distinct labels of the URLs of a message. Each is sent just once, as
+ * its text, ahead of the URLs, which then refer to it by its index here;
+ * label ids are only meaningful within the process that interned them.
+ */
+class LabelTable
+{
+    public:
+        /* Member functions/methods */
+        uint32_t insert(const Label &l); // Index of l, added if new
+
+        const std::vector<Label>& labels() const { return table; }
+        size_t size() const { return table.size(); }
+    private:
+        /* Internal Data Structures */
+        struct hash_id
+        {
+            size_t operator() (Label::id_t id) const { return id; }
+        };
+
+        /* Member variables/attributes */
+        FlatHashMap<Label::id_t, uint32_t, hash_id> indices; // By label id
+        std::vector<Label> table; // By index
+};
+
+} // oop
+} // net
+} // oodles
+
+#endif
@@ -5,16 +5,23 @@
 #include <string.h> // For memcpy()
 #include <arpa/inet.h> // For htonl() etc.
 
+namespace {
+
+const oodles::net::oop::id_t BINARY_FLAG = 0x8000; // Of the message id
+
+} // anonymous
+
 namespace oodles {
 namespace net {
 namespace oop {
 
 const uint8_t Message::Header::header_size = sizeof(uint32_t) + sizeof(id_t);
 
-Message::Message(id_t id, uint32_t body_size)
+Message::Message(id_t id, uint32_t body_size, Format format)
 {
     header.message_id = id;
     header.body_size = body_size;
+    header.format = format;
 }
 
 Message::~Message()
@@ -32,7 +39,9 @@ Message::header2buffer(char *buffer, Header &h)
 {
     static const uint8_t size_width = sizeof(uint32_t), id_width = sizeof(id_t);
     const uint32_t message_size = htonl(h.header_size + h.body_size);
-    const id_t message_id = htons(h.message_id);
+    const id_t message_id = htons(h.format == Binary ?
+                                  h.message_id | BINARY_FLAG :
+                                  h.message_id);
 
     memcpy(buffer, &message_size, size_width);
     memcpy(buffer + size_width, &message_id, id_width);
@@ -52,6 +61,8 @@ Message::buffer2header(const char *buffer)
 
     h.body_size = ntohl(message_size) - h.header_size;
     h.message_id = ntohs(message_id);
+    h.format = h.message_id & BINARY_FLAG ? Binary : Text;
+    h.message_id &= ~BINARY_FLAG;
     h.processed = true;
 
     return h;
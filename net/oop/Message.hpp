@@ -13,17 +13,35 @@ class Message
 {
     public:
         /* Dependent typedefs */
+
+        /*
+         * The encoding of a message body, flagged in the top bit of its
+         * message id on the wire, so either is read whichever is written.
+         */
+        enum Format {
+            Text, // Boost text archive, as peers before Binary write
+            Binary // See Codec.hpp
+        };
+
         struct Header {
             static const uint8_t header_size;
             uint32_t body_size;
             id_t message_id;
+            Format format;
             bool processed;
 
-            Header() : body_size(0), message_id(INVALID_ID), processed(false) {}
+            Header() :
+                body_size(0),
+                message_id(INVALID_ID),
+                format(Binary),
+                processed(false)
+            {}
         };
 
         /* Member functions/methods */
-        Message(id_t id = INVALID_ID, uint32_t body_size = 0);
+        Message(id_t id = INVALID_ID,
+                uint32_t body_size = 0,
+                Format format = Binary);
         virtual ~Message();
         
         static Header buffer2header(const char *buffer);
@@ -37,16 +55,18 @@ class Message
         operator Type&() { return static_cast<Type&>(*this); }
         
         virtual id_t id() const = 0;
-        virtual Message* create(uint32_t body_size = 0) const = 0;
+        virtual Message* create(uint32_t body_size = 0,
+                                Format format = Binary) const = 0;
         
         virtual void reconstruct() throw(ReadError) = 0;
-        virtual void deconstruct() throw(WriteError) = 0;
+        virtual void deconstruct(Format format) throw(WriteError) = 0;
         
         virtual size_t to_buffer(char *buffer, size_t max) = 0;
         virtual size_t from_buffer(const char *buffer, size_t max) = 0;
         
         virtual size_t pending() = 0;
         size_t size() const { return header.header_size + header.body_size; }
+        Format format() const { return header.format; }
     protected:
         /* Member variables/attributes */
         Header header;
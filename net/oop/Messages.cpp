@@ -8,8 +8,8 @@
 #include <boost/serialization/string.hpp>
 
 // STL
-using std::list;
 using std::string;
+using std::vector;
 
 namespace {
 
@@ -24,6 +24,79 @@ bool init()
 
 static const bool factory_initialised = init();
 
+/*
+ * Each of the n items counted in a Binary body takes at least one of its
+ * bytes, so a count of more than remain is corrupt and is refused before
+ * anything is allocated for it. Text is read item by item.
+ */
+void
+check_count(const oodles::net::oop::Decoder &archive,
+            uint32_t n,
+            const char *what) throw (oodles::ReadError)
+{
+    if (n > archive.remaining())
+        throw oodles::ReadError("check_count", 0,
+                                "%u %s counted in the %lu bytes remaining.",
+                                n,
+                                what,
+                                static_cast<unsigned long>(
+                                    archive.remaining()));
+}
+
+template<class Archive>
+void
+check_count(const Archive &, uint32_t, const char *)
+{
+}
+
+/*
+ * The distinct labels of the URLs of a BeginCrawl, each as its text
+ */
+template<class Archive>
+void
+load_labels(Archive &archive, vector<oodles::Label> &labels)
+{
+    uint32_t n = 0;
+    string s;
+
+    archive >> n;
+    check_count(archive, n, "labels");
+    labels.reserve(n);
+
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        archive >> s;
+        labels.push_back(oodles::Label(s)); // Interned once per message
+    }
+}
+
+template<class Archive>
+void
+save_labels(Archive &archive, const oodles::net::oop::LabelTable &labels)
+{
+    const uint32_t n = labels.size();
+
+    archive << n;
+
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        const string s(labels.labels()[i].str());
+        archive << s;
+    }
+}
+
+/*
+ * Whether a and b are of the same host
+ */
+bool
+same_host(const oodles::url::URL &a, const oodles::url::URL &b)
+{
+    const oodles::url::Attributes &x = a.components(), &y = b.components();
+
+    return a.domain_id() == b.domain_id() && x.ip == y.ip &&
+           x.port == y.port && x.scheme == y.scheme &&
+           x.username == y.username && x.password == y.password &&
+           x.domain == y.domain;
+}
+
 } // anonymous
 
 namespace oodles {
@@ -35,71 +108,267 @@ void
 RegisterCrawler_::serialize(Reconstructor &archive,
                             unsigned int /* version */)
 {
-    archive >> cores;
-    archive >> name;
+    load(archive);
 }
 
 void
 RegisterCrawler_::serialize(Deconstructor &archive,
                             unsigned int /* version */) const
+{
+    save(archive);
+}
+
+void
+RegisterCrawler_::serialize(Decoder &archive,
+                            unsigned int /* schema */)
+{
+    load(archive);
+}
+
+void
+RegisterCrawler_::serialize(Encoder &archive,
+                            unsigned int /* schema */) const
+{
+    save(archive);
+}
+
+template<class Archive>
+void
+RegisterCrawler_::load(Archive &archive)
+{
+    archive >> cores;
+    archive >> name;
+}
+
+template<class Archive>
+void
+RegisterCrawler_::save(Archive &archive) const
 {
     archive << cores;
     archive << name;
 }
 
-BeginCrawl_::BeginCrawl_() : pointer_owner(false)
+void
+BeginCrawl_::add(const url::URL &url)
 {
+    const uint32_t *first = domains.find(url.domain_id());
+    uint32_t i = first ? *first : hosts.size();
+
+    while (i < hosts.size() && !same_host(hosts[i].front(), url))
+        ++i; // Another scheme or port, say, of the same domain
+
+    if (i == hosts.size()) {
+        hosts.push_back(Host());
+
+        if (!first)
+            domains.insert(url.domain_id(), i);
+    }
+
+    hosts[i].push_back(url);
 }
 
-BeginCrawl_::~BeginCrawl_()
+size_t
+BeginCrawl_::count() const
 {
-    if (pointer_owner) {
-        list<url::URL*>::const_iterator i(urls.begin()), j(urls.end());
+    size_t n = 0;
 
-        while (i != j) {
-            delete *i;
-            ++i;
-        }
-    }
+    for (size_t i = 0 ; i < hosts.size() ; ++i)
+        n += hosts[i].size();
+
+    return n;
 }
 
 void
 BeginCrawl_::serialize(Reconstructor &archive,
                        unsigned int /* version */)
 {
-    archive >> urls;
-
-    /*
-     * The serialisation layer 'owns' (it created) the pointer(s)
-     * when reconstructing the object on receipt of the raw data.
-     */
-    pointer_owner = true;
+    load(archive);
 }
 
 void
 BeginCrawl_::serialize(Deconstructor &archive,
                        unsigned int /* version */) const
 {
-    archive << urls;
+    save(archive);
+}
+
+void
+BeginCrawl_::serialize(Decoder &archive,
+                       unsigned int schema)
+{
+    if (schema == 1)
+        load(archive);
+    else
+        load_hosts(archive);
+}
+
+void
+BeginCrawl_::serialize(Encoder &archive,
+                       unsigned int /* schema */) const
+{
+    save_hosts(archive);
+}
+
+/*
+ * The distinct labels of the URLs come first, each as its text, and then
+ * the URLs, referring to their labels by index. As written as text, and
+ * by the first schema of Binary.
+ */
+template<class Archive>
+void
+BeginCrawl_::load(Archive &archive)
+{
+    vector<Label> labels;
+    url::URL url;
+    uint32_t n = 0;
+
+    load_labels(archive, labels);
+    archive >> n;
+
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        Accessor::load(archive, url, labels);
+        add(url);
+    }
+}
+
+template<class Archive>
+void
+BeginCrawl_::save(Archive &archive) const
+{
+    LabelTable labels;
+
+    for (size_t i = 0 ; i < hosts.size() ; ++i)
+        for (size_t j = 0 ; j < hosts[i].size() ; ++j)
+            Accessor::enrol(hosts[i][j], labels);
+
+    const uint32_t n = count();
+
+    save_labels(archive, labels);
+    archive << n;
+
+    for (size_t i = 0 ; i < hosts.size() ; ++i)
+        for (size_t j = 0 ; j < hosts[i].size() ; ++j)
+            Accessor::save(archive, hosts[i][j], labels);
+}
+
+/*
+ * The labels, as before, and then each host, its components sent once
+ * and then the paths and pages of its URLs front-coded; see Accessor.
+ */
+void
+BeginCrawl_::load_hosts(Decoder &archive)
+{
+    vector<Label> labels;
+    url::URL host;
+    uint32_t n = 0;
+
+    load_labels(archive, labels);
+    archive >> n;
+    check_count(archive, n, "hosts");
+    hosts.resize(n);
+
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        Host &h = hosts[i];
+        uint32_t m = 0;
+
+        Accessor::load_host(archive, host, labels);
+        archive >> m;
+
+        if (m == 0)
+            throw ReadError("BeginCrawl_::load_hosts", 0,
+                            "Host %u of %u has no URLs.", i, n);
+
+        check_count(archive, m, "URLs");
+
+        h.resize(m, host);
+
+        for (uint32_t j = 0 ; j < m ; ++j)
+            Accessor::load_path(archive, h[j], j ? &h[j - 1] : NULL, labels);
+
+        if (!domains.find(h.front().domain_id()))
+            domains.insert(h.front().domain_id(), i);
+    }
+}
+
+void
+BeginCrawl_::save_hosts(Encoder &archive) const
+{
+    LabelTable labels;
+    uint32_t n = 0;
+
+    for (size_t i = 0 ; i < hosts.size() ; ++i) {
+        for (size_t j = 0 ; j < hosts[i].size() ; ++j)
+            Accessor::enrol(hosts[i][j], labels);
+
+        if (!hosts[i].empty())
+            ++n;
+    }
+
+    save_labels(archive, labels);
+    archive << n;
+
+    for (size_t i = 0 ; i < hosts.size() ; ++i) {
+        const Host &h = hosts[i];
+        const uint32_t m = h.size();
+
+        if (m == 0)
+            continue; // Has nothing to send
 
-    /*
-     * The serialisation layer does not own (did not create) the pointer(s)
-     * when deconstructing the object to send as raw data. Therefore the
-     * attribute 'pointer_owner' remains false (initialised by the constructor).
-     */
+        Accessor::save_host(archive, h.front(), labels);
+        archive << m;
+
+        for (uint32_t j = 0 ; j < m ; ++j)
+            Accessor::save_path(archive, h[j], j ? &h[j - 1] : NULL, labels);
+    }
 }
 
 void
 EndCrawl_::serialize(Reconstructor &archive,
                      unsigned int /* version */)
 {
-    archive >> new_urls;
-    archive >> scheduled_urls;
+    load(archive);
 }
 
 void
 EndCrawl_::serialize(Deconstructor &archive,
                      unsigned int /* version */) const
+{
+    save(archive);
+}
+
+/*
+ * The response times follow the results from the second schema; text, as
+ * the first schema, has none.
+ */
+void
+EndCrawl_::serialize(Decoder &archive,
+                     unsigned int schema)
+{
+    load(archive);
+
+    if (schema > 1)
+        archive >> response_times;
+}
+
+void
+EndCrawl_::serialize(Encoder &archive,
+                     unsigned int /* schema */) const
+{
+    save(archive);
+    archive << response_times;
+}
+
+template<class Archive>
+void
+EndCrawl_::load(Archive &archive)
+{
+    archive >> new_urls;
+    archive >> scheduled_urls;
+}
+
+template<class Archive>
+void
+EndCrawl_::save(Archive &archive) const
 {
     archive << new_urls;
     archive << scheduled_urls;
@@ -4,10 +4,12 @@
 // oodles
 #include "url/URL.hpp"
 #include "Serialiser.hpp"
+#include "utility/FlatHashMap.hpp"
 
 // STL
 #include <list>
 #include <string>
+#include <vector>
 
 // libc
 #include <stdint.h> // For uint16_t
@@ -28,45 +30,106 @@ struct RegisterCrawler_
 {
     /* Member functions/methods */
     static id_t id() { return REGISTER_CRAWLER; }
-    void serialize(Reconstructor &archive, unsigned int /* version */);
-    void serialize(Deconstructor &archive, unsigned int /* version */) const;
+    static uint32_t schema() { return 1; }
+
+    void serialize(Reconstructor &archive, unsigned int version);
+    void serialize(Deconstructor &archive, unsigned int version) const;
+    void serialize(Decoder &archive, unsigned int schema);
+    void serialize(Encoder &archive, unsigned int schema) const;
     
     /* Member variables/attributes */
     uint16_t cores;
     std::string name;
+private:
+    /* Member functions/methods */
+    template<class Archive> void load(Archive &archive);
+    template<class Archive> void save(Archive &archive) const;
 };
 
 struct BeginCrawl_
 {
-    /* Member functions/methods */
-    BeginCrawl_();
-    virtual ~BeginCrawl_();
+    /* Dependent typedefs */
+
+    /*
+     * The URLs of one host, those of the same scheme, username, password,
+     * domain and port, in the order they were added
+     */
+    typedef std::vector<url::URL> Host;
 
+    /* Member functions/methods */
     static id_t id() { return BEGIN_CRAWL; }
-    void serialize(Reconstructor &archive, unsigned int /* version */);
-    void serialize(Deconstructor &archive, unsigned int /* version */) const;
+    static uint32_t schema() { return 2; }
+
+    void add(const url::URL &url); // To the URLs of its host
+    size_t count() const; // No. of URLs of every host
+
+    void serialize(Reconstructor &archive, unsigned int version);
+    void serialize(Deconstructor &archive, unsigned int version) const;
+    void serialize(Decoder &archive, unsigned int schema);
+    void serialize(Encoder &archive, unsigned int schema) const;
     
     /* Member variables/attributes */
-    bool pointer_owner;
-    std::list<url::URL*> urls;
+    std::vector<Host> hosts;
+private:
+    /* Internal Data Structures */
+    struct hash_id
+    {
+        size_t operator() (url::URL::hash_t h) const { return h; }
+    };
+
+    /* Member variables/attributes */
+
+    /*
+     * Index of the first host of each domain; any other of the domain, of
+     * another scheme or port, say, follows it in hosts
+     */
+    FlatHashMap<url::URL::hash_t, uint32_t, hash_id> domains;
+
+    /* Member functions/methods */
+    template<class Archive> void load(Archive &archive);
+    template<class Archive> void save(Archive &archive) const;
+    void load_hosts(Decoder &archive);
+    void save_hosts(Encoder &archive) const;
 };
 
 struct EndCrawl_
 {
     /* Dependent typedefs */
+
+    /*
+     * The crawler fingerprints the content of each page it fetches so it
+     * can report whether the page changed since it was previously fetched.
+     */
+    enum Result {
+        Failed, // Not fetched
+        Unchanged,
+        Changed // Or fetched for the first time
+    };
+
     //..........................Page URL.....Crawled?
     typedef std::list<std::pair<std::string, bool> > NewURLs;
-    //..........................Page ID...........Success?
-    typedef std::list<std::pair<url::URL::hash_t, bool> > ScheduledURLs;
+    //..........................Page ID...........Result
+    typedef std::list<std::pair<url::URL::hash_t, Result> > ScheduledURLs;
+    //..........................Page ID...........ms to fetch
+    typedef std::list<std::pair<url::URL::hash_t, uint32_t> > ResponseTimes;
     
     /* Member functions/methods */
     static id_t id() { return END_CRAWL; }
-    void serialize(Reconstructor &archive, unsigned int /* version */);
-    void serialize(Deconstructor &archive, unsigned int /* version */) const;
+    static uint32_t schema() { return 2; }
+
+    void serialize(Reconstructor &archive, unsigned int version);
+    void serialize(Deconstructor &archive, unsigned int version) const;
+    void serialize(Decoder &archive, unsigned int schema);
+    void serialize(Encoder &archive, unsigned int schema) const;
     
     /* Member variables/attributes */
     NewURLs new_urls;
     ScheduledURLs scheduled_urls;
+    ResponseTimes response_times; // Of those fetched, Binary from schema 2
+private:
+    /* Member functions/methods */
+    template<class Archive> void load(Archive &archive);
+    template<class Archive> void save(Archive &archive) const;
 };
 
 } // msg
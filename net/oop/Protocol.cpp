@@ -9,7 +9,10 @@ namespace oodles {
 namespace net {
 namespace oop {
 
-Protocol::Protocol() : incoming(NULL), transferred(0)
+Protocol::Protocol() :
+    incoming(NULL),
+    transferred(0),
+    format(Message::Binary)
 {
 }
 
@@ -33,9 +36,14 @@ Protocol::push_message(Message *m)
         return;
 
     outbound_messages.push(m);
-    m->deconstruct();
-    
-    if (buffered_messages.empty())
+    m->deconstruct(format);
+
+    /*
+     * Whilst any earlier message is being sent it is left to the send to
+     * buffer this one too; preparing the buffer meanwhile may move the
+     * bytes it is writing from.
+     */
+    if (buffered_messages.empty() && outbound_messages.size() == 1)
         transfer_data();
 }
 
@@ -128,6 +136,7 @@ Protocol::buffer2message(const char *buffer, size_t max)
         if (!incoming) {
             const Message::Header h(Message::buffer2header(buffer + used));
             incoming = factory.create(h);
+            format = h.format; // Answer the peer in kind
             used += h.header_size;
             max -= h.header_size;
         }
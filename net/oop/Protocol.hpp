@@ -2,6 +2,7 @@
 #define OODLES_NET_OOP_PROTOCOL_HPP
 
 // oodles
+#include "Message.hpp"
 #include "net/core/ProtocolHandler.hpp"
 
 // STL
@@ -11,8 +12,6 @@ namespace oodles {
 namespace net {
 namespace oop {
 
-class Message; // Forward declaration for Protocol
- 
 class Protocol : public ProtocolHandler
 {
     public:
@@ -21,6 +20,14 @@ class Protocol : public ProtocolHandler
         
         Message* pop_message();
         void push_message(Message *m);
+
+        /*
+         * Messages are written in the format set, Binary unless set,
+         * until one is read from the peer; from then on in the format
+         * the peer last wrote.
+         */
+        Message::Format get_format() const { return format; }
+        void set_format(Message::Format f) { format = f; }
         
         /*
          * These methods override the pure virtual interface
@@ -34,6 +41,7 @@ class Protocol : public ProtocolHandler
         /* Member variables/attributes */
         Message *incoming;
         size_t transferred;
+        Message::Format format;
         std::queue<Message*> inbound_messages,
                              outbound_messages,
                              buffered_messages;
@@ -2,6 +2,7 @@
 #define OODLES_NET_OOP_SERIALISER_HPP
 
 // oodles
+#include "Codec.hpp"
 #include "Factory.hpp"
 #include "Message.hpp"
 #include "common/Exceptions.hpp"
@@ -11,8 +12,12 @@
 #include <boost/archive/text_iarchive.hpp>
 
 // STL
+#include <string>
 #include <sstream>
 
+// libc
+#include <string.h> // For memcpy()
+
 namespace {
 
 const std::ios_base::openmode BINARY_STREAM = std::ios_base::in | \
@@ -28,23 +33,31 @@ namespace oop {
 typedef boost::archive::text_iarchive Reconstructor; // Input archive stream
 typedef boost::archive::text_oarchive Deconstructor; // Output archive stream
 
+/*
+ * A Binary body opens with the schema of its Type, a varint, which is
+ * passed on to its serialize() as the version; Type::schema() is the
+ * latest this build writes, and the newest it reads.
+ */
 template<typename Type> class Serialiser : public Message, public Type
 {
     public:
         /* Member functions/methods */
-        Serialiser(uint32_t body_size = 0) :
-            Message(id(), body_size),
+        Serialiser(uint32_t body_size = 0, Format format = Binary) :
+            Message(id(), body_size, format),
             serialised(false),
-            stream(BINARY_STREAM) {}
-        
+            offset(0)
+        {
+            body.reserve(body_size);
+        }
+
         id_t id() const
         {
            return Type::id();
         }
-        
-        Message* create(uint32_t body_size = 0) const
+
+        Message* create(uint32_t body_size = 0, Format format = Binary) const
         {
-            return new Serialiser<Type>(body_size);
+            return new Serialiser<Type>(body_size, format);
         }
 
         /*
@@ -62,15 +75,30 @@ template<typename Type> class Serialiser : public Message, public Type
         {
             if (serialised)
                 return;
-            
+
             bool success = true;
 
             try {
-                Reconstructor r(stream, boost::archive::no_header);
                 Type &me = *this;
-                
-                r >> me; // Start the Boost.serialize sequence
-                success = !stream.fail();
+
+                if (header.format == Binary) {
+                    Decoder d(body.data(), body.size());
+                    uint32_t schema = 0;
+
+                    d >> schema;
+                    success = schema > 0 && schema <= Type::schema();
+
+                    if (success) {
+                        me.serialize(d, schema);
+                        success = d.empty(); // Every byte of the body read
+                    }
+                } else {
+                    std::istringstream stream(body, BINARY_STREAM);
+                    Reconstructor r(stream, boost::archive::no_header);
+
+                    r >> me; // Start the Boost.serialize sequence
+                    success = !stream.fail();
+                }
             } catch (const std::exception &e) {
                 success = false;
             }
@@ -82,28 +110,46 @@ template<typename Type> class Serialiser : public Message, public Type
                                 id());
             }
 
-            header.body_size = stream.tellg();
             serialised = true;
-            reset_stream();
+            offset = 0;
         }
-        
-        void deconstruct() throw (WriteError)
+
+        /*
+         * A message reconstructed is sent on as it was received, unless
+         * it is to go in the other format.
+         */
+        void deconstruct(Format format) throw (WriteError)
         {
-            if (serialised)
+            if (serialised && format == header.format) {
+                offset = 0;
                 return;
-            
+            }
+
             bool success = true;
-            
+
+            header.format = format;
+            body.clear();
+
             try {
-                Deconstructor d(stream, boost::archive::no_header);
                 const Type &me = *this;
-                
-                d << me; // Start the Boost.serialize sequence
-                success = !stream.fail();
+
+                if (format == Binary) {
+                    Encoder e(body);
+
+                    e << Type::schema();
+                    me.serialize(e, Type::schema());
+                } else {
+                    std::ostringstream stream(BINARY_STREAM);
+                    Deconstructor d(stream, boost::archive::no_header);
+
+                    d << me; // Start the Boost.serialize sequence
+                    success = !stream.fail();
+                    body = stream.str();
+                }
             } catch (const std::exception &e) {
                 success = false;
             }
-            
+
             if (!success) {
                 throw WriteError("Serialiser::deconstruct",
                                  0,
@@ -111,53 +157,51 @@ template<typename Type> class Serialiser : public Message, public Type
                                  id());
             }
 
-            header.body_size = stream.tellp();
+            header.body_size = body.size();
             serialised = true;
-            reset_stream();
+            offset = 0;
         }
-        
+
         size_t to_buffer(char *buffer, size_t max)
         {
-            size_t offset = 0;
-            
+            size_t used = 0;
+
             if (!header.processed && max >= header.header_size) {
                 header2buffer(buffer, header);
-                offset = header.header_size;
+                used = header.header_size;
             }
-            
-            max -= offset;
+
+            max -= used;
 
             if (max > pending())
                 max = pending();
-            
-            return offset + stream.rdbuf()->sgetn(buffer + offset, max);
+
+            memcpy(buffer + used, body.data() + offset, max);
+            offset += max;
+
+            return used + max;
         }
 
         size_t from_buffer(const char *buffer, size_t max)
         {
             if (max > pending())
                 max = pending();
-            
-            return stream.rdbuf()->sputn(buffer, max);
+
+            body.append(buffer, max);
+
+            return max;
         }
-        
+
         size_t pending()
         {
-            return header.body_size - 
-                   (serialised ? stream.tellg() : stream.tellp());
+            return serialised ? body.size() - offset :
+                                header.body_size - body.size();
         }
     private:
         /* Member variables/attributes */
         bool serialised;
-        std::stringstream stream;
-        
-        /* Member functions/methods */
-        void reset_stream()
-        {
-            stream.seekg(0);
-            stream.seekp(0);
-            stream.clear();
-        }
+        size_t offset; // Of the next byte of body to send
+        std::string body; // Encoded in header.format
 };
 
 } // oop
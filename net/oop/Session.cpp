@@ -29,6 +29,13 @@ Session::push_message(Message *m)
     p.push_message(m);
 }
 
+void
+Session::set_format(Message::Format f)
+{
+    Protocol &p = *static_cast<Protocol*>(get_endpoint()->get_protocol());
+    p.set_format(f);
+}
+
 } // oop
 } // net
 } // oodles
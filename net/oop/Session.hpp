@@ -2,6 +2,7 @@
 #define OODLES_NET_OOP_SESSION_HPP
 
 // oodles
+#include "Message.hpp"
 #include "utility/Linker.hpp"
 #include "net/core/SessionHandler.hpp"
 
@@ -9,8 +10,6 @@ namespace oodles {
 namespace net {
 namespace oop {
 
-class Message; // Forward declaration for Session
-
 class Session : public Linker, public SessionHandler
 {
     public:
@@ -18,6 +17,7 @@ class Session : public Linker, public SessionHandler
         void handle_messages();
         
         void push_message(Message *m); // Ownership transferred
+        void set_format(Message::Format f); // See Protocol::set_format()
         virtual void handle_message(Message *m) = 0; // Ownership transferred
 };
    
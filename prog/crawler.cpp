@@ -18,6 +18,7 @@ using std::string;
 
 // oodles
 using oodles::net::hostname;
+using oodles::net::oop::Message;
 using oodles::crawl::Context;
 
 static Context *g_context = NULL;
@@ -72,7 +73,8 @@ static void print_usage(const char *program)
          << "\n-h\t--help"
          << "\n-n\t--name <name>"
          << "\n-c\t--cores <#cores>"
-         << "\n-s\t--scheduler <hostname:port>\n";
+         << "\n-s\t--scheduler <hostname:port>"
+         << "\n-w\t--wire <binary|text> (format of the messages sent)\n";
 }
 
 int main(int argc, char *argv[])
@@ -81,12 +83,14 @@ int main(int argc, char *argv[])
     uint16_t cores = 1;
     string name(hostname());
     string connect_to("127.0.0.1:8888");
-    const char *short_options = "hn:c:s:";
-    const struct option long_options[5] = {
+    Message::Format format = Message::Binary;
+    const char *short_options = "hn:c:s:w:";
+    const struct option long_options[6] = {
         {"help", no_argument, NULL, short_options[0]},
         {"name", required_argument, NULL, short_options[1]},
         {"cores", required_argument, NULL, short_options[3]},
         {"scheduler", required_argument, NULL, short_options[5]},
+        {"wire", required_argument, NULL, short_options[7]},
         {NULL, 0, NULL, 0}
     };
 
@@ -104,6 +108,14 @@ int main(int argc, char *argv[])
             case 's':
                 connect_to = optarg;
                 break;
+            case 'w':
+                if (string(optarg) == "text") {
+                    format = Message::Text;
+                } else if (string(optarg) != "binary") {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
             default:
                 print_usage(argv[0]);
                 return 1;
@@ -113,7 +125,7 @@ int main(int argc, char *argv[])
     int rc = 0;
     
     try {
-        Context context(name, cores);
+        Context context(name, cores, format);
         
         /*
          * We must allow the signal handler to stop the
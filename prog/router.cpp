@@ -0,0 +1,132 @@
+// oodles
+#include "route/Context.hpp"
+
+// STL
+#include <string>
+#include <vector>
+#include <iostream>
+
+// libc
+#include <getopt.h> // For getopt()
+#include <signal.h> // For sigaddset() etc.
+
+// STL
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+
+// oodles
+using oodles::route::Context;
+
+static Context *g_context = NULL;
+
+static void signal_handler(int signal)
+{
+    bool stop = false;
+
+    switch (signal) {
+        case SIGINT:
+        case SIGTERM:
+        case SIGQUIT:
+            stop = true;
+            break;
+        default:
+            break;
+    }
+
+    if (stop && g_context)
+        g_context->stop_routing();
+}
+
+static void set_signal_handler(Context &c)
+{
+    sigset_t blocked;
+    struct sigaction action;
+
+    sigemptyset(&blocked);
+    memset(&action, '\0', sizeof(struct sigaction));
+
+    // Block these signals when actually in the handler
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    sigaddset(&blocked, SIGQUIT);
+
+    action.sa_mask = blocked;
+    action.sa_handler = &signal_handler;
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+
+    // We have special ways of handling these signals
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGQUIT, &action, NULL);
+
+    g_context = &c;
+}
+
+static void print_usage(const char *program)
+{
+    cerr << program
+         << ":\n"
+         << "\n-h\t--help"
+         << "\n-s\t--service <ip:port>"
+         << "\n-S\t--shard <hostname:port> (once for each, in shard order)\n"
+         << "\nEach scheduler must be run with --shard <index>/<count>, its"
+         << "\nposition in the list of shards given here and their number.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    int ch = -1;
+    vector<string> shards;
+    string listen_on("127.0.0.1:8888");
+    const char *short_options = "hs:S:";
+    const struct option long_options[4] = {
+        {"help", no_argument, NULL, short_options[0]},
+        {"service", required_argument, NULL, short_options[1]},
+        {"shard", required_argument, NULL, short_options[3]},
+        {NULL, 0, NULL, 0}
+    };
+
+    while ((ch = getopt_long(argc, argv,
+                             short_options,
+                             long_options, NULL)) != -1)
+    {
+        switch (ch) {
+            case 's':
+                listen_on = optarg;
+                break;
+            case 'S':
+                shards.push_back(optarg);
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (shards.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    int rc = 0;
+
+    try {
+        Context context(shards);
+
+        /*
+         * We must allow the signal handler to stop the
+         * dispatcher service and join all the threads.
+         */
+        set_signal_handler(context);
+
+        context.start_server(listen_on); /* Crawlers connect to us */
+        context.start_routing(); /* Blocks until stopped */
+    } catch (const std::exception &e) {
+        cerr << e.what() << endl;
+        rc = 1;
+    }
+
+    return rc;
+}
@@ -4,12 +4,22 @@
 // oodles utility
 #include "utility/file-ops.hpp"
 
+// oodles net
+#include "net/core/Server.hpp"
+#include "net/http/Protocol.hpp"
+#include "net/http/MetricsSession.hpp"
+#include "net/core/HandlerCreator.hpp"
+
+// Boost
+#include <boost/scoped_ptr.hpp>
+
 // STL
 #include <string>
 #include <fstream>
 #include <iostream>
 
 // libc
+#include <stdio.h> // For sscanf()
 #include <getopt.h>
 #include <signal.h> // For sigaddset() etc.
 
@@ -26,6 +36,12 @@ using std::exception;
 using oodles::read_file_data;
 // oodles scheduler
 using oodles::sched::Context;
+// oodles net
+using oodles::net::Server;
+using oodles::net::http::MetricsContext;
+
+typedef oodles::net::Creator<oodles::net::http::Protocol,
+                             oodles::net::http::MetricsSession> MetricsCreator;
 
 static Context *g_context = NULL;
 
@@ -78,23 +94,43 @@ static void print_usage(const char *program)
          << ":\n"
          << "\n-h\t--help"
          << "\n-s\t--service <ip:port>"
-         << "\n-i\t--interval <seconds>"
+         << "\n-i\t--interval <seconds> (between runs when no crawler reports)"
          << "\n-f\t--seed-file <seed input file>"
-         << "\n-d\t--dot-file <dot output file>\n";
+         << "\n-d\t--dot-file <dot output file>"
+         << "\n-D\t--dot-depth <levels> (of the tree drawn, 0 for all)"
+         << "\n-t\t--trace <trace file> (of every run, see trace-replay)"
+         << "\n-p\t--state <state directory>"
+         << "\n-c\t--checkpoint <seconds>"
+         << "\n-j\t--jobs <concurrent scheduling workers>"
+         << "\n-a\t--affinity (assign each host to one crawler)"
+         << "\n-S\t--shard <index>/<count> (of the router's shards)"
+         << "\n-m\t--metrics <ip:port> (serve /metrics over HTTP)"
+         << "\n-b\t--backlog <updates> (deferred before crawlers are held)\n";
 }
 
 int main(int argc, char *argv[])
 {
-    int ch = -1, interval = 5;
-    string seed_file, dot_file;
+    int ch = -1, interval = 5, checkpoint = 300, jobs = 1, dot_depth = 0;
+    unsigned int shard = 0, shards = 1, backlog = 0;
+    bool affinity = false;
+    string seed_file, dot_file, state_dir, metrics_on, trace_file;
     string listen_on("127.0.0.1:8888");
-    const char *short_options = "hs:f:d:i:";
-    const struct option long_options[6] = {
+    const char *short_options = "hs:f:d:i:p:c:j:aS:m:t:D:b:";
+    const struct option long_options[15] = {
         {"help", no_argument, NULL, short_options[0]},
         {"service", required_argument, NULL, short_options[1]},
         {"seed-file", required_argument, NULL, short_options[3]},
         {"dot-file", required_argument, NULL, short_options[5]},
         {"interval", required_argument, NULL, short_options[7]},
+        {"state", required_argument, NULL, short_options[9]},
+        {"checkpoint", required_argument, NULL, short_options[11]},
+        {"jobs", required_argument, NULL, short_options[13]},
+        {"affinity", no_argument, NULL, short_options[15]},
+        {"shard", required_argument, NULL, short_options[16]},
+        {"metrics", required_argument, NULL, short_options[18]},
+        {"trace", required_argument, NULL, short_options[20]},
+        {"dot-depth", required_argument, NULL, short_options[22]},
+        {"backlog", required_argument, NULL, short_options[24]},
         {NULL, 0, NULL, 0}
     };
 
@@ -106,6 +142,9 @@ int main(int argc, char *argv[])
             case 'd':
                 dot_file = optarg;
                 break;
+            case 'D':
+                dot_depth = atoi(optarg);
+                break;
             case 'f':
                 seed_file = optarg;
                 break;
@@ -115,13 +154,42 @@ int main(int argc, char *argv[])
             case 'i':
                 interval = atoi(optarg);
                 break;
+            case 'p':
+                state_dir = optarg;
+                break;
+            case 'c':
+                checkpoint = atoi(optarg);
+                break;
+            case 'j':
+                jobs = atoi(optarg);
+                break;
+            case 'a':
+                affinity = true;
+                break;
+            case 'S':
+                if (sscanf(optarg, "%u/%u", &shard, &shards) != 2 ||
+                    shard >= shards)
+                {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'm':
+                metrics_on = optarg;
+                break;
+            case 't':
+                trace_file = optarg;
+                break;
+            case 'b':
+                backlog = atoi(optarg);
+                break;
             default:
                 print_usage(argv[0]);
                 return 1;
         }
     }
 
-    if (seed_file.empty()) {
+    if (seed_file.empty() && state_dir.empty()) {
         print_usage(argv[0]);
         return 1;
     }
@@ -131,7 +199,7 @@ int main(int argc, char *argv[])
     try {
         string s;
         ostream *dot_stream = NULL;
-        size_t n = read_file_data(seed_file, s);
+        size_t n = seed_file.empty() ? 0 : read_file_data(seed_file, s);
 
         if (n != s.size())
             return 1;
@@ -146,6 +214,9 @@ int main(int argc, char *argv[])
         }
         
         Context context;
+        MetricsContext metrics_context;
+        const MetricsCreator metrics_creator(metrics_context);
+        boost::scoped_ptr<Server> metrics_server;
         string::size_type b = 0, e = s.find_first_of('\n', b), t = string::npos;
 
         /*
@@ -153,10 +224,26 @@ int main(int argc, char *argv[])
          * dispatcher service and join all the threads.
          */
         set_signal_handler(context);
+        context.get_scheduler().set_host_affinity(affinity);
+        context.get_scheduler().set_update_bound(backlog);
+        context.set_shard(shard, shards);
+
+        /* Rebuild the schedule prior to any (re)seeding */
+        if (!state_dir.empty())
+            context.restore_state(state_dir, checkpoint);
+
+        if (!trace_file.empty())
+            context.trace_runs(trace_file);
 
         /* Allow Crawlers to sit connected */
         context.start_server(listen_on);
 
+        if (!metrics_on.empty()) {
+            metrics_server.reset(new Server(context.get_dispatcher(),
+                                            metrics_creator));
+            metrics_server->start(metrics_on);
+        }
+
         while (e != t) {
             context.seed_scheduler(s.substr(b, e - b));
             
@@ -165,7 +252,9 @@ int main(int argc, char *argv[])
         }
 
         s.clear(); // We no longer need this data
-        context.start_crawling(dot_stream, interval); // interval between runs
+
+        /* Blocks until stopped */
+        context.start_crawling(dot_stream, interval, jobs, dot_depth);
 
         delete dot_stream;
     } catch (const exception &e) {
@@ -0,0 +1,268 @@
+// oodles scheduler
+#include "sched/Trace.hpp"
+
+// oodles utility
+#include "utility/Tree.hpp"
+#include "utility/NodeIO.hpp"
+
+// STL
+#include <string>
+#include <vector>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi(), strtoull()
+#include <getopt.h>
+
+// STL
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+using std::ostream;
+using std::exception;
+
+// oodles utility
+using oodles::Tree;
+using oodles::Node;
+using oodles::NodeBase;
+using oodles::io::DotMatrix;
+// oodles scheduler
+using oodles::sched::Trace;
+
+namespace {
+
+/*
+ * A node of the tree as a run left it; siblings are told apart by label
+ */
+struct Visited
+{
+    string label;
+    float weight;
+
+    Visited() : weight(0) {}
+    Visited(const string &l, float w) : label(l), weight(w) {}
+
+    bool operator< (const Visited &rhs) const { return label < rhs.label; }
+};
+
+ostream&
+operator<< (ostream &s, const Visited &v)
+{
+    if (v.label.empty())
+        return s << "ROOT"; // The seed of the tree rebuilt
+
+    return s << v.label << "\\n" << v.weight;
+}
+
+/*
+ * Totals over every run replayed
+ */
+struct Summary
+{
+    uint64_t runs, assigned, crumbs, run_time, max_run_time;
+
+    Summary() : runs(0), assigned(0), crumbs(0), run_time(0), max_run_time(0)
+    {}
+};
+
+void
+print_usage(const char *program)
+{
+    cerr << program
+         << " [options] <trace file>...\n"
+         << "\nPrints the statistics of every run, or draws one run in DOT."
+         << "\nRotated files should be given oldest first.\n"
+         << "\n-h\t--help"
+         << "\n-d\t--dot <run> (draw the nodes the run visited)"
+         << "\n-r\t--root <label/label/...> (of the subtree drawn)"
+         << "\n-l\t--levels <levels> (drawn below the root, 0 for all)\n";
+}
+
+void
+print_header()
+{
+    cout << "run\tstart\tupdate_us\trun_us\tupdated\tassigned"
+         << "\tcrumbs\tdepth\tbacktracks\n";
+}
+
+void
+print_run(const Trace::Replay &r, Summary &s)
+{
+    int depth = 0;
+    uint32_t backtracks = 0;
+
+    for (size_t i = 0 ; i < r.crumbs.size() ; ++i) {
+        const int d = r.crumbs[i].path_idx;
+
+        if (d > depth)
+            depth = d;
+
+        if (i > 0 && d >= 0 && d <= r.crumbs[i - 1].path_idx)
+            ++backtracks; // Back up to a fork rather than down to a child
+    }
+
+    cout << r.sequence << '\t' << r.start << '\t' << r.update_time << '\t'
+         << r.run_time << '\t' << r.updated << '\t' << r.assigned << '\t'
+         << r.crumbs.size() << '\t' << depth + 1 << '\t' << backtracks << '\n';
+
+    ++s.runs;
+    s.assigned += r.assigned;
+    s.crumbs += r.crumbs.size();
+    s.run_time += r.run_time;
+
+    if (r.run_time > s.max_run_time)
+        s.max_run_time = r.run_time;
+}
+
+void
+print_summary(const Summary &s)
+{
+    if (!s.runs)
+        return;
+
+    cout << "\n" << s.runs << " runs assigned " << s.assigned << " URLs, "
+         << s.run_time / s.runs << "us per run on average (at most "
+         << s.max_run_time << "us)";
+
+    if (s.assigned)
+        cout << ", visiting " << static_cast<double>(s.crumbs) / s.assigned
+             << " nodes per URL";
+
+    cout << ".\n";
+}
+
+/*
+ * Rebuild the nodes visited by r and draw those below the node at the end
+ * of root (labels separated by '/'), to the no. of levels given
+ */
+bool
+draw_run(const Trace::Replay &r, const string &root, int levels)
+{
+    Tree<Visited> tree;
+    vector<Node<Visited>*> path; // Node of the last crumb at each depth + 1
+
+    for (size_t i = 0 ; i < r.crumbs.size() ; ++i) {
+        const Trace::Crumb &c = r.crumbs[i];
+
+        if (c.path_idx < 0) {
+            path.assign(1, static_cast<Node<Visited>*>(NULL)); // The root
+            continue;
+        }
+
+        if (static_cast<size_t>(c.path_idx) >= path.size())
+            break;
+
+        const Visited v(c.label, c.weight);
+
+        path.resize(c.path_idx + 1);
+        path.push_back(tree.insert(&v, &v + 1, path.back()));
+    }
+
+    DotMatrix dot(tree);
+    const NodeBase *n = &tree.root();
+
+    for (string::size_type b = 0, e = 0 ; n && b < root.size() ; b = e + 1) {
+        e = root.find('/', b);
+
+        if (e == string::npos)
+            e = root.size();
+
+        const string label(root.substr(b, e - b));
+        const NodeBase *m = NULL;
+
+        for (size_t i = 0 ; !m && i < n->size() ; ++i)
+            if (static_cast<const Node<Visited>&>(n->child(i)).value.label ==
+                label)
+                m = &n->child(i);
+
+        n = m;
+    }
+
+    if (!n) {
+        cerr << "Run " << r.sequence << " did not visit " << root << endl;
+        return false;
+    }
+
+    dot.set_root(*n);
+    dot.set_depth(levels);
+    cout << dot;
+
+    return true;
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    int ch = -1, levels = 0;
+    bool draw = false;
+    uint64_t drawn = 0;
+    string root;
+    const char *short_options = "hd:r:l:";
+    const struct option long_options[5] = {
+        {"help", no_argument, NULL, short_options[0]},
+        {"dot", required_argument, NULL, short_options[1]},
+        {"root", required_argument, NULL, short_options[3]},
+        {"levels", required_argument, NULL, short_options[5]},
+        {NULL, 0, NULL, 0}
+    };
+
+    while ((ch = getopt_long(argc, argv,
+                             short_options,
+                             long_options, NULL)) != -1)
+    {
+        switch (ch) {
+            case 'd':
+                draw = true;
+                drawn = strtoull(optarg, NULL, 10);
+                break;
+            case 'r':
+                root = optarg;
+                break;
+            case 'l':
+                levels = atoi(optarg);
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind == argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        Summary summary;
+        Trace::Replay run;
+
+        if (!draw)
+            print_header();
+
+        for (int i = optind ; i < argc ; ++i) {
+            Trace::Reader reader(argv[i]);
+
+            while (reader.next(run)) {
+                if (!draw)
+                    print_run(run, summary);
+                else if (run.sequence == drawn)
+                    return draw_run(run, root, levels) ? 0 : 1;
+            }
+        }
+
+        if (draw) {
+            cerr << "Run " << drawn << " was not found." << endl;
+            return 1;
+        }
+
+        print_summary(summary);
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
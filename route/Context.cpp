@@ -0,0 +1,159 @@
+// oodles
+#include "Context.hpp"
+#include "utility/hash.hpp"
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+// STL
+#include <set>
+
+// STL
+using std::set;
+using std::list;
+using std::string;
+using std::vector;
+
+// Boost
+using boost::bind;
+using boost::posix_time::seconds;
+
+namespace oodles {
+namespace route {
+
+// NetContext
+Context::NetContext::NetContext(Context *c) : context(c) {}
+
+void
+Context::NetContext::start(net::SessionHandler &s)
+{
+    const Link l(context, static_cast<oop::CrawlerSession*>(&s));
+}
+
+// Context
+Context::Context(const vector<string> &shards) :
+    dispatcher(1),
+    services(shards),
+    sweeper(dispatcher.io_service()),
+    net_context(this),
+    creator(net_context),
+    server(dispatcher, creator)
+{
+}
+
+/*
+ * The crawlers' sessions outlive the Context, ended as the Dispatcher is,
+ * so each must first forget its Shards.
+ */
+Context::~Context()
+{
+    for (list<Shard*>::iterator i = shards.begin() ; i != shards.end() ; ++i) {
+        if ((*i)->crawler())
+            (*i)->crawler()->forget_shards();
+
+        delete *i;
+    }
+}
+
+size_t
+Context::shard_of(const string &url) const throw(url::ParseError)
+{
+    return jump(url::URL::domain_id(url), services.size()); // Not interned
+}
+
+/*
+ * Register the crawler, of the given name, with every shard. Each is told
+ * of an equal share of its cores (rounded up) so the work units sent by
+ * the shards, together, are much as a single scheduler would send.
+ */
+void
+Context::connect_shards(oop::CrawlerSession &s,
+                        const string &name,
+                        uint16_t cores,
+                        vector<Shard*> &connected)
+{
+    const uint16_t share = (cores + services.size() - 1) / services.size();
+
+    for (size_t i = 0 ; i < services.size() ; ++i) {
+        Shard *shard = new Shard(dispatcher, s, i, name, share);
+
+        shards.push_back(shard);
+        connected.push_back(shard);
+        shard->connect(services[i]);
+    }
+}
+
+/*
+ * The crawler is gone; close its connection to each shard, so the shard
+ * reclaims the URLs it had been sent, and forget them.
+ */
+void
+Context::disconnect_shards(vector<Shard*> &connected)
+{
+    for (size_t i = 0 ; i < connected.size() ; ++i) {
+        shards.remove(connected[i]);
+
+        if (connected[i]->close())
+            delete connected[i];
+    }
+
+    connected.clear();
+}
+
+void
+Context::start_server(const string &service)
+{
+    server.start(service);
+    arm();
+}
+
+void
+Context::stop_routing()
+{
+    dispatcher.stop();
+}
+
+void
+Context::start_routing()
+{
+    dispatcher.wait();
+}
+
+/*
+ * Close the shards of every crawler whose connection has closed. Its
+ * session is never deleted, being held by its Endpoint as it holds it.
+ */
+void
+Context::sweep(const boost::system::error_code &e)
+{
+    if (e == boost::asio::error::operation_aborted)
+        return;
+
+    set<oop::CrawlerSession*> gone;
+
+    for (list<Shard*>::iterator i = shards.begin() ; i != shards.end() ; ++i)
+        if ((*i)->crawler() && !(*i)->crawler()->online())
+            gone.insert((*i)->crawler());
+
+    for (set<oop::CrawlerSession*>::iterator i = gone.begin() ;
+         i != gone.end() ; ++i)
+        (*i)->close_shards();
+
+    arm();
+}
+
+void
+Context::arm()
+{
+    const long interval = Sweep;
+
+    sweeper.expires_from_now(seconds(interval));
+    sweeper.async_wait(bind(&Context::sweep,
+                            this,
+                            boost::asio::placeholders::error));
+}
+
+} // route
+} // oodles
@@ -0,0 +1,104 @@
+#ifndef OODLES_ROUTE_CONTEXT_HPP
+#define OODLES_ROUTE_CONTEXT_HPP
+
+// oodles
+#include "Shard.hpp"
+#include "CrawlerSession.hpp"
+
+#include "net/core/Server.hpp"
+#include "net/oop/Protocol.hpp"
+#include "net/core/HandlerCreator.hpp"
+
+#include "utility/Linker.hpp"
+#include "utility/Dispatcher.hpp"
+
+// Boost
+#include <boost/asio/deadline_timer.hpp>
+
+// STL
+#include <list>
+#include <string>
+#include <vector>
+
+namespace oodles {
+namespace route {
+
+/*
+ * The router stands between the crawlers and a number of schedulers
+ * (shards), each holding the URLs of its own share of the domains. To a
+ * crawler the router is a scheduler; to each shard it is every crawler.
+ *
+ * A domain belongs to the shard its id jump()s to, given the no. of shards,
+ * so every shard's scheduler must be given the same no. and its own index
+ * (in the order of the router's list of shards); see sched::Context.
+ *
+ * Sessions are all run on the one Dispatcher thread, so none need locking.
+ *
+ * A crawler gone is found by sweep(), as a scheduler finds it offline, and
+ * its connections to the shards closed so each reclaims the crawler's URLs.
+ */
+class Context : public Linker
+{
+    public:
+        /* Member functions/methods */
+        Context(const std::vector<std::string> &shards);
+        ~Context();
+
+        Dispatcher& get_dispatcher() { return dispatcher; }
+        size_t shard_of(const std::string &url) const throw(url::ParseError);
+
+        void connect_shards(oop::CrawlerSession &s,
+                            const std::string &name,
+                            uint16_t cores,
+                            std::vector<Shard*> &connected);
+        void disconnect_shards(std::vector<Shard*> &connected);
+
+        void start_server(const std::string &service);
+        void stop_routing();
+        void start_routing(); // Blocks until stopped
+    private:
+        /* Internal Data Structures */
+        enum {
+            Sweep = 1 // Seconds between looks for crawlers gone
+        };
+
+        class NetContext : public net::CallerContext
+        {
+            public:
+                NetContext(Context *c);
+                void start(net::SessionHandler &s);
+            private:
+                Context *context;
+        };
+
+        /* Member variables/attributes */
+
+        /*
+         * Asynchronous task dispatcher
+         */
+        Dispatcher dispatcher;
+
+        /*
+         * Routing layer
+         */
+        const std::vector<std::string> services; // Of each shard, by index
+        std::list<Shard*> shards; // Every crawler's connection to each
+        boost::asio::deadline_timer sweeper;
+
+        /*
+         * Network layer
+         */
+        typedef net::Creator<net::oop::Protocol, oop::CrawlerSession> Creator;
+        NetContext net_context;
+        const Creator creator;
+        net::Server server;
+
+        /* Member functions/methods */
+        void sweep(const boost::system::error_code &e);
+        void arm();
+};
+
+} // route
+} // oodles
+
+#endif
@@ -0,0 +1,250 @@
+// oodles
+#include "Shard.hpp"
+#include "Context.hpp"
+#include "CrawlerSession.hpp"
+
+// Boost
+#include <boost/bind.hpp>
+
+// STL
+using std::vector;
+using std::exception;
+
+// Boost
+using boost::bind;
+
+namespace {
+
+using oodles::route::oop::EndCrawl;
+
+/*
+ * The part of an EndCrawl for the shard of index i, created when first used
+ */
+EndCrawl&
+part(vector<EndCrawl*> &parts, size_t i)
+{
+    if (!parts[i])
+        parts[i] = new EndCrawl;
+
+    return *parts[i];
+}
+
+} // anonymous
+
+namespace oodles {
+namespace route {
+namespace oop {
+
+using net::DialogError;
+using net::oop::END_CRAWL;
+using net::oop::INVALID_ID;
+using net::oop::BEGIN_CRAWL;
+using net::oop::REGISTER_CRAWLER;
+
+/* This array holds the valid subset of messages understood by this dialog */
+const id_t CrawlerSession::message_subset[] = {
+    REGISTER_CRAWLER,
+    BEGIN_CRAWL,
+    END_CRAWL
+};
+
+CrawlerSession::CrawlerSession() : pending(NULL)
+{
+    msg_context[Inbound] = msg_context[Outbound] = INVALID_ID;
+}
+
+CrawlerSession::~CrawlerSession()
+{
+    close_shards();
+    delete pending;
+}
+
+void
+CrawlerSession::handle_message(Message *m)
+{
+    try {
+        continue_dialog(m);
+        delete m;
+    } catch (const exception &e) {
+        delete m;
+        throw;
+    }
+}
+
+void
+CrawlerSession::begin_crawl(size_t shard, const BeginCrawl &m)
+{
+    if (!pending) { // Send once every message already received is handled
+        pending = new BeginCrawl;
+        context().get_dispatcher().io_service().post(
+            bind(&CrawlerSession::flush, this, get_endpoint()));
+    }
+
+    for (size_t i = 0 ; i < m.hosts.size() ; ++i) {
+        for (size_t j = 0 ; j < m.hosts[i].size() ; ++j) {
+            const url::URL &u = m.hosts[i][j];
+            const url::URL::hash_t id = u.page_id();
+
+            if (!owners.insert(id, shard))
+                *owners.find(id) = shard;
+
+            pending->add(u);
+        }
+    }
+}
+
+/*
+ * The crawler is gone, so are its connections to the shards
+ */
+void
+CrawlerSession::close_shards()
+{
+    if (!shards.empty())
+        context().disconnect_shards(shards);
+}
+
+void
+CrawlerSession::send(Message *m)
+{
+    msg_context[Outbound] = m->id();
+    push_message(m);
+}
+
+/*
+ * Should the crawler have gone meanwhile its URLs are dropped; each shard
+ * reclaims them once the router closes its connection (see Context::sweep).
+ */
+void
+CrawlerSession::flush(net::Endpoint::Connection /* c */)
+{
+    BeginCrawl *m = pending;
+
+    pending = NULL;
+
+    if (online())
+        send(m);
+    else
+        delete m;
+}
+
+inline
+Context&
+CrawlerSession::context() const
+{
+    return *static_cast<Context*>(coupling->complement_of(*this));
+}
+
+void
+CrawlerSession::continue_dialog(const Message *m)
+throw (DialogError)
+{
+    /*
+     * Verify the context is valid based on this *incoming* message,
+     * the previous outbound message and previous inbound message.
+     */
+    switch (m->id()) {
+        /* Router Inbound (from the crawler) */
+        case REGISTER_CRAWLER:
+            if (msg_context[Inbound] != INVALID_ID)
+                throw DialogError("CrawlerSession::continue_dialog",
+                                   0,
+                                   "Invalid inbound context: P=#%d, C=#%d.",
+                                   msg_context[Inbound], m->id());
+
+            if (msg_context[Outbound] != INVALID_ID)
+                throw DialogError("CrawlerSession::continue_dialog",
+                                   0,
+                                   "Invalid outbound context: P=#%d, C=#%d.",
+                                   msg_context[Outbound], m->id());
+
+            continue_dialog(static_cast<const RegisterCrawler&>(*m));
+            break;
+        case END_CRAWL:
+            if (msg_context[Inbound] != END_CRAWL &&
+                msg_context[Inbound] != REGISTER_CRAWLER)
+                throw DialogError("CrawlerSession::continue_dialog",
+                                   0,
+                                   "Invalid inbound context: P=#%d, C=#%d.",
+                                   msg_context[Inbound], m->id());
+
+            if (msg_context[Outbound] != INVALID_ID &&
+                msg_context[Outbound] != BEGIN_CRAWL)
+                throw DialogError("CrawlerSession::continue_dialog",
+                                   0,
+                                   "Invalid outbound context: P=#%d, C=#%d.",
+                                   msg_context[Outbound], m->id());
+
+            continue_dialog(static_cast<const EndCrawl&>(*m));
+            break;
+        default:
+            throw DialogError("CrawlerSession::continue_dialog",
+                               0,
+                               "Received unexpected OOP message #%d.",
+                               m->id());
+    }
+
+    msg_context[Inbound] = m->id();
+}
+
+void
+CrawlerSession::continue_dialog(const RegisterCrawler &m)
+{
+    context().connect_shards(*this, m.name, m.cores, shards);
+}
+
+/*
+ * Every result, and response time, goes back to the shard that sent its
+ * URL and every new URL to the shard holding its domain. A result for a
+ * URL the router did not send on (before a restart, say) is sent to every
+ * shard; those that do not know the page ignore it.
+ */
+void
+CrawlerSession::continue_dialog(const EndCrawl &m)
+{
+    vector<EndCrawl*> parts(shards.size(), static_cast<EndCrawl*>(NULL));
+    EndCrawl::ScheduledURLs::const_iterator i = m.scheduled_urls.begin(),
+                                            j = m.scheduled_urls.end();
+    EndCrawl::NewURLs::const_iterator k = m.new_urls.begin(),
+                                      l = m.new_urls.end();
+    EndCrawl::ResponseTimes::const_iterator t = m.response_times.begin(),
+                                            u = m.response_times.end();
+
+    for ( ; t != u ; ++t) { // Before their results forget the owners
+        const size_t *shard = owners.find(t->first);
+
+        if (shard) {
+            part(parts, *shard).response_times.push_back(*t);
+        } else {
+            for (size_t s = 0 ; s < parts.size() ; ++s)
+                part(parts, s).response_times.push_back(*t);
+        }
+    }
+
+    for ( ; i != j ; ++i) {
+        const size_t *shard = owners.find(i->first);
+
+        if (shard) {
+            part(parts, *shard).scheduled_urls.push_back(*i);
+            owners.erase(i->first);
+        } else {
+            for (size_t s = 0 ; s < parts.size() ; ++s)
+                part(parts, s).scheduled_urls.push_back(*i);
+        }
+    }
+
+    for ( ; k != l ; ++k) {
+        try {
+            part(parts, context().shard_of(k->first)).new_urls.push_back(*k);
+        } catch (const url::ParseError &e) {
+            // No shard would be able to schedule it either
+        }
+    }
+
+    for (size_t s = 0 ; s < parts.size() ; ++s)
+        if (parts[s])
+            shards[s]->end_crawl(parts[s]);
+}
+
+} // oop
+} // route
+} // oodles
@@ -0,0 +1,81 @@
+#ifndef OODLES_ROUTE_OOP_CRAWLERSESSION_HPP
+#define OODLES_ROUTE_OOP_CRAWLERSESSION_HPP
+
+// oodles
+#include "ShardSession.hpp"
+
+#include "common/Exceptions.hpp"
+#include "utility/FlatHashMap.hpp"
+
+#include "net/oop/Session.hpp"
+#include "net/oop/Messages.hpp"
+
+// STL
+#include <vector>
+
+namespace oodles {
+namespace route {
+
+class Shard; // Forward declaration for CrawlerSession
+class Context; // Forward declaration for CrawlerSession
+
+namespace oop {
+
+/*
+ * The router's side of a crawler's dialog; it is held as the scheduler
+ * would hold it. The URLs sent by every shard are passed on to the crawler
+ * and its results are split between the shards they came from.
+ */
+class CrawlerSession : public net::oop::Session
+{
+    public:
+        /* Member functions/methods */
+        CrawlerSession();
+        ~CrawlerSession();
+
+        void handle_message(Message *m);
+
+        /*
+         * The URLs of m, sent by the shard of the given index, are sent on
+         * together with those of any other BeginCrawl received meanwhile.
+         */
+        void begin_crawl(size_t shard, const BeginCrawl &m);
+        void close_shards(); // The crawler is gone
+        void forget_shards() { shards.clear(); } // The Context is gone
+    private:
+        /* Member functions/methods */
+        void send(Message *m);
+        void flush(net::Endpoint::Connection c); // c keeps this alive
+        Context& context() const;
+
+        /*
+         * Message handling methods (inbound)
+         */
+        void continue_dialog(const Message *m) throw (net::DialogError);
+        void continue_dialog(const RegisterCrawler &m);
+        void continue_dialog(const EndCrawl &m);
+
+        /* Internal Data Structures */
+        enum {
+            Inbound = 0,
+            Outbound = 1
+        };
+
+        struct hash_id
+        {
+            size_t operator() (url::URL::hash_t h) const { return h; }
+        };
+
+        /* Member variables/attributes */
+        id_t msg_context[2];
+        std::vector<Shard*> shards; // By index, owned by the Context
+        FlatHashMap<url::URL::hash_t, size_t, hash_id> owners; // Page's shard
+        BeginCrawl *pending; // URLs not yet sent on, if any
+        static const id_t message_subset[];
+};
+
+} // oop
+} // route
+} // oodles
+
+#endif
@@ -0,0 +1,118 @@
+// oodles
+#include "Shard.hpp"
+#include "CrawlerSession.hpp"
+#include "utility/Dispatcher.hpp"
+
+// Boost
+#include <boost/bind.hpp>
+
+// STL
+using std::list;
+using std::string;
+
+// Boost
+using boost::bind;
+
+namespace oodles {
+namespace route {
+
+Shard::Shard(Dispatcher &d,
+             oop::CrawlerSession &c,
+             size_t index,
+             const string &name,
+             uint16_t cores) :
+    dispatcher(d),
+    session(&c),
+    shard(NULL),
+    connected(false),
+    position(index),
+    cores(cores),
+    name(name),
+    creator(*this),
+    client(d, creator)
+{
+}
+
+/*
+ * Closing the connection cancels its reads and writes; any message its
+ * session is yet to handle is dropped (see ShardSession).
+ */
+Shard::~Shard()
+{
+    if (shard) {
+        shard->set_shard(NULL);
+        shard->get_endpoint()->stop();
+    }
+
+    for (list<oop::EndCrawl*>::iterator i = backlog.begin() ;
+         i != backlog.end() ; ++i)
+        delete *i;
+}
+
+void
+Shard::connect(const string &service)
+{
+    client.start(service);
+}
+
+/*
+ * A Shard whose crawler went whilst it was connecting is deleted now that
+ * the Client is done with it, once the connection is started.
+ */
+void
+Shard::start(net::SessionHandler &s)
+{
+    shard = static_cast<oop::ShardSession*>(&s);
+    shard->set_shard(this);
+    connected = true;
+
+    if (!session) {
+        dispatcher.io_service().post(bind(&Shard::discard, this));
+        return;
+    }
+
+    shard->register_crawler(name, cores);
+
+    for ( ; !backlog.empty() ; backlog.pop_front())
+        shard->end_crawl(backlog.front());
+}
+
+/*
+ * Until connected the Client still refers to the Shard, so it is left to
+ * start() to delete it.
+ */
+bool
+Shard::close()
+{
+    session = NULL;
+
+    return connected;
+}
+
+void
+Shard::detach(const oop::ShardSession &s)
+{
+    if (shard == &s)
+        shard = NULL;
+}
+
+void
+Shard::begin_crawl(const oop::BeginCrawl &m)
+{
+    if (session)
+        session->begin_crawl(position, m);
+}
+
+void
+Shard::end_crawl(oop::EndCrawl *m)
+{
+    if (shard)
+        shard->end_crawl(m);
+    else if (!connected)
+        backlog.push_back(m);
+    else
+        delete m; // The shard is gone
+}
+
+} // route
+} // oodles
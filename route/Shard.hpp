@@ -0,0 +1,84 @@
+#ifndef OODLES_ROUTE_SHARD_HPP
+#define OODLES_ROUTE_SHARD_HPP
+
+// oodles
+#include "ShardSession.hpp"
+
+#include "net/core/Client.hpp"
+#include "net/oop/Protocol.hpp"
+#include "net/core/HandlerCreator.hpp"
+
+// STL
+#include <list>
+#include <string>
+
+namespace oodles {
+
+class Dispatcher; // Forward declaration for Shard
+
+namespace route {
+namespace oop {
+
+class CrawlerSession; // Forward declaration for Shard
+
+} // oop
+
+/*
+ * One crawler's connection, through the router, to one shard. The shard
+ * knows it as a crawler of the same name. EndCrawl messages for the shard
+ * are held back until the connection is made, and dropped once it is lost.
+ *
+ * The connection is closed as the Shard is deleted, once its crawler is
+ * gone, so the shard finds the crawler gone in turn; see close().
+ */
+class Shard : public net::CallerContext
+{
+    public:
+        /* Member functions/methods */
+        Shard(Dispatcher &d,
+              oop::CrawlerSession &c,
+              size_t index,
+              const std::string &name,
+              uint16_t cores);
+        ~Shard();
+
+        size_t index() const { return position; }
+        oop::CrawlerSession* crawler() const { return session; } // Or NULL
+
+        void connect(const std::string &service);
+        void start(net::SessionHandler &s);
+        bool close(); // Its crawler is gone; true if it may be deleted now
+        void detach(const oop::ShardSession &s); // If s is still its session
+
+        void begin_crawl(const oop::BeginCrawl &m); // From the shard
+        void end_crawl(oop::EndCrawl *m); // Ownership transferred
+    private:
+        /* Member variables/attributes */
+        Dispatcher &dispatcher;
+        oop::CrawlerSession *session; // NULL once the crawler is gone
+        oop::ShardSession *shard; // NULL until connected, or once lost
+        bool connected; // Whether or not still
+        std::list<oop::EndCrawl*> backlog;
+
+        const size_t position; // Index amongst the shards
+        const uint16_t cores;
+        const std::string name;
+
+        /*
+         * Network layer
+         */
+        typedef net::Creator<net::oop::Protocol, oop::ShardSession> Creator;
+        const Creator creator;
+        net::Client client;
+
+        /* Member functions/methods */
+        static void discard(Shard *s) { delete s; }
+
+        Shard(const Shard &s);
+        Shard& operator= (const Shard &s);
+};
+
+} // route
+} // oodles
+
+#endif
@@ -0,0 +1,123 @@
+// oodles
+#include "Shard.hpp"
+#include "ShardSession.hpp"
+#include "CrawlerSession.hpp"
+
+// STL
+using std::string;
+using std::exception;
+
+namespace oodles {
+namespace route {
+namespace oop {
+
+using net::DialogError;
+using net::oop::END_CRAWL;
+using net::oop::INVALID_ID;
+using net::oop::BEGIN_CRAWL;
+using net::oop::REGISTER_CRAWLER;
+
+/* This array holds the valid subset of messages understood by this dialog */
+const id_t ShardSession::message_subset[] = {
+    REGISTER_CRAWLER,
+    BEGIN_CRAWL,
+    END_CRAWL
+};
+
+ShardSession::ShardSession() : owner(NULL)
+{
+    msg_context[Inbound] = msg_context[Outbound] = INVALID_ID;
+}
+
+ShardSession::~ShardSession()
+{
+    if (owner)
+        owner->detach(*this);
+}
+
+void
+ShardSession::handle_message(Message *m)
+{
+    try {
+        continue_dialog(m);
+        delete m;
+    } catch (const exception &e) {
+        delete m;
+        throw;
+    }
+}
+
+void
+ShardSession::register_crawler(const string &name, uint16_t cores)
+{
+    RegisterCrawler *m = new RegisterCrawler;
+    m->cores = cores;
+    m->name = name;
+
+    send(m);
+}
+
+void
+ShardSession::end_crawl(EndCrawl *m)
+{
+    send(m);
+}
+
+void
+ShardSession::send(Message *m)
+{
+    msg_context[Outbound] = m->id();
+    push_message(m);
+}
+
+void
+ShardSession::continue_dialog(const Message *m)
+throw (DialogError)
+{
+    /*
+     * Verify the context is valid based on this *incoming* message,
+     * the previous outbound message and previous inbound message.
+     */
+    switch (m->id()) {
+        /* Router Inbound (from the shard) */
+        case BEGIN_CRAWL:
+            if (msg_context[Inbound] != INVALID_ID &&
+                msg_context[Inbound] != BEGIN_CRAWL)
+                throw DialogError("ShardSession::continue_dialog",
+                                   0,
+                                   "Invalid inbound context: P=#%d, C=#%d.",
+                                   msg_context[Inbound], m->id());
+
+            if (msg_context[Outbound] != END_CRAWL &&
+                msg_context[Outbound] != REGISTER_CRAWLER)
+                throw DialogError("ShardSession::continue_dialog",
+                                   0,
+                                   "Invalid outbound context: P=#%d, C=#%d.",
+                                   msg_context[Outbound], m->id());
+
+            continue_dialog(static_cast<const BeginCrawl&>(*m));
+            break;
+        default:
+            throw DialogError("ShardSession::continue_dialog",
+                               0,
+                               "Received unexpected OOP message #%d.",
+                               m->id());
+    }
+
+    msg_context[Inbound] = m->id();
+}
+
+void
+ShardSession::continue_dialog(const BeginCrawl &m)
+{
+    /*
+     * Pass the URLs on to the crawler, noting which shard they came from;
+     * they are dropped should the Shard, or its crawler, be gone
+     */
+    if (owner)
+        owner->begin_crawl(m);
+}
+
+} // oop
+} // route
+} // oodles
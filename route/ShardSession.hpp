@@ -0,0 +1,70 @@
+#ifndef OODLES_ROUTE_OOP_SHARDSESSION_HPP
+#define OODLES_ROUTE_OOP_SHARDSESSION_HPP
+
+// oodles
+#include "common/Exceptions.hpp"
+
+#include "net/oop/Session.hpp"
+#include "net/oop/Messages.hpp"
+
+// STL
+#include <string>
+
+// libc
+#include <stdint.h> // For uint16_t
+
+namespace oodles {
+namespace route {
+
+class Shard; // Forward declaration for ShardSession
+
+namespace oop {
+
+typedef net::oop::Message Message;
+typedef net::oop::EndCrawl EndCrawl;
+typedef net::oop::BeginCrawl BeginCrawl;
+typedef net::oop::RegisterCrawler RegisterCrawler;
+
+/*
+ * The router's side of a crawler's dialog with one shard; it is held as a
+ * crawler would hold its dialog with the scheduler.
+ */
+class ShardSession : public net::oop::Session
+{
+    public:
+        /* Member functions/methods */
+        ShardSession();
+        ~ShardSession();
+
+        void handle_message(Message *m);
+        void set_shard(Shard *s) { owner = s; } // NULL once it is gone
+
+        void register_crawler(const std::string &name, uint16_t cores);
+        void end_crawl(EndCrawl *m); // Ownership transferred
+    private:
+        /* Member functions/methods */
+        void send(Message *m);
+
+        /*
+         * Message handling methods (inbound)
+         */
+        void continue_dialog(const Message *m) throw (net::DialogError);
+        void continue_dialog(const BeginCrawl &m);
+
+        /* Internal Data Structures */
+        enum {
+            Inbound = 0,
+            Outbound = 1
+        };
+
+        /* Member variables/attributes */
+        id_t msg_context[2];
+        Shard *owner; // Of the connection, see Shard::start()
+        static const id_t message_subset[];
+};
+
+} // oop
+} // route
+} // oodles
+
+#endif
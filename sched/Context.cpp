@@ -1,20 +1,26 @@
 // oodles
 #include "Context.hpp"
+#include "utility/hash.hpp"
 #include "utility/NodeIO.hpp"
+#include "utility/Metrics.hpp"
 
 // Boost
 #include <boost/bind.hpp>
-#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/asio/placeholders.hpp>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/date_time/posix_time/conversion.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
+// STL
+#include <algorithm>
+
 // libc
-#include <sys/time.h>
-#include <sys/resource.h>
 
 // STL
 using std::map;
+using std::max;
 using std::pair;
 using std::string;
 using std::ostream;
@@ -29,120 +35,247 @@ namespace {
 using oodles::Dispatcher;
 using oodles::io::DotMatrix;
 using oodles::BreadCrumbTrail;
+using oodles::metrics::labelled;
+using oodles::metrics::Counter;
+using oodles::metrics::Registry;
+using oodles::metrics::Histogram;
+using oodles::sched::Trace;
+using oodles::sched::Context;
 using oodles::sched::Scheduler;
 
 // Boost
 using boost::bind;
-using boost::shared_ptr;
+using boost::lock_guard;
+using boost::posix_time::ptime;
 using boost::posix_time::seconds;
-using boost::asio::deadline_timer;
-using boost::enable_shared_from_this;
+using boost::posix_time::milliseconds;
+using boost::posix_time::from_time_t;
+using boost::posix_time::microsec_clock;
+
+} // anonymous
+
+namespace oodles {
+namespace sched {
 
-class DispatcherTask : public enable_shared_from_this<DispatcherTask>
+/*
+ * Performs a schedule update and then a scheduling run whenever triggered,
+ * i.e. as crawlers register or report back, and otherwise once every
+ * interval seconds. Triggers arriving within Coalesce ms of one another,
+ * or while a run is under way, are served by a single run and no run
+ * begins within Spacing ms of the one before it.
+ */
+class DispatcherTask : public boost::enable_shared_from_this<DispatcherTask>
 {
     public:
         /* Member functions/methods */
-        DispatcherTask(Dispatcher &d, Scheduler &s, ostream *dot, int interval):
-            scheduler(s),
-            dispatcher(d),
-            dot_stream(dot),
-            interval(interval),
+        DispatcherTask(Dispatcher &d, Context &c) :
+            context(c),
+            scheduler(c.get_scheduler()),
+            run_latency(Registry::global().histogram("sched_run_microseconds",
+                "Time taken by each scheduling run")),
+            update_latency(Registry::global().histogram(
+                "sched_update_microseconds",
+                "Time taken by each update from the crawls returned")),
+            assigned(Registry::global().counter("sched_assigned_urls_total",
+                "URLs assigned to crawlers")),
+            updated(Registry::global().counter("sched_updated_urls_total",
+                "Crawled URLs updated in the tree")),
+            runs(Registry::global().counter("sched_runs_total",
+                "Scheduling runs made")),
+            triggers(Registry::global().counter("sched_triggers_total",
+                "Scheduling runs asked for by crawlers")),
+            dot_stream(NULL),
+            dot_depth(0),
+            trace(NULL),
+            interval(1),
+            workers(1),
+            started(false),
+            running(false),
+            pending(false),
             sleeper(d.io_service())
         {
-            new_task();
         }
+
+        void start(ostream *dot, int depth, Trace *t, int period, size_t threads)
+        {
+            const lock_guard<boost::mutex> lock(mutex);
+
+            dot_stream = dot;
+            dot_depth = depth;
+            trace = t;
+            interval = period;
+            workers = threads;
+            started = true;
+
+            arm(microsec_clock::universal_time());
+        }
+
+        void trigger()
+        {
+            const lock_guard<boost::mutex> lock(mutex);
+
+            triggers.add();
+
+            if (!started)
+                return; // The first run will see to it
+
+            if (running) {
+                pending = true;
+                return;
+            }
+
+            const ptime t(soonest());
+
+            if (t < wake) // Otherwise a run is due sooner anyway
+                arm(t);
+        }
+
+        void operator() (const boost::system::error_code &e)
+        {
+            if (e == boost::asio::error::operation_aborted)
+                return; // Re-armed for an earlier run
+
+            {
+                const lock_guard<boost::mutex> lock(mutex);
+
+                running = true;
+                pending = false;
+                last_run = microsec_clock::universal_time();
+            }
+
+            run();
+
+            const lock_guard<boost::mutex> lock(mutex);
+
+            running = false;
+            arm(pending ? soonest() : last_run + seconds(interval));
+        }
+    private:
+        /* Internal Data Structures */
+        enum {
+            Coalesce = 5, // ms to wait for further triggers
+            Spacing = 50 // Least ms between the starts of two runs
+        };
+
+        /* Member variables/attributes */
+        Context &context;
+        Scheduler &scheduler;
+
+        Histogram &run_latency, &update_latency; // In microseconds
+        Counter &assigned, &updated, &runs, &triggers;
         
-        void operator() ()
+        ostream *dot_stream;
+        int dot_depth; // Levels of the tree drawn, 0 for all
+        Trace *trace;
+        int interval; // Seconds between runs when never triggered
+        size_t workers; // Partitions filled concurrently by run
+
+        boost::mutex mutex; // Held for all below
+        bool started, running, pending; // Pending: triggered while running
+        ptime last_run, wake; // Start of the last run, when next due
+        boost::asio::deadline_timer sleeper;
+
+        /* Member functions/methods */
+        ptime soonest() const
+        {
+            const long coalesce = Coalesce, spacing = Spacing;
+
+            return max(microsec_clock::universal_time() + milliseconds(coalesce),
+                       last_run + milliseconds(spacing));
+        }
+
+        /*
+         * (Re)setting the expiry cancels the wait already under way, if
+         * any, whose handler is then called with operation_aborted.
+         */
+        void arm(const ptime &t)
+        {
+            wake = t;
+            sleeper.expires_at(t);
+            sleeper.async_wait(bind(&DispatcherTask::operator(),
+                                    shared_from_this(),
+                                    boost::asio::placeholders::error));
+        }
+
+        void run()
         {
-            struct rusage x, y;
             BreadCrumbTrail trail;
-            size_t then = time(NULL), assigned = 0, d = 0;
-            
-#ifdef DEBUG_SCHED
-            std::cerr << "Performing schedule update...";
-#endif
-            getrusage(RUSAGE_SELF, &x);
-            assigned = scheduler.update_schedule();
-            getrusage(RUSAGE_SELF, &y);
+            Trace::Run r;
+            ptime t(microsec_clock::universal_time());
+            uint32_t n = scheduler.update_schedule(workers);
+            uint64_t d = microseconds_since(t);
+
+            update_latency.record(d);
+            updated.add(n);
+            r.start = (t - from_time_t(0)).total_milliseconds();
+            r.update_time = d;
+            r.updated = n;
 
 #ifdef DEBUG_SCHED
-            std::cerr << assigned << " URLs updated.\n";
-            std::cerr << "\tRun took " << y.ru_utime.tv_sec - x.ru_utime.tv_sec
-                      << '.' << abs(y.ru_utime.tv_usec - x.ru_utime.tv_usec)
-                      << "s/u, " << y.ru_stime.tv_sec - x.ru_stime.tv_sec
-                      << '.' << abs(y.ru_stime.tv_usec - x.ru_stime.tv_usec)
-                      << "s/s\n";
-#endif
-            
-#ifdef DEBUG_SCHED
-            std::cerr << "Performing scheduling run...";
+            std::cerr << "Schedule update: " << n << " URLs updated in "
+                      << d << "us\n";
 #endif
 
-            getrusage(RUSAGE_SELF, &x);
-            assigned = scheduler.run(&trail);
-            getrusage(RUSAGE_SELF, &y);
-            
+            t = microsec_clock::universal_time();
+
+            const bool serial = workers <= 1 || dot_stream;
+
+            if (!serial) // The trail is only left serially
+                n = scheduler.run_parallel(workers);
+            else
+                n = scheduler.run(&trail);
+
+            d = microseconds_since(t);
+            run_latency.record(d);
+            assigned.add(n);
+            runs.add();
+            r.run_time = d;
+            r.assigned = n;
+
 #ifdef DEBUG_SCHED
-            std::cerr << assigned << " URLs assigned.\n";
-            std::cerr << "\tRun took " << y.ru_utime.tv_sec - x.ru_utime.tv_sec
-                      << '.' << abs(y.ru_utime.tv_usec - x.ru_utime.tv_usec)
-                      << "s/u, " << y.ru_stime.tv_sec - x.ru_stime.tv_sec
-                      << '.' << abs(y.ru_stime.tv_usec - x.ru_stime.tv_usec)
-                      << "s/s\n";
+            std::cerr << "Scheduling run: " << n << " URLs assigned in "
+                      << d << "us\n";
 #endif
 
+            if (trace) {
+                /*
+                 * The trace gathers the trail as it follows it, so the DOT
+                 * graph is drawn from the original
+                 */
+                BreadCrumbTrail copy;
+                BreadCrumbTrail *followed = &trail;
+
+                if (dot_stream) {
+                    copy = trail;
+                    followed = &copy;
+                }
+
+                trace->record(r, scheduler.url_tree(), serial ? followed : NULL);
+            }
+
             if (dot_stream) {
 #ifdef DEBUG_SCHED
                 std::cerr << "Writing DOT graph of schedule run...";
 #endif
                 DotMatrix dot(scheduler.url_tree());
                 dot.set_trail(trail);
+                dot.set_depth(dot_depth);
                 *dot_stream << dot;
 #ifdef DEBUG_SCHED
                 std::cerr << "done.\n";
 #endif
             }
-            
-            if ((d = time(NULL) - then) < interval) {
-                sleeper.expires_from_now(seconds(interval - d));
-                sleeper.async_wait(bind(&DispatcherTask::new_task,
-                                        shared_from_this()));
-            } else {
-                new_task();
-            }
-        }
-        
-        void new_task()
-        {
-            shared_ptr<DispatcherTask> task(new DispatcherTask(*this));
-            task->dispatcher.io_service().post(bind(&DispatcherTask::operator(),
-                                                    task));
+
+            context.sample_metrics();
+            context.persist_state(); // Sync the journal, checkpoint if due
         }
-    private:
-        /* Member variables/attributes */
-        Scheduler &scheduler;
-        Dispatcher &dispatcher;
-        
-        ostream *dot_stream;
-        const int interval;
-        deadline_timer sleeper;
 
-        /* Member functions/methods */
-        DispatcherTask(const DispatcherTask &t) :
-            scheduler(t.scheduler),
-            dispatcher(t.dispatcher),
-            dot_stream(t.dot_stream),
-            interval(t.interval),
-            sleeper(t.dispatcher.io_service())
+        static uint64_t microseconds_since(const ptime &t)
         {
+            return (microsec_clock::universal_time() - t).total_microseconds();
         }
 };
 
-} // anonymous
-
-namespace oodles {
-namespace sched {
-
 // NetContext
 Context::NetContext::NetContext(Context *c) : context(c) {}
 
@@ -155,12 +288,24 @@ Context::NetContext::start(net::SessionHandler &s)
 // Context
 Context::Context() :
     scheduler(&dispatcher),
+    task(new DispatcherTask(dispatcher, *this)),
+    shard(0),
+    shards(1),
+    checkpoint_interval(0),
+    last_checkpoint(0),
+    checkpointed(false),
     net_context(this),
     creator(net_context),
     server(dispatcher, creator)
 {
 }
 
+Context::~Context()
+{
+    if (checkpointer)
+        checkpointer->join(); // It writes from image, a member
+}
+
 void
 Context::stop_crawling()
 {
@@ -168,10 +313,29 @@ Context::stop_crawling()
 }
 
 void
-Context::start_crawling(ostream *dot_stream, int interval)
+Context::start_crawling(ostream *dot_stream,
+                        int interval,
+                        size_t workers,
+                        int dot_depth)
 {
-    DispatcherTask t(dispatcher, scheduler, dot_stream, interval);
+    task->start(dot_stream, dot_depth, trace.get(), interval, workers);
     dispatcher.wait();
+
+    if (journal) { // Leave a snapshot of the final state behind
+        reap_checkpoint(true);
+        checkpoint();
+        reap_checkpoint(true);
+    }
+}
+
+/*
+ * Have a scheduling run made shortly, rather than waiting out the interval
+ * given to start_crawling(), as crawlers now have room for more work.
+ */
+void
+Context::trigger_schedule()
+{
+    task->trigger();
 }
 
 void
@@ -180,21 +344,179 @@ Context::start_server(const string &service)
     server.start(service);
 }
 
+/*
+ * This scheduler is one of count, each holding the domains that jump() to
+ * its own index; see route::Context. Only those of its seeds are kept.
+ */
+void
+Context::set_shard(uint32_t index, uint32_t count)
+{
+    assert(index < count);
+
+    shard = index;
+    shards = count;
+}
+
 void
 Context::seed_scheduler(const std::string &url)
 {
+    if (shards > 1 && jump(url::URL(url).domain_id(), shards) != shard)
+        return; // Another shard's domain
+
     scheduler.schedule_from_seed(url);
 }
 
+/*
+ * Called from the sessions' threads, so the Scheduler is left to take a new
+ * Crawler at its next run
+ */
 Crawler&
 Context::create_crawler(const string &name, uint16_t cores)
 {
     typedef map<string, Crawler>::value_type Value;
     typedef map<string, Crawler>::iterator Iterator;
+    const lock_guard<boost::mutex> lock(crawler_guard);
     pair<Iterator, bool> x(crawlers.insert(Value(name, Crawler(name, cores))));
 
+    if (x.second) // A Crawler registering again is already known
+        scheduler.register_crawler(x.first->second);
+
     return x.first->second;
 }
 
+/*
+ * Rebuild the Scheduler from the snapshot and journal(s) held in directory
+ * and log every subsequent change there. A new snapshot is written every
+ * interval seconds.
+ *
+ * Returns the no. of journal records replayed over the snapshot.
+ */
+uint32_t
+Context::restore_state(const string &directory, int interval)
+{
+    uint32_t generation = 0, replayed = 0;
+
+    snapshot.reset(new Snapshot(directory + "/snapshot"));
+    journal.reset(new Journal(directory));
+
+    if (snapshot->exists())
+        generation = snapshot->read(scheduler);
+
+    replayed = journal->replay(scheduler, generation);
+    journal->open();
+    scheduler.set_journal(journal.get());
+
+    checkpoint_interval = interval;
+    last_checkpoint = time(NULL);
+
+    return replayed;
+}
+
+/*
+ * Record every scheduling run in the trace at path, see Trace
+ */
+void
+Context::trace_runs(const string &path, size_t limit)
+{
+    trace.reset(new Trace(path, limit));
+    trace->open();
+}
+
+/*
+ * Set the gauges of the scheduler's size and of every crawler's work
+ */
+void
+Context::sample_metrics()
+{
+    Registry &r = Registry::global();
+
+    r.gauge("sched_nodes", "Nodes of the URL tree").set(Node::allocated());
+    r.gauge("sched_pages", "Pages held, i.e. entries of the page table")
+        .set(scheduler.pages());
+
+    const lock_guard<boost::mutex> lock(crawler_guard); // See create_crawler()
+
+    for (map<string, Crawler>::const_iterator i = crawlers.begin() ;
+         i != crawlers.end() ; ++i)
+    {
+        const Crawler &c = i->second;
+        const string &name = c.id();
+
+        r.gauge(labelled("sched_crawler_assigned", "crawler", name),
+                "URLs assigned to a crawler and yet to be returned")
+            .set(c.assigned());
+        r.gauge(labelled("sched_crawler_unit_size", "crawler", name),
+                "URLs a crawler is sent at most")
+            .set(c.max_unit_size());
+        r.gauge(labelled("sched_crawler_throughput", "crawler", name),
+                "URLs a crawler is estimated to crawl per second")
+            .set(c.throughput() * 1000);
+    }
+}
+
+void
+Context::persist_state()
+{
+    if (!journal)
+        return;
+
+    journal->sync();
+    reap_checkpoint(false);
+
+    if (!checkpointer && time(NULL) - last_checkpoint >= checkpoint_interval)
+        checkpoint();
+}
+
+/*
+ * Begin a new journal generation and take an image of the matching
+ * snapshot. This is called between scheduling runs, from the task that
+ * applies every update, so the tree is still; the image is then written
+ * on a thread of its own while scheduling continues.
+ */
+void
+Context::checkpoint()
+{
+    journal->rotate();
+    last_checkpoint = time(NULL);
+
+    Snapshot::image(scheduler, journal->generation(), image);
+    checkpointed = false;
+    checkpointer.reset(new boost::thread(
+        boost::bind(&Context::write_checkpoint, this)));
+}
+
+void
+Context::write_checkpoint()
+{
+    try {
+        snapshot->write(image);
+        checkpointed = true;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void
+Context::reap_checkpoint(bool block)
+{
+    if (!checkpointer)
+        return; // No snapshot being written
+
+    if (block)
+        checkpointer->join();
+    else if (!checkpointer->timed_join(boost::posix_time::seconds(0)))
+        return; // Yet to complete
+
+    checkpointer.reset();
+    image.clear();
+
+    /*
+     * Only once the new snapshot is in place can the journals it holds
+     * be discarded. Should it have failed they're replayed on restart.
+     */
+    if (checkpointed)
+        journal->discard(journal->generation());
+}
+
 } // sched
 } // oodles
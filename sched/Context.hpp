@@ -2,8 +2,11 @@
 #define OODLES_SCHED_CONTEXT_HPP
 
 // oodles
+#include "Journal.hpp"
+#include "Trace.hpp"
 #include "Session.hpp"
 #include "Crawler.hpp"
+#include "Snapshot.hpp"
 #include "Scheduler.hpp"
 
 #include "net/core/Server.hpp"
@@ -14,27 +17,48 @@
 #include "utility/Dispatcher.hpp"
 #include "utility/BreadCrumbTrail.hpp"
 
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
 // STL
 #include <map>
+#include <string>
 #include <iostream>
 
 namespace oodles {
 namespace sched {
 
+class DispatcherTask; // Forward declaration for Context
+
 class Context : public Linker
 {
     public:
         /* Member functions/methods */
         Context();
+        ~Context();
         
         Scheduler& get_scheduler() { return scheduler; }
+        Dispatcher& get_dispatcher() { return dispatcher; }
         
+        void set_shard(uint32_t index, uint32_t count);
         void seed_scheduler(const std::string &url);
         void start_server(const std::string &service);
         Crawler& create_crawler(const std::string &name, uint16_t cores);
+        void trigger_schedule();
+
+        uint32_t restore_state(const std::string &directory, int interval);
+        void persist_state();
+        void sample_metrics();
+        void trace_runs(const std::string &path,
+                        size_t limit = Trace::Limit);
 
         void stop_crawling();
-        void start_crawling(std::ostream *dot_stream = NULL, int interval = 1);
+        void start_crawling(std::ostream *dot_stream = NULL,
+                            int interval = 1,
+                            size_t workers = 1,
+                            int dot_depth = 0); // Levels drawn, 0 for all
     private:
         /* Internal Data Structures */
         class NetContext : public net::CallerContext
@@ -57,8 +81,27 @@ class Context : public Linker
          * Scheduler layer
          */
         Scheduler scheduler;
+        boost::shared_ptr<DispatcherTask> task; // Makes scheduling runs
         BreadCrumbTrail trail;
         std::map<std::string, Crawler> crawlers;
+        boost::mutex crawler_guard; // Held for crawlers, see create_crawler()
+        uint32_t shard, shards; // This scheduler's share of the domains
+
+        /*
+         * Persistence layer
+         */
+        boost::scoped_ptr<Journal> journal;
+        boost::scoped_ptr<Snapshot> snapshot;
+        int checkpoint_interval; // Seconds between snapshots
+        time_t last_checkpoint;
+        Snapshot::Image image; // Of the snapshot being written, if any
+        boost::scoped_ptr<boost::thread> checkpointer; // Writing image
+        volatile bool checkpointed; // The image was written successfully
+
+        /*
+         * Diagnostics
+         */
+        boost::scoped_ptr<Trace> trace; // Of every scheduling run, if any
 
         /*
          * Network layer
@@ -67,6 +110,11 @@ class Context : public Linker
         NetContext net_context;
         const Creator creator;
         net::Server server;
+
+        /* Member functions/methods */
+        void checkpoint();
+        void write_checkpoint();
+        void reap_checkpoint(bool block);
 };
 
 } // sched
@@ -1,20 +1,66 @@
 // oodles
 #include "Crawler.hpp"
-#include "url/URL.hpp"
+
+// STL
+#include <limits>
+
+// libc
+#include <math.h> // For exp()
+#include <assert.h> // For assert()
 
 // STL
 using std::string;
 using std::vector;
 using std::lower_bound;
+using std::numeric_limits;
+
+namespace {
+
+/*
+ * Bounds of the time a Crawler is held back after its work is reclaimed
+ */
+const uint32_t MinBackoff = 1000; // ms
+const uint32_t MaxBackoff = 300000;
+
+/*
+ * Weight of each round trip within the moving average latency of a Crawler
+ */
+const double Smoothing = 0.125;
+
+/*
+ * Size of the work unit per core of a Crawler yet to return a crawl
+ */
+const uint16_t InitialUnit = 32;
+
+} // anonymous
 
 namespace oodles {
 namespace sched {
 
+// UnitSizing
+UnitSizing::UnitSizing(uint16_t minimum, uint16_t maximum, uint32_t cycle) :
+    minimum(minimum),
+    maximum(maximum),
+    cycle(cycle)
+{
+}
+
+// Crawler
 Crawler::Crawler(const string &name, uint16_t cores) :
     session(NULL),
+    stranded(false),
+    held(false),
+    held_until(0),
+    backoff(0),
     cores(cores),
-    name(name)
+    name(name),
+    unit_size(0),
+    latency(0),
+    returns(0),
+    busy(0),
+    returned(0)
 {
+    resize(InitialUnit * cores);
     work_unit.reserve(max_unit_size());
 }
 
@@ -26,34 +72,144 @@ Crawler::begin_crawl()
 }
 
 Crawler::unit_t
-Crawler::add_url(url::URL &url)
+Crawler::add_url(Node &n)
 {
     work_unit.insert(lower_bound(work_unit.begin(),
                                  work_unit.end(),
-                                 &url), &url);
+                                 &n), &n);
     return assigned();
 }
 
 Crawler::unit_t
-Crawler::remove_url(url::URL &url)
+Crawler::remove_url(Node &n)
 {
-    vector<url::URL*>::iterator i = lower_bound(work_unit.begin(),
-                                                work_unit.end(),
-                                                &url);
+    vector<Node*>::iterator i = lower_bound(work_unit.begin(),
+                                            work_unit.end(),
+                                            &n);
 
-    assert(i != work_unit.end() && *i == &url);
+    assert(i != work_unit.end() && *i == &n);
     work_unit.erase(i);
 
     return assigned();
 }
 
+/*
+ * A Crawler that registers again (e.g. after a restart) knows nothing of
+ * any work sent over its previous Session.
+ */
 void
 Crawler::set_session(oop::Session *s)
 {
-    assert(!session);
+    stranded = assigned() > 0;
     session = s;
 }
 
+void
+Crawler::detach(const oop::Session &s)
+{
+    if (session == &s)
+        session = NULL;
+}
+
+void
+Crawler::hold(msec_t now)
+{
+    if (backoff == 0)
+        backoff = MinBackoff;
+    else if (backoff < MaxBackoff / 2)
+        backoff *= 2;
+    else
+        backoff = MaxBackoff;
+
+    held = true;
+    held_until = now + backoff;
+    stranded = false; // Its work has been reclaimed
+}
+
+void
+Crawler::resume(msec_t now)
+{
+    if (held && now >= held_until)
+        held = false;
+}
+
+void
+Crawler::completed(msec_t dispatched, msec_t now)
+{
+    const double sample = now > dispatched ? now - dispatched : 1;
+
+    latency = latency ? latency + Smoothing * (sample - latency) : sample;
+    backoff = 0; // It is working once more
+
+    /*
+     * The time spent on a URL runs from the return of the one before it or
+     * its dispatch, whichever is later (the Crawler may have been idle); a
+     * URL returned along with others took no time of its own. The totals
+     * decay with time so the rate follows a Crawler whose speed changes.
+     */
+    const msec_t start = returned > dispatched ? returned : dispatched;
+    const double spent = now > start ? now - start : 0,
+                 decay = exp(-spent / sizing.cycle);
+
+    returns = returns * decay + 1;
+    busy = busy * decay + spent;
+    returned = now;
+
+    /*
+     * A Crawler that drains its unit within the cycle is not held back by
+     * its size, so its unit is only ever grown (it would otherwise shrink
+     * with the work the frontier happens to have for it).
+     */
+    const double estimate = throughput() * sizing.cycle;
+
+    if (estimate > unit_size || latency > sizing.cycle)
+        resize(estimate);
+}
+
+void
+Crawler::set_sizing(const UnitSizing &s)
+{
+    sizing = s;
+    resize(busy > 0 ? throughput() * sizing.cycle : InitialUnit * cores);
+}
+
+/*
+ * Until any time has been spent on a returned URL its initial unit is
+ * taken as a cycle's worth.
+ */
+double
+Crawler::throughput() const
+{
+    if (busy == 0)
+        return static_cast<double>(unit_size) / sizing.cycle;
+
+    return returns / busy;
+}
+
+bool
+Crawler::lost() const
+{
+    return assigned() > 0 && (stranded || offline());
+}
+
+void
+Crawler::resize(double estimate)
+{
+    const double minimum = static_cast<double>(sizing.minimum) * cores,
+                 maximum = static_cast<double>(sizing.maximum) * cores;
+
+    if (estimate < minimum)
+        estimate = minimum;
+
+    if (estimate > maximum)
+        estimate = maximum;
+
+    if (estimate > numeric_limits<unit_t>::max())
+        estimate = numeric_limits<unit_t>::max();
+
+    unit_size = static_cast<unit_t>(estimate);
+}
+
 bool
 RankCrawler::operator() (const Crawler *lhs, const Crawler *rhs) const
 {
@@ -61,13 +217,16 @@ RankCrawler::operator() (const Crawler *lhs, const Crawler *rhs) const
      * First, be sure to check that the Crawlers have a valid Session!!
      */
     if (lhs->online() && rhs->online()) {
-        if (lhs->assigned() == rhs->assigned())
+        const double l = lhs->drain_time(), r = rhs->drain_time();
+
+        if (l == r)
             return false; // Maintain a stable queue
 
         /*
-         * Always prefer Crawlers with less work at the front of the queue
+         * Always prefer Crawlers that will be done soonest (with their work
+         * and throughput) at the front of the queue
          */
-        return lhs->assigned() > rhs->assigned();
+        return l > r;
     }
 
     /*
@@ -9,46 +9,97 @@
 #include <string>
 #include <functional>
 
-#include <stdint.h> // For uint16_t
+#include <stdint.h> // For uint16_t, uint64_t
 
 namespace oodles {
 
-namespace url {
-    class URL; // Forward declaration for Crawler
-} // url
-
 namespace sched {
 
+class Node; // Forward declaration for Crawler
+
+/*
+ * A Crawler is sent as many URLs as it is estimated to crawl in cycle ms,
+ * within minimum and maximum URLs per core.
+ */
+struct UnitSizing
+{
+    uint16_t minimum, maximum; // URLs per core
+    uint32_t cycle; // ms
+
+    UnitSizing(uint16_t minimum = 4,
+               uint16_t maximum = 256,
+               uint32_t cycle = 60000);
+};
+
 class Crawler
 {
     public:
         /* Dependent typedefs */
         typedef uint16_t unit_t;
+        typedef uint64_t msec_t;
 
         /* Member functions/methods */
         Crawler(const std::string &name, uint16_t cores = 1);
+        virtual ~Crawler() {}
 
-        void begin_crawl();
-        unit_t add_url(url::URL &url);
-        unit_t remove_url(url::URL &url);
+        virtual void begin_crawl();
+        unit_t add_url(Node &n); // The page at leaf n
+        unit_t remove_url(Node &n);
         void set_session(oop::Session *s);
+        void detach(const oop::Session &s); // If s is still its Session
+
+        /*
+         * A Crawler whose work is reclaimed is held back, for longer each
+         * time in succession, until it returns a crawl once more.
+         */
+        void hold(msec_t now);
+        void resume(msec_t now); // If the hold has expired
+
+        /*
+         * A URL sent at dispatched was returned crawled at now. Its round
+         * trip refines the estimates of the latency and throughput of the
+         * Crawler, and so the size of its work unit.
+         */
+        void completed(msec_t dispatched, msec_t now);
+        void set_sizing(const UnitSizing &s);
 
-        bool online() const { return !offline(); }
+        bool online() const { return !held && !offline(); }
+        bool lost() const; // Its work unit will never be returned
         const std::string& id() const { return name; }
 
-        unit_t max_unit_size() const { return 32 * cores; }
+        uint16_t core_count() const { return cores; }
+        unit_t max_unit_size() const { return unit_size; }
         unit_t assigned() const { return work_unit.size(); }
-        bool full() const { return assigned() == max_unit_size(); }
-    private:
+        const std::vector<Node*>& unit() const { return work_unit; }
+        bool full() const { return assigned() >= max_unit_size(); }
+
+        double throughput() const; // URLs per ms, estimated
+        double drain_time() const { return assigned() / throughput(); }
+    protected:
         /* Member functions/methods */
-        bool offline() const { return !session || !session->online(); }
+        virtual bool offline() const { return !session || !session->online(); }
 
+        /* Member variables/attributes */
+        std::vector<Node*> work_unit; // Units of work (leaves to crawl)
+    private:
         /* Member variables/attributes */
         oop::Session *session; // Network session for this Crawler
-        
+        bool stranded; // Work unit sent over a previous Session
+        bool held;
+        msec_t held_until;
+        uint32_t backoff; // Length of the last hold, in ms
+
         const uint16_t cores;
         const std::string name; // Identifier for this Crawler (i.e. hostname)
-        std::vector<url::URL*> work_unit; // Units of work (URLs to crawl)
+
+        UnitSizing sizing;
+        unit_t unit_size;
+        double latency; // Moving average of round trips (ms) or 0
+        double returns, busy; // URLs returned and ms spent on them, decayed
+        msec_t returned; // Time of the last crawl returned
+
+        /* Member functions/methods */
+        void resize(double estimate);
 };
 
 struct RankCrawler : std::binary_function<Crawler, Crawler, bool>
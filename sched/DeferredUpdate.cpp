@@ -1,68 +1,293 @@
 // oodles
 #include "Scheduler.hpp"
 #include "DeferredUpdate.hpp"
+#include "utility/hash.hpp"
+#include "utility/Metrics.hpp"
 #include "utility/Subscriber.hpp"
 
+// Boost.thread
+#include <boost/thread/locks.hpp>
+
 // STL
-using std::list;
+using std::set;
+using std::string;
+using std::vector;
+using std::make_pair;
+
+namespace {
+
+/*
+ * Hash of a URL exactly as given, before any parsing
+ */
+oodles::url::URL::hash_t
+string_id(const string &url)
+{
+#ifdef HAS_64_BITS
+    return oodles::fnv64(url.data(), url.size());
+#else
+    return oodles::fnv32(url.data(), url.size());
+#endif
+}
+
+} // anonymous
 
 namespace oodles {
 namespace sched {
 
-DeferredUpdate::DeferredUpdate(Dispatcher &d) : publisher(&d)
+// DeferredUpdate
+DeferredUpdate::DeferredUpdate(Dispatcher &d) :
+    bound(0),
+    publisher(&d),
+    backlog(metrics::Registry::global().gauge("sched_update_backlog",
+            "Crawls returned and yet to be updated in the tree")),
+    holds(metrics::Registry::global().counter("sched_update_holds_total",
+          "Sessions held from reading whilst the backlog exceeded its bound")),
+    links_found(metrics::Registry::global().counter("sched_links_found_total",
+                "Links found by the crawls updated")),
+    links_scheduled(metrics::Registry::global().counter(
+                    "sched_links_scheduled_total",
+                    "Distinct URLs scheduled of the links found by each run")),
+    results_reported(metrics::Registry::global().counter(
+                     "sched_results_reported_total",
+                     "Results of pages reported by the crawls updated")),
+    results_applied(metrics::Registry::global().counter(
+                    "sched_results_applied_total",
+                    "Distinct pages updated of the results taken by each run")),
+    links_ratio(metrics::Registry::global().gauge(
+                metrics::labelled("sched_coalesce_ratio", "of", "links"),
+                "Taken by the last run for each applied")),
+    results_ratio(metrics::Registry::global().gauge(
+                  metrics::labelled("sched_coalesce_ratio", "of", "results"),
+                  "Taken by the last run for each applied"))
 {
 }
 
-void
+DeferredUpdate::~DeferredUpdate()
+{
+    size_t n = 0;
+    Update *u = updates.drain(n);
+
+    while (u) {
+        Update *next = u->next;
+        delete u;
+        u = next;
+    }
+
+    backlog.add(-static_cast<double>(n));
+}
+
+/*
+ * Any thread. Returns true if the backlog now exceeds the bound, in which
+ * case the session deferring d should be held.
+ */
+bool
 DeferredUpdate::defer(const Deferable &d, event::Subscriber &s)
 {
-    updates.push_back(d);
-    updates.back().add_subscriber(s);
+    const size_t n = updates.push(new Update(d, &s));
+
+    backlog.add(1);
+
+    return bound > 0 && n > bound;
+}
+
+/*
+ * Reads from e are held until a run has taken enough of the backlog. The
+ * backlog is looked at once more having done so, as the run may have
+ * taken it between the update deferred and now.
+ */
+void
+DeferredUpdate::hold(const net::Endpoint::Connection &e)
+{
+    const boost::lock_guard<boost::mutex> lock(mutex);
+
+    if (held.insert(e).second) {
+        e->hold_recv();
+        holds.add();
+    }
+
+    release();
+}
+
+void
+DeferredUpdate::release()
+{
+    if (held.empty() || updates.size() > bound / 2)
+        return;
+
+    for (set<net::Endpoint::Connection>::const_iterator i = held.begin() ;
+         i != held.end() ;
+         ++i)
+        (*i)->release_recv();
+
+    held.clear();
 }
 
 uint32_t
-DeferredUpdate::update(Scheduler &s)
+DeferredUpdate::update(Scheduler &s, size_t workers)
 {
-    uint32_t x = 0;
-    url::URL::hash_t id = 0;
-    const time_t now = time(NULL);
+    const time_t now = s.get_clock().now();
+    size_t n = 0;
+    uint32_t x = 0, y = 0;
+    Update *first = updates.drain(n), *m = NULL, *next = NULL;
+    Coalesced c;
+    vector<url::URL::hash_t> ids;
+    vector<Scheduler::Outcome> outcomes;
     Deferable::NewURLs::const_iterator i, j;
     Deferable::ScheduledURLs::const_iterator k, l;
-    list<Update>::const_iterator m = updates.begin(), n = updates.end();
-
-    for ( ; m != n ; ++m) {
-        for (i = m->new_urls.begin(), j = m->new_urls.end() ;
-             i != j ; 
-             ++i)
-        {
-            id = s.schedule_from_crawl(i->first);
-
-            if (i->second)
-                s.update_node(id, now);
-        }
-        
-        for (k = m->scheduled_urls.begin(), l = m->scheduled_urls.end() ; 
+    Deferable::ResponseTimes::const_iterator t, u;
+
+    /*
+     * A popular link is found by many of the crawls, and a page may be
+     * reported by more than one (its lease having expired in between).
+     */
+    for (m = first ; m ; m = m->next) {
+        for (i = m->new_urls.begin(), j = m->new_urls.end() ; i != j ; ++i)
+            c.add_link(i->first, i->second);
+
+        for (k = m->scheduled_urls.begin(), l = m->scheduled_urls.end() ;
              k != l ;
              ++k)
-        {
-            ++x;
-            id = k->first;
-            s.update_node(id, now);
-        }
-
-        /*
-         * Inform the subscriber(s), the garbage collector(s), that we are
-         * done with the crawl information it holds and it can now be removed
-         * at it's leisure.
-         */
+            c.add_result(k->first, k->second, m->crawler);
+
+        for (t = m->response_times.begin(), u = m->response_times.end() ;
+             t != u ;
+             ++t)
+            c.add_response(t->first, t->second, m->crawler);
+    }
+
+    x = c.reported;
+
+    /*
+     * The links found are scheduled together; they mostly share their
+     * hosts and paths with each other.
+     */
+    s.schedule_batch(c.urls, ids, false, &c.links);
+
+    for (size_t o = 0 ; o < ids.size() ; ++o)
+        if (c.fetched[o]) // Crawled as it was found
+            c.add_result(ids[o], net::oop::EndCrawl::Changed, NULL);
+
+    outcomes.reserve(c.results.size());
+
+    for (size_t o = 0 ; o < c.results.size() ; ++o) {
+        const Result r = c.results[o].second;
+        const bool fetched = r != net::oop::EndCrawl::Failed,
+                   changed = r == net::oop::EndCrawl::Changed;
+
+        outcomes.push_back(Scheduler::Outcome(c.results[o].first,
+                                              fetched,
+                                              changed,
+                                              c.responses[o],
+                                              c.reporters[o]));
+    }
+
+    s.update_nodes(outcomes, now, workers);
+
+    /*
+     * Inform the subscriber(s), the garbage collector(s), that we are
+     * done with the crawl information it holds and it can now be removed
+     * at it's leisure.
+     */
+    for (m = first ; m ; m = next) {
+        m->add_subscriber(*m->subscriber);
         m->publish(publisher);
+        next = m->next;
+        delete m;
+        ++y;
     }
 
-    updates.clear();
+    backlog.add(-static_cast<double>(y));
+
+    links_found.add(c.found);
+    links_scheduled.add(c.urls.size());
+    results_reported.add(c.reported);
+    results_applied.add(c.results.size());
+
+    if (!c.urls.empty())
+        links_ratio.set(static_cast<double>(c.found) / c.urls.size());
+
+    if (!c.results.empty())
+        results_ratio.set(static_cast<double>(c.reported) / c.results.size());
+
+    if (bound > 0) {
+        const boost::lock_guard<boost::mutex> lock(mutex);
+        release();
+    }
 
     return x;
 }
 
+// DeferredUpdate::Coalesced
+void
+DeferredUpdate::Coalesced::add_link(const string &url, bool f)
+{
+    const url::URL::hash_t h = string_id(url);
+    const uint32_t *at = url_index.find(h);
+
+    ++found;
+
+    if (at && urls[*at] == url) {
+        ++links[*at];
+
+        if (f)
+            fetched[*at] = true;
+
+        return;
+    }
+
+    if (!at)
+        url_index.insert(h, urls.size()); // One colliding is kept unindexed
+
+    urls.push_back(url);
+    links.push_back(1);
+    fetched.push_back(f);
+}
+
+/*
+ * The best of the results reported for a page is taken; a page fetched
+ * once is updated however many other fetches failed. A result from another
+ * Crawler than the first to report the page is kept apart, unindexed, as
+ * only that of the Crawler holding the page's lease is to be applied.
+ */
+void
+DeferredUpdate::Coalesced::add_result(url::URL::hash_t page,
+                                      Result r,
+                                      const Crawler *reporter)
+{
+    uint32_t *at = page_index.find(page);
+
+    ++reported;
+
+    if (at && reporters[*at] == reporter) {
+        if (r > results[*at].second)
+            results[*at].second = r;
+
+        return;
+    }
+
+    if (!at)
+        page_index.insert(page, results.size());
+
+    results.push_back(make_pair(page, r));
+    responses.push_back(0);
+    reporters.push_back(reporter);
+}
+
+/*
+ * The latest response time reported for a page is taken; one for a page
+ * with no result from the same Crawler is dropped
+ */
+void
+DeferredUpdate::Coalesced::add_response(url::URL::hash_t page,
+                                        uint32_t ms,
+                                        const Crawler *reporter)
+{
+    const uint32_t *at = page_index.find(page);
+
+    if (at && ms > 0 && reporters[*at] == reporter)
+        responses[*at] = ms;
+}
+
 } // sched
 } // oodles
 
@@ -3,56 +3,152 @@
 
 // oodles
 #include "utility/Event.hpp"
+#include "utility/MPSCQueue.hpp"
 #include "utility/Publisher.hpp"
+#include "utility/FlatHashMap.hpp"
 #include "net/oop/Messages.hpp"
+#include "net/core/Endpoint.hpp"
+
+// Boost.thread
+#include <boost/thread/mutex.hpp>
 
 // STL
-#include <list>
+#include <set>
+#include <string>
+#include <vector>
+#include <utility>
 
 namespace oodles {
+
+namespace metrics {
+
+class Gauge; // Forward declaration for DeferredUpdate
+class Counter; // Forward declaration for DeferredUpdate
+
+} // metrics
+
 namespace sched {
 
+class Crawler; // Forward declaration for Deferable
 class Scheduler; // Forward declaration for DeferredUpdate
 
 /*
  * A Deferable is in fact more specifically a Deferable schedule update.
  * It holds a key by which the memory holding the data referenced by
- * new_urls and scheduled_urls can be freed later using the events system.
+ * new_urls, scheduled_urls and response_times can be freed later using
+ * the events system. The results are those of crawler, the Crawler that
+ * reported them (NULL if not known); see Scheduler::update_node().
  */
 struct Deferable
 {
     typedef ptrdiff_t key_t;
     typedef net::oop::EndCrawl::NewURLs NewURLs;
     typedef net::oop::EndCrawl::ScheduledURLs ScheduledURLs;
+    typedef net::oop::EndCrawl::ResponseTimes ResponseTimes;
 
     const key_t key;
     const NewURLs &new_urls;
     const ScheduledURLs &scheduled_urls;
+    const ResponseTimes &response_times;
+    const Crawler *crawler;
 };
 
 /*
  * Update is used internally and is slightly more bloated than Deferable as
  * it must inherit from Event. Deferable must be kept light-weight as it is
- * copied (though only once).
+ * copied (though only once). It is its own node of the intake queue; the
+ * subscriber is only subscribed once it is taken from the queue so that
+ * subscribing, publishing and unsubscribing all happen on one thread.
  */
 struct Update : public Deferable, public event::Event
 {
-    Update(const Deferable &d) : Deferable(d) {}
+    Update *next; // Owned by MPSCQueue
+    event::Subscriber *subscriber;
+
+    Update(const Deferable &d, event::Subscriber *s = NULL) :
+        Deferable(d),
+        next(NULL),
+        subscriber(s)
+    {}
     event::Event* clone() const { return new Update(*this); }
 };
 
+/*
+ * Updates are deferred by the network sessions, on any thread, and taken
+ * by the scheduler all together at the start of each run. Once more than
+ * the bound are waiting, reads from a session deferring another are held
+ * until a run leaves no more than half the bound waiting.
+ *
+ * The updates taken by a run are coalesced before any is applied: each URL
+ * found is scheduled once, however many crawls found it, and each page is
+ * updated once with the best of the results its Crawler reported for it
+ * (once for each, should another's lease on it have expired). The pages
+ * are updated by as many workers as given, see Scheduler::update_nodes().
+ */
 class DeferredUpdate
 {
     public:
         /* Member functions/methods */
         DeferredUpdate(Dispatcher &d);
+        ~DeferredUpdate();
         
-        uint32_t update(Scheduler &s);
-        void defer(const Deferable &d, event::Subscriber &s);
+        uint32_t update(Scheduler &s, size_t workers = 1); // The consumer
+        bool defer(const Deferable &d, event::Subscriber &s); // True if over
+        void hold(const net::Endpoint::Connection &e); // Until under the bound
+        void set_bound(size_t b) { bound = b; } // 0 is unbounded
     private:
+        /* Internal Data Structures */
+        typedef net::oop::EndCrawl::Result Result;
+
+        /*
+         * The links and results of every update taken by a run
+         */
+        struct Coalesced
+        {
+            struct hash_id
+            {
+                size_t operator() (url::URL::hash_t h) const { return h; }
+            };
+            typedef FlatHashMap<url::URL::hash_t, uint32_t, hash_id> Index;
+
+            std::vector<std::string> urls; // Each found by the crawls
+            std::vector<uint32_t> links; // No. of times each URL was found
+            std::vector<bool> fetched; // Each URL crawled as it was found
+            std::vector<std::pair<url::URL::hash_t, Result> > results;
+            std::vector<uint32_t> responses; // Of each result, 0 if unknown
+            std::vector<const Crawler*> reporters; // Of each result
+            Index url_index, page_index; // Into urls and results
+            uint32_t found, reported; // Links and results, as received
+
+            Coalesced() : found(0), reported(0) {}
+
+            void add_link(const std::string &url, bool fetched);
+            void add_result(url::URL::hash_t page,
+                            Result r,
+                            const Crawler *reporter);
+            void add_response(url::URL::hash_t page,
+                              uint32_t ms,
+                              const Crawler *reporter);
+        };
+
         /* Member variables/attributes */
-        std::list<Update> updates;
+        MPSCQueue<Update> updates;
+        size_t bound; // Of updates deferred before sessions are held
         event::Publisher publisher;
+        metrics::Gauge &backlog; // No. of updates deferred
+        metrics::Counter &holds; // Of sessions' reads
+        metrics::Counter &links_found, &links_scheduled;
+        metrics::Counter &results_reported, &results_applied;
+        metrics::Gauge &links_ratio, &results_ratio; // Of the last run
+
+        boost::mutex mutex; // Of held
+        std::set<net::Endpoint::Connection> held;
+
+        /* Member functions/methods */
+        void release(); // Whilst holding mutex
+
+        DeferredUpdate(const DeferredUpdate &d); // Do not allow...
+        DeferredUpdate& operator= (const DeferredUpdate &d); // ... copying.
 };
 
 } // sched
@@ -0,0 +1,142 @@
+// oodles
+#include "Crawler.hpp"
+#include "HashRing.hpp"
+#include "utility/hash.hpp"
+
+// STL
+#include <sstream>
+#include <algorithm>
+
+// libc
+#include <math.h> // For ceil()
+
+// STL
+using std::sort;
+using std::vector;
+using std::upper_bound;
+using std::ostringstream;
+
+namespace oodles {
+namespace sched {
+
+HashRing::HashRing(uint16_t replicas, double balance) :
+    replicas(replicas),
+    balance(balance),
+    capacity(0),
+    load(0),
+    room(0),
+    previous(0)
+{
+}
+
+/*
+ * Place c on the ring; its points are derived from its name alone so it is
+ * placed identically every time it registers.
+ */
+void
+HashRing::insert(Crawler &c)
+{
+    const uint32_t n = replicas * c.core_count();
+
+    points.reserve(points.size() + n);
+
+    for (uint32_t i = 0 ; i < n ; ++i) {
+        ostringstream s;
+        s << c.id() << '#' << i;
+
+        const std::string key(s.str());
+        points.push_back(Point(fnv32(key.data(), key.size()), &c));
+    }
+
+    sort(points.begin(), points.end());
+    members.push_back(&c);
+}
+
+/*
+ * Must be called at the start of every scheduling run to take account of
+ * the Crawlers now online and the work they already hold.
+ */
+void
+HashRing::prepare()
+{
+    previous = load;
+    capacity = load = room = 0;
+
+    for (size_t i = 0 ; i < members.size() ; ++i) {
+        const Crawler &c = *members[i];
+
+        if (c.online()) {
+            capacity += c.max_unit_size();
+            load += c.assigned();
+
+            if (!c.full())
+                room += c.max_unit_size() - c.assigned();
+        }
+    }
+}
+
+/*
+ * Returns the Crawler to be sent the next URL of host, counting the URL
+ * against its share, or NULL if no online Crawler can take any more.
+ */
+Crawler*
+HashRing::allocate(url::URL::hash_t host)
+{
+    if (room == 0)
+        return NULL;
+
+    const uint32_t position = fnv32(reinterpret_cast<const char*>(&host),
+                                    sizeof(host));
+    const vector<Point>::const_iterator
+        start = upper_bound(points.begin(), points.end(), Point(position, NULL));
+    Crawler *spare = NULL; // Overloaded but not full, should all others be
+
+    /*
+     * Walk clockwise from host, wrapping around, to the first Crawler able
+     * to take the URL without exceeding its bound.
+     */
+    for (size_t i = 0 ; i < points.size() ; ++i) {
+        const size_t j = (start - points.begin() + i) % points.size();
+        Crawler *c = points[j].crawler;
+
+        if (!c->online() || c->full())
+            continue;
+
+        if (!overloaded(*c)) {
+            ++load;
+            --room;
+            return c;
+        }
+
+        if (!spare)
+            spare = c;
+    }
+
+    /*
+     * Every Crawler with room is at its bound; overflow to the first of them
+     */
+    if (spare) {
+        ++load;
+        --room;
+    }
+
+    return spare;
+}
+
+// Private methods
+
+bool
+HashRing::overloaded(const Crawler &c) const
+{
+    /*
+     * A Crawler may hold up to ceil(balance * its share of load + 1), where
+     * its share is in proportion to the size of its work unit.
+     */
+    const double share = static_cast<double>(c.max_unit_size()) / capacity;
+    const uint32_t total = load + 1 > previous ? load + 1 : previous;
+
+    return c.assigned() >= ceil(balance * share * total);
+}
+
+} // sched
+} // oodles
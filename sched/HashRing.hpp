@@ -0,0 +1,83 @@
+#ifndef OODLES_SCHED_HASHRING_HPP
+#define OODLES_SCHED_HASHRING_HPP
+
+// oodles
+#include "url/URL.hpp"
+
+// STL
+#include <vector>
+
+// libc
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+namespace sched {
+
+class Crawler; // Forward declaration for HashRing
+
+/*
+ * Consistent hash ring mapping each host (URL::domain_id()) to a preferred
+ * Crawler. Every Crawler is placed on the ring replicas times per core, so
+ * a Crawler's share of the hosts is proportional to its no. of cores, and
+ * a Crawler joining or going offline only moves the hosts it takes on or
+ * gives up. A Crawler is never removed: one that goes offline keeps its
+ * points, passed over until it registers again and takes its hosts back.
+ *
+ * Loads are bounded (Mirrokni, Thorup & Zadimoghaddam): a Crawler is passed
+ * over once it holds more than balance times its share (by the size of its
+ * work unit) of the URLs held by every Crawler, the URL overflowing to the
+ * next Crawler along the ring. One popular host therefore cannot swamp its
+ * Crawler. As a run begins with
+ * few URLs held, the share is of no fewer URLs than were held at the end of
+ * the previous run; otherwise the first hosts of a run would claim every
+ * Crawler, whatever the ring, to meet the bounds.
+ */
+class HashRing
+{
+    public:
+        /* Member functions/methods */
+        HashRing(uint16_t replicas = 64, double balance = 1.25);
+
+        void insert(Crawler &c);
+
+        void prepare();
+        Crawler* allocate(url::URL::hash_t host);
+
+        bool full() const { return room == 0; } // Until the next prepare()
+        bool empty() const { return members.empty(); }
+        size_t size() const { return members.size(); }
+    private:
+        /* Internal Data Structures */
+        struct Point
+        {
+            uint32_t position;
+            Crawler *crawler;
+
+            Point(uint32_t p, Crawler *c) : position(p), crawler(c) {}
+            bool operator< (const Point &p) const
+            {
+                return position < p.position;
+            }
+        };
+
+        /* Member variables/attributes */
+        const uint16_t replicas; // Points on the ring per core
+        const double balance; // Permitted load relative to a fair share
+        std::vector<Point> points; // Sorted by position
+        std::vector<Crawler*> members;
+
+        /*
+         * Online Crawlers as of prepare(); the sum of their work unit sizes,
+         * the URLs they hold and the no. of URLs they may yet be given.
+         */
+        uint32_t capacity, load, room;
+        uint32_t previous; // URLs held at the end of the previous run
+
+        /* Member functions/methods */
+        bool overloaded(const Crawler &c) const;
+};
+
+} // sched
+} // oodles
+
+#endif
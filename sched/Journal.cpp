@@ -0,0 +1,331 @@
+// oodles
+#include "Journal.hpp"
+#include "Scheduler.hpp"
+#include "utility/hash.hpp"
+#include "utility/bytes.hpp"
+#include "utility/MappedFile.hpp"
+
+// STL
+#include <sstream>
+
+// libc
+#include <errno.h> // For errno
+#include <assert.h> // For assert()
+#include <fcntl.h> // For open()
+#include <unistd.h> // For write(), ftruncate() etc.
+
+// STL
+using std::string;
+using std::ostringstream;
+
+namespace {
+
+/*
+ * File layout;
+ *
+ * Header: magic, version, generation
+ * Records: type, payload length, payload, checksum (of all prior fields)
+ */
+const uint32_t MAGIC = 0x4A444F4F; // "OODJ"
+const uint32_t VERSION = 2;
+const size_t HEADER_SIZE = sizeof(uint32_t) * 3;
+
+uint32_t
+checksum(const char *record, size_t size)
+{
+    return oodles::fnv32(record, size);
+}
+
+} // anonymous
+
+namespace oodles {
+namespace sched {
+
+Journal::Journal(const string &directory) :
+    fd(-1),
+    directory(directory),
+    oldest(0),
+    current(0),
+    valid(0)
+{
+}
+
+Journal::~Journal()
+{
+    if (fd == -1)
+        return;
+
+    try {
+        sync();
+    } catch (...) {
+        // Nothing more can be done for the buffered records
+    }
+
+    ::close(fd);
+}
+
+/*
+ * Apply every intact record of the logs from generation 'from' onwards to
+ * s. Replay stops at the first torn or corrupt record; everything after it
+ * is discarded by open().
+ *
+ * Returns the no. of records replayed.
+ */
+uint32_t
+Journal::replay(Scheduler &s, uint32_t from) throw (ReadError)
+{
+    uint32_t n = 0;
+
+    oldest = current = from;
+    valid = 0;
+
+    for (uint32_t g = from ; access(path(g).c_str(), R_OK) == 0 ; ++g) {
+        current = g;
+
+        if (!replay_log(s, g, n))
+            break;
+    }
+
+    return n;
+}
+
+/*
+ * Open the current log for appending. If it was replayed we continue after
+ * its last intact record, otherwise a new log is begun.
+ */
+void
+Journal::open() throw (OpenError, WriteError)
+{
+    assert(fd == -1);
+
+    const string p(path(current));
+
+    if ((fd = ::open(p.c_str(), O_WRONLY | O_CREAT, 0644)) == -1)
+        throw OpenError("Journal::open", errno,
+                        "Failed to open %s for writing.", p.c_str());
+
+    if (!valid) {
+        write_header();
+    } else if (ftruncate(fd, valid) == -1 || lseek(fd, valid, SEEK_SET) == -1) {
+        throw WriteError("Journal::open", errno,
+                         "Failed to truncate %s to %lu bytes.",
+                         p.c_str(), static_cast<unsigned long>(valid));
+    }
+}
+
+/*
+ * Complete the current log and begin that of the next generation. A
+ * snapshot of the new generation may be written from this point on.
+ */
+void
+Journal::rotate() throw (OpenError, WriteError)
+{
+    if (fd != -1) {
+        sync();
+        ::close(fd);
+        fd = -1;
+    }
+
+    ++current;
+    valid = 0;
+    open();
+}
+
+/*
+ * Remove the logs prior to generation 'before' once a snapshot of that
+ * generation has been written; it already holds every change they logged.
+ */
+void
+Journal::discard(uint32_t before)
+{
+    for ( ; oldest < before && oldest < current ; ++oldest)
+        unlink(path(oldest).c_str());
+}
+
+void
+Journal::sync() throw (WriteError)
+{
+    if (fd == -1 || buffer.empty())
+        return;
+
+    const char *p = buffer.data();
+    size_t n = buffer.size();
+
+    while (n > 0) {
+        const ssize_t w = ::write(fd, p, n);
+
+        if (w == -1) {
+            if (errno == EINTR)
+                continue;
+
+            throw WriteError("Journal::sync", errno,
+                             "Failed to write %lu bytes to %s.",
+                             static_cast<unsigned long>(n),
+                             path(current).c_str());
+        }
+
+        p += w;
+        n -= w;
+    }
+
+    buffer.clear();
+
+    if (fdatasync(fd) == -1)
+        throw WriteError("Journal::sync", errno,
+                         "Failed to sync %s.", path(current).c_str());
+}
+
+void
+Journal::log_schedule(const string &url, bool from_seed)
+{
+    put_bytes(record, static_cast<uint8_t>(from_seed));
+    put_string(record, url);
+    append(Schedule);
+}
+
+void
+Journal::log_links(const string &url, uint32_t links)
+{
+    put_bytes(record, links);
+    put_string(record, url);
+    append(Links);
+}
+
+void
+Journal::log_update(url::URL::hash_t id, time_t time, bool changed)
+{
+    put_bytes(record, id);
+    put_bytes(record, static_cast<int64_t>(time));
+    put_bytes(record, static_cast<uint8_t>(changed));
+    append(Update);
+}
+
+void
+Journal::log_assign(url::URL::hash_t id, const string &crawler)
+{
+    put_bytes(record, id);
+    put_string(record, crawler);
+    append(Assign);
+}
+
+/*
+ * Frame the payload built-up in record and append it to the buffer
+ */
+void
+Journal::append(Record type)
+{
+    const size_t start = buffer.size();
+
+    put_bytes(buffer, static_cast<uint8_t>(type));
+    put_bytes(buffer, static_cast<uint32_t>(record.size()));
+    buffer.append(record);
+    put_bytes(buffer, checksum(buffer.data() + start, buffer.size() - start));
+
+    record.clear();
+}
+
+string
+Journal::path(uint32_t generation) const
+{
+    ostringstream s;
+    s << directory << "/journal." << generation;
+    return s.str();
+}
+
+/*
+ * Returns true if the log was read to its end without fault.
+ */
+bool
+Journal::replay_log(Scheduler &s, uint32_t generation, uint32_t &n)
+throw (ReadError)
+{
+    static const size_t overhead = sizeof(uint8_t) + sizeof(uint32_t) * 2;
+    const string p(path(generation));
+    const MappedFile file(p);
+    ByteReader r(file.data(), file.size());
+
+    valid = 0;
+
+    if (r.remaining() < HEADER_SIZE ||
+        r.get<uint32_t>() != MAGIC ||
+        r.get<uint32_t>() != VERSION ||
+        r.get<uint32_t>() != generation)
+        return false; // Torn header or a foreign file, begin the log afresh
+
+    valid = r.offset();
+
+    while (r.remaining() >= overhead) {
+        const char *start = file.data() + r.offset();
+        const uint8_t type = r.get<uint8_t>();
+        const uint32_t length = r.get<uint32_t>();
+
+        if (r.remaining() < length + sizeof(uint32_t))
+            return false; // Torn write
+
+        ByteReader payload(r.take(length), length);
+
+        if (r.get<uint32_t>() != checksum(start, overhead - sizeof(uint32_t) +
+                                                 length))
+            return false; // Corrupt record
+
+        switch (type) {
+            case Schedule:
+                if (payload.get<uint8_t>())
+                    s.schedule_from_seed(payload.get_string());
+                else
+                    s.schedule_from_crawl(payload.get_string());
+                break;
+            case Links: {
+                const uint32_t links = payload.get<uint32_t>();
+                s.schedule_from_crawl(payload.get_string(), links);
+                break;
+            }
+            case Update: {
+                const url::URL::hash_t id = payload.get<url::URL::hash_t>();
+                const time_t time = payload.get<int64_t>();
+                s.update_node(id, time, payload.get<uint8_t>());
+                break;
+            }
+            case Assign:
+                /*
+                 * No crawler survives a restart so pages that were assigned
+                 * at the time simply return to the frontier.
+                 */
+                break;
+            default:
+                throw ReadError("Journal::replay_log", 0,
+                                "Unknown record type %u at offset %lu of %s.",
+                                type, static_cast<unsigned long>(valid),
+                                p.c_str());
+        }
+
+        valid = r.offset();
+        ++n;
+    }
+
+    return r.empty();
+}
+
+void
+Journal::write_header() throw (WriteError)
+{
+    string header;
+
+    put_bytes(header, MAGIC);
+    put_bytes(header, VERSION);
+    put_bytes(header, current);
+
+    if (ftruncate(fd, 0) == -1 ||
+        lseek(fd, 0, SEEK_SET) == -1 ||
+        ::write(fd, header.data(), header.size()) !=
+            static_cast<ssize_t>(header.size()) ||
+        fdatasync(fd) == -1)
+        throw WriteError("Journal::write_header", errno,
+                         "Failed to begin a new log in %s.",
+                         path(current).c_str());
+
+    valid = header.size();
+}
+
+} // sched
+} // oodles
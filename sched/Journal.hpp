@@ -0,0 +1,82 @@
+#ifndef OODLES_SCHED_JOURNAL_HPP
+#define OODLES_SCHED_JOURNAL_HPP
+
+// oodles
+#include "url/URL.hpp"
+#include "common/Exceptions.hpp"
+
+// STL
+#include <string>
+
+// libc
+#include <time.h> // For time_t
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+namespace sched {
+
+class Scheduler; // Forward declaration for Journal
+
+/*
+ * Write-ahead log of every change made to the Scheduler since the last
+ * Snapshot. Records are buffered in memory and only reach the disk (and are
+ * fdatasync()'ed) on sync(); a crash loses at most the records since the
+ * previous sync. Each record is checksummed so a torn write at the tail of
+ * the log is detected and discarded on replay.
+ *
+ * The log is split by generation into <directory>/journal.<generation>. A
+ * snapshot of generation g holds every change logged before journal.g was
+ * begun, so on restart journal.g onwards is replayed over snapshot g and
+ * older logs are only discarded once a newer snapshot is safely written.
+ */
+class Journal
+{
+    public:
+        /* Dependent typedefs */
+        enum Record {
+            Schedule = 1, // A URL was seen (from a seed or a crawl)
+            Update, // A page was crawled
+            Assign, // A page was assigned to a crawler
+            Links // A URL was seen by several crawls at once
+        };
+
+        /* Member functions/methods */
+        Journal(const std::string &directory);
+        ~Journal();
+
+        uint32_t generation() const { return current; }
+        uint32_t replay(Scheduler &s, uint32_t from) throw (ReadError);
+
+        void open() throw (OpenError, WriteError);
+        void rotate() throw (OpenError, WriteError);
+        void discard(uint32_t before);
+        void sync() throw (WriteError);
+
+        void log_schedule(const std::string &url, bool from_seed);
+        void log_links(const std::string &url, uint32_t links);
+        void log_update(url::URL::hash_t id, time_t time, bool changed);
+        void log_assign(url::URL::hash_t id, const std::string &crawler);
+    private:
+        /* Member variables/attributes */
+        int fd;
+        const std::string directory;
+        std::string buffer, record;
+        uint32_t oldest, current; // Generations of the logs on disk
+        size_t valid; // Length of the current log replayed successfully
+
+        /* Member functions/methods */
+        std::string path(uint32_t generation) const;
+        bool replay_log(Scheduler &s, uint32_t generation, uint32_t &n)
+        throw (ReadError);
+
+        void append(Record type);
+        void write_header() throw (WriteError);
+
+        Journal(const Journal &j); // Do not allow...
+        Journal& operator= (const Journal &j); // ... copying.
+};
+
+} // sched
+} // oodles
+
+#endif
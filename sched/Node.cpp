@@ -1,26 +1,45 @@
 // oodles
 #include "Node.hpp"
+#include "Crawler.hpp"
+#include "utility/Arena.hpp"
+
+// STL
+#include <vector>
+#include <algorithm>
 
 // libc
 #include <math.h> // For fabs()
+#include <assert.h> // For assert()
 
 // STL
+using std::vector;
 using std::ostream;
+using std::reverse;
 
 namespace {
 
 /*
  * Implementation of normalisation formula presented here:
  * http://people.revoledu.com/kardi/tutorial/Similarity/Normalization.htm
+ *
+ * The transform is increasing so the heavier a branch, the more it is
+ * favoured.
  */
 inline
-double
+float
 normalise(double weight, double minimum)
 {
     if (minimum < 0)
         weight += fabs(minimum); // Ensure all data remains positive 
     
-    return 0.5f * (1 - (weight / sqrt(pow(weight, 2) + 1000)));
+    return 0.5f * (1 + (weight / sqrt(pow(weight, 2) + 1000)));
+}
+
+oodles::Arena&
+arena()
+{
+    static oodles::Arena a(sizeof(oodles::sched::Node));
+    return a;
 }
 
 } // anonymous
@@ -33,14 +52,38 @@ namespace sched {
 Node::Node(const value_type &v) :
     oodles::Node<value_type>(v),
     page(NULL),
+    host(NULL),
     visited(0),
-    reviser(NULL)
+    dirty(false),
+    weighting(0),
+    revision(0),
+    ranking(NULL)
 {
 }
 
 Node::~Node()
 {
     delete page; // If set, ownership is implicitly transferred
+    delete ranking;
+}
+
+void*
+Node::operator new (size_t bytes)
+{
+    assert(bytes == sizeof(Node));
+    return arena().allocate();
+}
+
+void
+Node::operator delete (void *block)
+{
+    arena().deallocate(block);
+}
+
+size_t
+Node::allocated()
+{
+    return arena().size();
 }
 
 void
@@ -61,70 +104,184 @@ Node::print(ostream &s, const io::PrinterBase &p) const
     }
 }
 
-double
+url::URL
+Node::url() const
+{
+    assert(page);
+
+    const url::URL u(url(page->origin, page->domain_levels, page->flags));
+    assert(u.page_id() == page->id);
+
+    return u;
+}
+
+/*
+ * The URL is rebuilt from the labels alone, without parsing it
+ */
+url::URL
+Node::url(const Label &origin, uint8_t domain_levels, uint8_t flags) const
+{
+    const size_t labels = path_idx + 1, levels = domain_levels;
+    vector<Label> path(labels);
+    url::Attributes a;
+    const Node *n = this;
+
+    for (size_t i = labels ; i > 0 ; --i) {
+        path[i - 1] = n->value;
+        n = static_cast<const Node*>(n->parent);
+    }
+
+    a.ip = flags & PageData::Ip;
+    a.domain.assign(path.begin(), path.begin() + levels);
+
+    if (!a.ip)
+        reverse(a.domain.begin(), a.domain.end()); // As it was written
+
+    if (flags & PageData::Page) {
+        a.page = path.back();
+        path.pop_back();
+    }
+
+    a.path.assign(path.begin() + levels, path.end());
+    PageData::split_origin(origin, a);
+
+    return url::URL(a);
+}
+
+/*
+ * The domain of the page ends domain_levels labels down the path to it
+ */
+Host*
+Node::page_host() const
+{
+    assert(page);
+
+    if (page->domain_levels == 0)
+        return NULL; // No domain to be polite to
+
+    const path_index_t domain = page->domain_levels - 1;
+    const Node *h = this;
+
+    while (h->path_idx > domain)
+        h = static_cast<const Node*>(h->parent);
+
+    return h->host;
+}
+
+void
+Node::assign_crawler(Crawler &c)
+{
+    assert(page && !page->crawler);
+
+    c.add_url(*this);
+    page->crawler = &c;
+}
+
+void
+Node::unassign_crawler()
+{
+    assert(page && page->crawler);
+
+    page->crawler->remove_url(*this);
+    page->crawler = NULL;
+}
+
+float
 Node::weight() const
 {
     return normalise(measure.current / (size() + 1), measure.minimum);
 }
 
 /*
- * TODO: Formula untested. Must write crawl simulation to test
- * scoring/weighting math. May be a simpler (+/- 1) solution?
+ * Weighs in the change in the measures of any children weighed since this
+ * node was last, as given to revise(), so a node with many children changed
+ * is weighed just once. Returns the change in this node's own measure, to
+ * be given to its parent in turn.
  */
-void
-Node::calculate_weight()
+double
+Node::calculate_weight(time_t now)
 {
+    const double revised = revision;
+
+    revision = 0;
+
     if (!parent)
-        return;
+        return 0;
 
-    Node &p = *parent;
+    const double old_weight = measure.current;
 
     /*
-     * The #links a page has (to it) is a measure of it's popularity so
-     * we use it as a multiplier to suggest to the scheduler it may be
-     * more important to keep 'fresh' than others. However, to ensure this
-     * doesn't get favoured to often we use the #crawls against it as a
-     * divisor to bring it's weight back down.
+     * A page is weighed by its expected staleness, the chance a crawl now
+     * would find it changed, so that each crawl gains as much freshness as
+     * it can. The #links a page has (to it) is a measure of it's popularity
+     * so we use it as a multiplier to suggest to the scheduler it may be
+     * more important to keep 'fresh' than others.
+     *
+     * A page may also head a path (as "/a" and "/a/b" do), so its measure
+     * holds theirs too. That is summed afresh rather than revised, as the
+     * page's own part of the old measure is not kept to take back out.
      */
     if (page) {
-        double t = page->epoch, c = page->crawl_count + 1, l = page->links + 1;
-        double new_weight = (t / c) * l, old_weight = measure.current;
+        double s = page->staleness(now), l = page->links + 1;
+        measure.current = s * l;
+
+        for (size_t i = 0 ; i < size() ; ++i) {
+            const Node &c = static_cast<const Node&>(child(i));
+            measure.current += c.measure.current;
+        }
+    } else
+        measure.current += revised;
 
-        measure.current = new_weight + (leaf() ? 0 : old_weight);
-        measure.previous = old_weight;
+    settle();
 
-        if (measure.previous == measure.current)
-            p.reviser = NULL;
-        else
-            p.reviser = &measure;
-    } else {
-        p.reviser = reviser;
+    return measure.current - old_weight;
+}
 
-        if (reviser) {
-            measure.current += reviser->current;
-            measure.current -= reviser->previous;
-        }
+/*
+ * Re-key this node within the ranking held by its parent. Must be called
+ * whenever the cached weighting or the candidacy of this node changes.
+ */
+void
+Node::update_rank()
+{
+    if (!parent)
+        return;
+
+    Node &p = *parent;
+
+    if (!p.ranking) {
+        if (!candidate())
+            return; // Nothing is ranked yet, so nothing to withdraw
+
+        p.ranking = new TournamentTree<float>;
     }
 
-    /*
-     * We must keep a record of the minimum measure as we go up the tree as
-     * we need to pass this to normalise() in order to maintain a positive
-     * set of numbers to transform (to a value between 0 and 1).
-     */
-    if (measure.current < measure.minimum)
-        measure.minimum = measure.current;
+    if (candidate())
+        p.ranking->update(child_idx, weighting);
+    else
+        p.ranking->disable(child_idx);
+}
 
-    if (measure.minimum < p.measure.minimum)
-        p.measure.minimum = measure.minimum;
+void
+Node::set_state(int state)
+{
+    const bool red = visit_state == Red;
+
+    visit_state = state;
+
+    if (red != (state == Red))
+        update_rank(); // Only a change to or from Red affects candidacy
 }
 
 Node*
-Node::weigh_against(Node *&n)
+Node::best_child() const
 {
-    if (n && n->weight() > weight())
-        return n;
+    const int32_t i = ranking ? ranking->top() : -1;
+
+    if (i < 0)
+        return NULL;
 
-    return this;
+    return const_cast<Node*>(&static_cast<const Node&>(child(i)));
 }
 
 // Private methods
@@ -134,6 +291,26 @@ Node::visit()
 {
 }
 
+void
+Node::settle()
+{
+    Node &p = *parent;
+
+    /*
+     * We must keep a record of the minimum measure as we go up the tree as
+     * we need to pass this to normalise() in order to maintain a positive
+     * set of numbers to transform (to a value between 0 and 1).
+     */
+    if (measure.current < measure.minimum)
+        measure.minimum = measure.current;
+
+    if (measure.minimum < p.measure.minimum)
+        p.measure.minimum = measure.minimum;
+
+    weighting = weight(); // Normalise once here rather than on every descent
+    update_rank();
+}
+
 inline
 Node*
 Node::new_node(const value_type &v) const
@@ -3,49 +3,113 @@
 
 // oodles
 #include "PageData.hpp"
+#include "Politeness.hpp"
 #include "utility/Node.hpp"
+#include "utility/TournamentTree.hpp"
+#include "utility/StringInterner.hpp"
 
 namespace oodles {
 namespace sched {
 
 class PageData; // Forward declration for Node
+class Crawler; // Forward declration for Node
 
-class Node : public oodles::Node<std::string>
+class Node : public oodles::Node<Label>
 {
     public:
         /* Dependent typedefs */
-        typedef std::string value_type;
+        typedef Label value_type;
         typedef oodles::Node<value_type> Base;
 
         /* Member functions/methods */
         Node(const value_type &v);
         ~Node();
 
+        /*
+         * Every Node of the scheduler is allocated from a single Arena
+         */
+        static void* operator new (size_t bytes);
+        static void operator delete (void *block);
+        static size_t allocated(); // No. of Nodes in existence
+
         /* Override print() method from NodeBase */
         void print(std::ostream &s, const io::PrinterBase &p) const;
         
-        double weight() const;
-        void calculate_weight();
-        Node* weigh_against(Node *&n);
+        float weight() const;
+        double calculate_weight(time_t now);
+        void revise(double delta) { revision += delta; } // Of a child
+
+        void update_rank();
+        void set_state(int state);
+        Node* best_child() const;
 
         bool assigned() const { return page && page->crawler; }
-        bool eligible() const { return page ? page->crawler == NULL : false; }
+
+        bool eligible() const
+        {
+            if (!page || page->crawler)
+                return false;
+
+            const Host *h = page_host();
+
+            return !h || h->ready; // Polite to crawl?
+        }
+
+        /*
+         * Of the page at this leaf. Its URL is rebuilt from the path to the
+         * leaf and the politeness state of its host is that of the node at
+         * which its domain ends.
+         */
+        url::URL url() const;
+        url::URL url(const Label &origin, // As though its page held these
+                     uint8_t domain_levels,
+                     uint8_t flags) const;
+        Host* page_host() const;
+        void assign_crawler(Crawler &c);
+        void unassign_crawler();
+
+        /*
+         * A candidate may be chosen by a traversal; it is neither exhausted
+         * (Red), a page already assigned to a crawler nor the domain of a
+         * host that must not be sent any more URLs just yet.
+         */
+        bool candidate() const
+        {
+            return visit_state != Red && !assigned() && (!host || host->ready);
+        }
 
         /* Member variables/attributes */
         PageData *page; // Only used with leaf nodes, NULL otherwise
-        size_t visited; // Keep an index/tally of visited children
+        Host *host; // Only used where a domain ends, NULL otherwise
+        uint32_t visited; // Keep an index/tally of visited children
+        bool dirty; // Awaiting calculate_weight(), see Scheduler::weigh()
     private:
         /* Member functions/methods */
         void visit();
+        void settle();
         Node* new_node(const value_type &v) const;
 
+        /*
+         * The current measure is the sum of many revisions so it is kept
+         * in full; the minimum is only used to normalise a weight.
+         */
         struct Measure {
-            double minimum, previous, current;
-            Measure() : minimum(0), previous(0), current(0) {}
+            double current;
+            float minimum;
+            Measure() : current(0), minimum(0) {}
         };
 
         /* Member variables/attributes */
-        Measure measure, *reviser;
+        Measure measure;
+        float weighting; // Cached weight() as of the last calculate_weight()
+        double revision; // Summed change of the children not yet weighed in
+
+        /*
+         * Candidate children indexed by child_idx and keyed on their cached
+         * weighting. Kept current by update_rank() on each of the children.
+         * Created once the first child is ranked; most nodes are leaves.
+         */
+        TournamentTree<float> *ranking;
 };
 
 } // sched
@@ -1,40 +1,175 @@
 // oodles
-#include "Crawler.hpp"
 #include "PageData.hpp"
 
+// STL
+#include <limits>
+
+// libc
+#include <math.h> // For ceil(), exp(), log()
+#include <string.h> // For strlen()
+#include <assert.h> // For assert()
+
 // STL
 using std::string;
+using std::numeric_limits;
+
+namespace {
+
+/*
+ * The rise in the staleness of a crawled page between its weighings
+ */
+const double STEP = 0.1;
+
+} // anonymous
 
 namespace oodles {
 namespace sched {
 
-PageData::PageData(const string &url) :
-    url(url),
+// ChangeRate
+ChangeRate::ChangeRate() : checks(0), changes(0), observed(0)
+{
+}
+
+void
+ChangeRate::record(uint32_t interval, bool changed)
+{
+    if (checks == Window) { // Forget the older half of the history
+        checks /= 2;
+        changes /= 2;
+        observed /= 2;
+    }
+
+    ++checks;
+    observed += interval;
+
+    if (changed)
+        ++changes;
+}
+
+/*
+ * The estimator r = -log((n - X + 0.5) / (n + 0.5)) of the no. of changes
+ * per crawl interval, for X changes found by n crawls, divided by the mean
+ * interval. Unlike X / n it remains finite should every crawl find a change.
+ */
+double
+ChangeRate::rate() const
+{
+    if (checks == 0)
+        return 1.0 / Prior;
+
+    const double n = checks, x = changes;
+    const double interval = observed > checks ? observed / n : 1.0;
+
+    return -log((n - x + 0.5) / (n + 0.5)) / interval;
+}
+
+double
+ChangeRate::probability(uint32_t interval) const
+{
+    return 1.0 - exp(-rate() * interval);
+}
+
+// PageData
+
+PageData::PageData(const url::URL &url, time_t epoch) :
+    id(url.page_id()),
     crawler(NULL),
-    referrer(NULL),
+    origin(origin_of(url)),
+    dispatched(0),
     last_crawl(0),
-    epoch(time(NULL)),
+    epoch(epoch ? epoch : time(NULL)),
     links(0),
-    crawl_count(0)
+    crawl_count(0),
+    domain_levels(url.domain_levels()),
+    flags((url.components().ip ? Ip : 0) |
+          (url.components().page.empty() ? 0 : Page))
 {
+    assert(url.domain_levels() <= numeric_limits<uint8_t>::max());
 }
 
+/*
+ * Note a crawl at time, which either found the page changed since the
+ * previous crawl, or not.
+ */
 void
-PageData::assign_crawler(Crawler *c)
+PageData::crawled(time_t time, bool changed)
 {
-    assert(!crawler);
-    
-    c->add_url(url);
-    crawler = c;
+    if (crawl_count > 0 && time >= last_crawl)
+        change.record(time - last_crawl, changed);
+
+    last_crawl = time;
+
+    if (crawl_count < numeric_limits<uint16_t>::max())
+        crawl_count++;
+}
+
+/*
+ * The chance a crawl at now would find the page changed; certain until
+ * crawled, otherwise the chance it has changed since, by its change rate.
+ */
+double
+PageData::staleness(time_t now) const
+{
+    if (crawl_count == 0)
+        return 1.0;
+
+    return change.probability(now > last_crawl ? now - last_crawl : 0);
+}
+
+/*
+ * Seconds from now until the staleness of the page has risen by another
+ * STEP, or 0 if it never will: it is not yet crawled, is never found to
+ * change or is within a STEP of certain.
+ */
+uint32_t
+PageData::refresh(time_t now) const
+{
+    const double s = staleness(now), r = change.rate();
+
+    if (crawl_count == 0 || r <= 0 || s >= 1.0 - STEP)
+        return 0;
+
+    const double due = -log(1.0 - s - STEP) / r, // Since the last crawl
+                 since = now > last_crawl ? now - last_crawl : 0;
+
+    if (due - since >= numeric_limits<uint32_t>::max())
+        return numeric_limits<uint32_t>::max();
+
+    return due - since < 1 ? 1 : static_cast<uint32_t>(ceil(due - since));
+}
+
+PageData::msec_t
+PageData::dispatch_time(msec_t now) const
+{
+    return now - static_cast<uint32_t>(static_cast<uint32_t>(now) - dispatched);
+}
+
+Label
+PageData::origin_of(const url::URL &url)
+{
+    string s;
+
+    s.append(url.scheme().data(), url.scheme().size()) += '\0';
+    s.append(url.username().data(), url.username().size()) += '\0';
+    s.append(url.password().data(), url.password().size()) += '\0';
+    s.append(url.port().data(), url.port().size()) += '\0';
+
+    return Label(s);
 }
 
 void
-PageData::unassign_crawler()
+PageData::split_origin(const Label &origin, url::Attributes &url)
 {
-    assert(crawler);
-    
-    crawler->remove_url(url);
-    crawler = NULL;
+    Label *const parts[] = {&url.scheme, &url.username, &url.password,
+                            &url.port};
+    const char *s = origin.data();
+
+    for (size_t i = 0 ; i < 4 ; ++i) {
+        const size_t n = strlen(s);
+
+        *parts[i] = n ? Label(s, n) : Label();
+        s += n + 1;
+    }
 }
 
 } // oodles
@@ -4,29 +4,87 @@
 // oodles
 #include "url/URL.hpp"
 
-#include <stdint.h> // For uint32_t
+#include <time.h> // For time_t
+#include <stdint.h> // For uint32_t, uint64_t
 
 namespace oodles {
 namespace sched {
 
-class Node; // Forward declaration for PageData
 class Crawler; // Forward declaration for PageData
 
+/*
+ * Estimates the rate at which a page changes, assuming its changes arrive
+ * as a Poisson process, from whether or not each crawl found it changed
+ * since the one before (Cho & Garcia-Molina, "Estimating Frequency of
+ * Change"). The history is halved once it reaches Window crawls so the
+ * estimate follows a page whose behaviour changes over time.
+ */
+struct ChangeRate
+{
+    enum {
+        Window = 64, // Crawls
+        Prior = 86400 // Seconds between changes assumed without a history
+    };
+
+    uint16_t checks, // No. of crawls compared with their predecessor
+             changes; // No. of those that found the page changed
+    uint32_t observed; // Seconds spanned by those crawls
+
+    ChangeRate();
+    void record(uint32_t interval, bool changed);
+
+    double rate() const; // Changes per second
+    double probability(uint32_t interval) const; // Of >= 1 change in interval
+};
+
+/*
+ * The record kept at the leaf of every page. Its URL is not held; the tree
+ * path to the leaf holds the labels of the domain, path and page and the
+ * rest (scheme, username, password and port) are interned together as its
+ * origin, so the URL is rebuilt only when it is sent (see Node::url()).
+ * Times are held in 32 bits: seconds since 1970, and the ms clock of the
+ * Scheduler modulo 2^32 for the dispatch, which is only ever compared with
+ * the present (see dispatch_time()).
+ */
 struct PageData
 {
-    url::URL url; // Our URL object/structure.
+    /* Dependent typedefs */
+    typedef uint64_t msec_t;
+
+    enum {
+        Ip = 1 << 0, // Domain labels held in order, not reversed
+        Page = 1 << 1 // Leaf label is the page, not the last of the path
+    };
+
+    /* Member variables/attributes */
+    const url::URL::hash_t id; // URL::page_id()
     Crawler *crawler; // Our crawler, if any.
-    const Node *referrer; // Link to a Node that holds a hyperlink to us.
+    const Label origin; // See origin_of()
+
+    uint32_t dispatched; // Time (in ms, modulo 2^32) it was assigned
+    uint32_t last_crawl; // Time of last crawl or 0
+    const uint32_t epoch; // Creation time of PageData
+
+    uint32_t links; // No. of times this page is 'seen'
+    uint16_t crawl_count; // No. of times this page has been crawled (capped)
+    const uint8_t domain_levels; // No. of labels of the domain in the path
+    const uint8_t flags;
+    ChangeRate change; // History of changes found by crawls
 
-    time_t last_crawl; // Time of last crawl or 0
-    const time_t epoch; // Creation time of PageData
+    /* Member functions/methods */
+    PageData(const url::URL &url, time_t epoch = 0); // 0 is now
 
-    uint32_t links, // No. of times this page is 'seen'
-             crawl_count; // No. of times this page has been crawled
+    void crawled(time_t time, bool changed);
+    double staleness(time_t now) const;
+    uint32_t refresh(time_t now) const; // Seconds until it is weighed again
+    msec_t dispatch_time(msec_t now) const; // Within 2^32 ms before now
 
-    PageData(const std::string &url);
-    void assign_crawler(Crawler *c);
-    void unassign_crawler();
+    /*
+     * The scheme, username, password and port of a URL, interned as one
+     * label (each NUL terminated) and split back into url.
+     */
+    static Label origin_of(const url::URL &url);
+    static void split_origin(const Label &origin, url::Attributes &url);
 };
 
 } // sched
@@ -0,0 +1,148 @@
+// oodles
+#include "Politeness.hpp"
+
+// STL
+using std::vector;
+
+namespace oodles {
+namespace sched {
+
+// Host
+Host::Host(url::URL::hash_t id, Node *n, uint32_t delay) :
+    id(id),
+    node(n),
+    last_fetch(0),
+    delay(delay),
+    response(0),
+    in_flight(0),
+    waiting(false),
+    ready(true)
+{
+}
+
+// Politeness
+Politeness::Politeness(uint32_t minimum,
+                       uint32_t maximum,
+                       uint16_t connections) :
+    minimum(minimum),
+    maximum(maximum),
+    connections(connections)
+{
+}
+
+Politeness::~Politeness()
+{
+    std::tr1::unordered_map<url::URL::hash_t, Host*, hash_id>::iterator
+        i = hosts.begin(), j = hosts.end();
+
+    for ( ; i != j ; ++i)
+        delete i->second;
+}
+
+/*
+ * Returns the host identified by id, creating it (ending at n) if need be
+ */
+Host*
+Politeness::host(url::URL::hash_t id, Node &n)
+{
+    Host *&h = hosts[id];
+
+    if (!h)
+        h = new Host(id, &n, minimum);
+
+    return h;
+}
+
+void
+Politeness::set_delay(uint32_t minimum, uint32_t maximum)
+{
+    this->minimum = minimum;
+    this->maximum = maximum;
+}
+
+/*
+ * A URL of h has been sent to a Crawler; hold the host back until its
+ * delay has expired.
+ */
+void
+Politeness::dispatched(Host &h, msec_t now)
+{
+    ++h.in_flight;
+    h.last_fetch = now;
+    h.ready = false;
+
+    if (!h.waiting && h.delay > 0) {
+        h.waiting = true;
+        timers.schedule(&h, now + h.delay);
+    }
+}
+
+/*
+ * A URL of h has been crawled; its Crawler observed the host take response
+ * ms to respond.
+ */
+void
+Politeness::completed(Host &h, uint32_t response)
+{
+    adapt_delay(h, response);
+    recalled(h);
+}
+
+/*
+ * A URL of h was taken back from its Crawler, or it was crawled without
+ * its response time being observed.
+ */
+void
+Politeness::recalled(Host &h)
+{
+    if (h.in_flight > 0)
+        --h.in_flight;
+
+    if (!h.ready && !h.waiting && h.in_flight < connections)
+        h.ready = true;
+}
+
+/*
+ * Expire the delay of every host due by now. Those hosts which are also
+ * below their limit of URLs in flight are ready again and appended to ready.
+ */
+void
+Politeness::release(msec_t now, vector<Host*> &ready)
+{
+    vector<Host*> expired;
+
+    timers.advance(now, expired);
+
+    for (size_t i = 0 ; i < expired.size() ; ++i) {
+        Host &h = *expired[i];
+
+        h.waiting = false;
+
+        if (!h.ready && h.in_flight < connections) {
+            h.ready = true;
+            ready.push_back(&h);
+        }
+    }
+}
+
+/*
+ * A host that is slow to respond is visited less often; the delay is kept
+ * at twice the moving average of its response times (within the bounds).
+ */
+void
+Politeness::adapt_delay(Host &h, msec_t sample) const
+{
+    const msec_t average = h.response ? (3 * h.response + sample) / 4 : sample;
+    msec_t delay = 2 * average;
+
+    if (delay < minimum)
+        delay = minimum;
+    else if (delay > maximum)
+        delay = maximum;
+
+    h.response = average;
+    h.delay = delay;
+}
+
+} // sched
+} // oodles
@@ -0,0 +1,89 @@
+#ifndef OODLES_SCHED_POLITENESS_HPP
+#define OODLES_SCHED_POLITENESS_HPP
+
+// oodles
+#include "url/URL.hpp"
+#include "utility/TimingWheel.hpp"
+
+// STL
+#include <vector>
+#include <tr1/unordered_map>
+
+// libc
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+namespace sched {
+
+class Node; // Forward declaration for Host
+
+/*
+ * Politeness state of a single host (domain). A host is ready when it may
+ * be sent another URL; it is held back from then on until both its delay
+ * has expired and it has fewer than the permitted no. of URLs in flight.
+ */
+struct Host
+{
+    /* Dependent typedefs */
+    typedef uint64_t msec_t;
+
+    /* Member variables/attributes */
+    const url::URL::hash_t id; // URL::domain_id() of the host
+    Node *node; // Node at which the host's domain ends within the URL tree
+
+    msec_t last_fetch; // Time the last URL was sent to a Crawler
+    uint32_t delay; // Minimum time between URLs, in ms
+    uint32_t response; // Moving average of observed response times, in ms
+    uint16_t in_flight; // No. of URLs sent but not yet crawled
+    bool waiting; // Held back until delay has expired
+    bool ready;
+
+    /* Member functions/methods */
+    Host(url::URL::hash_t id, Node *n, uint32_t delay);
+};
+
+class Politeness
+{
+    public:
+        /* Dependent typedefs */
+        typedef Host::msec_t msec_t;
+
+        /* Member functions/methods */
+        Politeness(uint32_t minimum = 1000,
+                   uint32_t maximum = 60000,
+                   uint16_t connections = 1);
+        ~Politeness();
+
+        Host* host(url::URL::hash_t id, Node &n);
+        size_t size() const { return hosts.size(); }
+
+        void set_delay(uint32_t minimum, uint32_t maximum);
+        void set_connections(uint16_t c) { connections = c; }
+
+        void dispatched(Host &h, msec_t now);
+        void completed(Host &h, uint32_t response); // In ms
+        void recalled(Host &h);
+        void release(msec_t now, std::vector<Host*> &ready);
+    private:
+        /* Member variables/attributes */
+        uint32_t minimum, maximum; // Bounds of the delay of every host
+        uint16_t connections; // No. of URLs permitted in flight per host
+        TimingWheel<Host*> timers;
+
+        struct hash_id
+        {
+            size_t operator() (url::URL::hash_t h) const { return h; }
+        };
+        std::tr1::unordered_map<url::URL::hash_t, Host*, hash_id> hosts;
+
+        /* Member functions/methods */
+        void adapt_delay(Host &h, msec_t sample) const;
+
+        Politeness(const Politeness &p); // Do not allow...
+        Politeness& operator= (const Politeness &p); // ... copying.
+};
+
+} // sched
+} // oodles
+
+#endif
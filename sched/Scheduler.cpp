@@ -1,13 +1,33 @@
 // oodles
+#include "Journal.hpp"
 #include "PageData.hpp"
 #include "Scheduler.hpp"
 #include "DeferredUpdate.hpp"
+#include "utility/Dispatcher.hpp"
 #include "utility/BreadCrumbTrail.hpp"
 
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+
+// STL
+#include <set>
+#include <algorithm>
+
 // STL
+using std::set;
+using std::pair;
 using std::string;
 using std::vector;
 using std::ostream;
+using std::sort;
+using std::stable_sort;
+using std::lexicographical_compare;
+
+// Boost
+using boost::bind;
+using boost::mutex;
+using boost::lock_guard;
 
 static
 inline
@@ -17,14 +37,183 @@ parent_of(oodles::sched::Node::Base &node)
     return static_cast<oodles::sched::Node*>(node.parent);
 }
 
+namespace {
+
+using oodles::sched::Node;
+
+struct HeavierNode
+{
+    bool operator() (const Node *lhs, const Node *rhs) const
+    {
+        return lhs->weight() > rhs->weight();
+    }
+};
+
+/*
+ * Collect the children of n that may head a partition, heaviest first
+ */
+void
+partitionable_children(const Node &n, vector<Node*> &children)
+{
+    for (size_t i = 0 ; i < n.size() ; ++i) {
+        const Node &c = static_cast<const Node&>(n.child(i));
+
+        if (c.candidate() && !c.page && !c.leaf())
+            children.push_back(const_cast<Node*>(&c));
+    }
+
+    stable_sort(children.begin(), children.end(), HeavierNode());
+}
+
+/*
+ * A partition is only split when every child may head a partition of its
+ * own; pages directly below it would otherwise belong to no partition.
+ */
+bool
+divisible(const Node &n)
+{
+    for (size_t i = 0 ; i < n.size() ; ++i) {
+        const Node &c = static_cast<const Node&>(n.child(i));
+
+        if (c.page || c.leaf())
+            return false;
+    }
+
+    if (n.host)
+        return false; // A host is only sent one URL at a time
+
+    return n.size() > 1;
+}
+
+typedef pair<const oodles::url::URL*, size_t> Parsed; // And index in batch
+
+struct SameParent
+{
+    bool operator() (const Node *lhs, const Node *rhs) const
+    {
+        return lhs->parent < rhs->parent;
+    }
+};
+
+/*
+ * No fewer nodes of a level than this are weighed by more than one worker
+ */
+const size_t MinParallelLevel = 4096;
+
+/*
+ * No fewer pages than this are updated by more than one worker
+ */
+const size_t MinParallelUpdate = 1024;
+
+/*
+ * Orders parsed URLs by their path through the tree, so URLs sharing a
+ * prefix of their path are adjacent. Labels are compared by their text, not
+ * their id, so a batch is inserted in the same order whatever was interned
+ * before it.
+ */
+struct TreeOrder
+{
+    bool operator() (const Parsed &lhs, const Parsed &rhs) const
+    {
+        const oodles::url::URL &l = *lhs.first, &r = *rhs.first;
+
+        return lexicographical_compare(l.begin_tree(), l.end_tree(),
+                                       r.begin_tree(), r.end_tree(),
+                                       oodles::Label::less_text);
+    }
+};
+
+/*
+ * Advance i past the labels (from the root) its tree path shares with that
+ * of u, returning how many there were.
+ */
+size_t
+skip_shared(oodles::url::URL::tree_iterator &i,
+            const oodles::url::URL::tree_iterator &end,
+            const oodles::url::URL &u)
+{
+    oodles::url::URL::tree_iterator j = u.begin_tree(), k = u.end_tree();
+    size_t shared = 0;
+
+    for ( ; i != end && j != k && *i == *j ; ++i, ++j)
+        ++shared;
+
+    return shared;
+}
+
+} // anonymous
+
 namespace oodles {
 namespace sched {
 
+/*
+ * State shared by the workers of run_parallel(). Partitions are handed out
+ * best first and every page claimed from one is deducted from the demand.
+ */
+struct Scheduler::Partitioning
+{
+    vector<Node*> tops; // Root node of each partition
+    vector<vector<Node*> > batches; // Pages claimed from each partition
+    size_t next; // Next partition to be filled
+    long demand; // No. of pages the online Crawlers can still take
+
+    Partitioning(long d) : next(0), demand(d) {}
+};
+
+/*
+ * State shared by the workers of weigh(). The nodes of a level are grouped
+ * by their parent and each group is weighed by one worker alone, as every
+ * node of it revises and re-ranks itself within their parent.
+ */
+struct Scheduler::Weighing
+{
+    const vector<Node*> *level;
+    vector<size_t> groups; // Index of the first node of each group
+    size_t next; // Next group to be weighed
+    time_t now; // As every page is weighed
+
+    Weighing(time_t now) : level(NULL), next(0), now(now) {}
+};
+
+/*
+ * State shared by the workers of update_nodes(). The pages are grouped by
+ * their domain, the node below their TLD, and each group is updated by one
+ * worker alone; no two domains share a node below the TLD.
+ */
+struct Scheduler::Updating
+{
+    struct Page
+    {
+        Node *top, *node; // The domain, NULL if the page is no deeper
+        const Outcome *outcome;
+
+        Page(Node *t, Node *n, const Outcome &o) :
+            top(t),
+            node(n),
+            outcome(&o)
+        {}
+
+        bool operator< (const Page &rhs) const { return top < rhs.top; }
+    };
+
+    vector<Page> pages;
+    vector<size_t> groups; // Index of the first page of each group
+    size_t next; // Next group to be updated
+    time_t time;
+
+    Updating(time_t t) : next(0), time(t) {}
+};
+
 Scheduler::Scheduler(Dispatcher *d) :
     leaves(0),
+    clock(&Clock::system()),
+    affinity(false),
+    lease(600000), // 10 minutes
+    journal(NULL),
+    dispatcher(d),
     trail(NULL),
     update(NULL),
-    tree(new Node("ROOT"))
+    tree(new Node(Label("ROOT", 4)))
 {
     if (d)
         update = new DeferredUpdate(*d);
@@ -35,9 +224,41 @@ Scheduler::~Scheduler()
     delete update;
 }
 
+/*
+ * Crawlers register from the sessions' threads whilst a run may be under
+ * way, so each is only queued; the next run admits it to the crawlers and
+ * the ring, see admit_crawlers().
+ */
+void
+Scheduler::register_crawler(Crawler &c)
+{
+    c.set_sizing(sizing);
+
+    const lock_guard<mutex> lock(registration);
+    registered.push_back(&c);
+}
+
+void
+Scheduler::admit_crawlers()
+{
+    vector<Crawler*> admitted;
+
+    {
+        const lock_guard<mutex> lock(registration);
+        admitted.swap(registered);
+    }
+
+    for (size_t i = 0 ; i < admitted.size() ; ++i) {
+        crawlers.push(admitted[i]);
+        ring.insert(*admitted[i]);
+    }
+}
+
 uint32_t
 Scheduler::run(BreadCrumbTrail *t)
 {
+    admit_crawlers();
+
     if (crawlers.empty())
         return 0; // Short-cut! Don't bother continuing if 0 crawlers.
     
@@ -51,10 +272,19 @@ Scheduler::run(BreadCrumbTrail *t)
     vector<Crawler*> deferred_crawls;
     uint32_t i = 0, j = crawlers.size(), k = 0, l = 0;
 
+    reclaim(); // Work that will not be returned
+    refresh(); // Pages grown staler
+    weigh();
+    release_hosts(); // Hosts whose delay has since expired
     trail = t; // Set the BCT, if any
     deferred_crawls.reserve(j); // Avoid potential (re)allocations
 
-    for (Crawler *c = crawlers.top() ; i < j ; c = crawlers.top(), ++i) {
+    if (affinity)
+        k = fill_by_host(deferred_crawls); // Crawlers are chosen by the ring
+
+    for (Crawler *c = crawlers.top() ; !affinity && i < j ;
+         c = crawlers.top(), ++i)
+    {
         if (c->online()) { // Do not assign anything to offline Crawlers
             l = fill_crawler(*c, n); // Assign as much work (fill work unit)
 
@@ -76,32 +306,329 @@ Scheduler::run(BreadCrumbTrail *t)
     return k;
 }
 
+/*
+ * As run() but pages are first claimed from separate subtrees of the URL
+ * tree (partitions) by up to workers threads of the Dispatcher at once. The
+ * claims are then merged into work units in order of the partitions' rank.
+ */
 uint32_t
-Scheduler::update_schedule()
+Scheduler::run_parallel(size_t workers)
+{
+    if (!dispatcher || workers < 2)
+        return run(); // Nothing to be gained
+
+    long demand = 0;
+    vector<Crawler*> ranked, online;
+
+    admit_crawlers();
+    reclaim();
+    refresh();
+    weigh(workers);
+    release_hosts();
+    ranked.reserve(crawlers.size());
+
+    for ( ; !crawlers.empty() ; crawlers.pop()) {
+        Crawler *c = crawlers.top();
+
+        if (c->online() && !c->full()) {
+            demand += c->max_unit_size() - c->assigned();
+            online.push_back(c);
+        }
+
+        ranked.push_back(c);
+    }
+
+    uint32_t assigned = 0;
+
+    if (demand > 0) {
+        const Politeness::msec_t now = clock->milliseconds();
+        Partitioning p(demand);
+
+        partition_tree(workers << 2, p.tops); // Over-partition to balance
+        p.batches.resize(p.tops.size());
+
+        dispatcher->fork_join(bind(&Scheduler::fill_partitions,
+                                   this,
+                                   boost::ref(p)), workers - 1);
+
+        /*
+         * No more than the demand is claimed so all claims can be assigned
+         */
+        size_t k = 0;
+        set<Crawler*> given; // Crawlers given work by the ring
+
+        if (affinity)
+            ring.prepare();
+
+        for (size_t i = 0 ; i < p.batches.size() ; ++i) {
+            const vector<Node*> &batch = p.batches[i];
+
+            for (size_t j = 0 ; j < batch.size() ; ++j, ++assigned) {
+                Node *n = batch[j];
+                Crawler *c = NULL;
+
+                if (affinity) {
+                    c = ring.allocate(domain_of(*n));
+                    given.insert(c);
+                } else {
+                    while (online[k]->full())
+                        ++k;
+
+                    c = online[k];
+                }
+
+                n->assign_crawler(*c);
+                lease_page(*n, now);
+
+                if (journal)
+                    journal->log_assign(n->page->id, c->id());
+
+                if (Host *h = n->page_host())
+                    hosts.dispatched(*h, now);
+
+                n->update_rank(); // No longer a candidate for selection
+            }
+        }
+
+        if (affinity) {
+            for (set<Crawler*>::iterator i = given.begin() ;
+                 i != given.end() ; ++i)
+                (*i)->begin_crawl();
+        } else if (assigned) { // Crawlers up to and including k given work
+            for (size_t i = 0 ; i <= k ; ++i)
+                online[i]->begin_crawl();
+        }
+    }
+
+    for (size_t i = 0 ; i < ranked.size() ; ++i)
+        crawlers.push(ranked[i]);
+
+    return assigned;
+}
+
+/*
+ * Weigh every node marked dirty since the last weigh(), level by level from
+ * the deepest, so each node is weighed once however many of its children
+ * changed; every parent of a node weighed is weighed on the level above.
+ * Run before any scheduling run, the nodes of a level are weighed by up to
+ * workers threads of the Dispatcher at once.
+ */
+void
+Scheduler::weigh(size_t workers)
+{
+    if (!dispatcher)
+        workers = 1;
+
+    const time_t now = clock->now();
+
+    for (size_t depth = dirty.size() ; depth > 0 ; --depth) {
+        vector<Node*> &level = dirty[depth - 1];
+        Weighing w(now);
+
+        if (level.empty())
+            continue;
+
+        sort(level.begin(), level.end(), SameParent());
+        w.level = &level;
+
+        for (size_t i = 0 ; i < level.size() ; ++i)
+            if (i == 0 || level[i]->parent != level[i - 1]->parent)
+                w.groups.push_back(i);
+
+        w.groups.push_back(level.size());
+
+        if (workers > 1 && level.size() >= MinParallelLevel)
+            dispatcher->fork_join(bind(&Scheduler::weigh_level,
+                                       this,
+                                       boost::ref(w)), workers - 1);
+        else
+            weigh_level(w);
+
+        for (size_t i = 0 ; i < w.groups.size() - 1 ; ++i)
+            mark_dirty(*parent_of(*level[w.groups[i]]));
+
+        level.clear();
+    }
+}
+
+uint32_t
+Scheduler::update_schedule(size_t workers)
 {
     assert(update);
-    return update->update(*this);
+    return update->update(*this, workers);
+}
+
+/*
+ * Whether the result for page p reported by reporter is to be applied: the
+ * page's lease, if any, must be held by reporter. That of a Crawler whose
+ * lease expired, and was given to another, is ignored; the page is that
+ * Crawler's to report. One reported by an unknown Crawler is applied.
+ */
+inline
+bool
+Scheduler::leaseholder(const PageData &p, const Crawler *reporter)
+{
+    return !reporter || !p.crawler || p.crawler == reporter;
 }
 
+/*
+ * The page id was crawled at time, by reporter, and found to have changed
+ * since it was last crawled, or not. Its host took response ms to respond,
+ * if known.
+ */
 void
-Scheduler::update_node(url::URL::hash_t id, time_t time)
+Scheduler::update_node(url::URL::hash_t id,
+                       time_t time,
+                       bool changed,
+                       uint32_t response,
+                       const Crawler *reporter)
 {
-    Node *n = page_table[id];
+    Node **i = page_table.find(id);
+
+    if (!i)
+        return; // Unknown page (e.g. a crawl that was assigned before restart)
+
+    Node *n = *i;
     PageData *p = n->page;
 
-    p->unassign_crawler();
-    p->last_crawl = time; // FIXME: Needs to be from the Crawler
-    p->crawl_count++;
-    
-    weigh_tree_branch(*n);
+    if (!leaseholder(*p, reporter))
+        return;
+
+    if (journal)
+        journal->log_update(id, time, changed);
+
+    if (p->crawler) {
+        const Politeness::msec_t now = clock->milliseconds();
+        p->crawler->completed(p->dispatch_time(now), now);
+    }
+
+    release_page(*n, response);
+    p->crawled(time, changed); // FIXME: Time needs to be from the Crawler
+    schedule_refresh(*n, time);
+
+    mark_dirty(*n);
     clean_tree_branch(*n);
 }
 
+/*
+ * The page id could not be crawled; it returns to the frontier as it was
+ */
 void
+Scheduler::abandon_node(url::URL::hash_t id, const Crawler *reporter)
+{
+    Node **i = page_table.find(id);
+
+    if (!i || !(*i)->page->crawler || !leaseholder(*(*i)->page, reporter))
+        return;
+
+    return_page(**i);
+}
+
+/*
+ * As update_node() or abandon_node() for each of outcomes, a page at most
+ * once for each Crawler reporting it (see DeferredUpdate). What the domains
+ * share is changed first, serially and in order: the journal, the Crawlers
+ * the pages are returned from and the politeness of their hosts. Each
+ * domain's pages are then noted as crawled and their branches cleaned,
+ * below the domain, by the workers. The ancestors the domains share, the
+ * TLDs and the root, are cleaned last, serially.
+ */
+void
+Scheduler::update_nodes(const vector<Outcome> &outcomes,
+                        time_t time,
+                        size_t workers)
+{
+    if (!dispatcher || workers < 2 || outcomes.size() < MinParallelUpdate) {
+        for (size_t i = 0 ; i < outcomes.size() ; ++i) {
+            const Outcome &o = outcomes[i];
+
+            if (o.fetched)
+                update_node(o.id, time, o.changed, o.response, o.crawler);
+            else
+                abandon_node(o.id, o.crawler);
+        }
+
+        return;
+    }
+
+    const Politeness::msec_t now = clock->milliseconds();
+    Updating u(time);
+
+    u.pages.reserve(outcomes.size());
+
+    for (size_t i = 0 ; i < outcomes.size() ; ++i) {
+        const Outcome &o = outcomes[i];
+        Node **j = page_table.find(o.id);
+
+        if (!j || (!o.fetched && !(*j)->page->crawler) ||
+            !leaseholder(*(*j)->page, o.crawler))
+            continue;
+
+        Node *n = *j, *top = n;
+        PageData *p = n->page;
+
+        if (o.fetched && journal)
+            journal->log_update(o.id, time, o.changed);
+
+        if (o.fetched && p->crawler)
+            p->crawler->completed(p->dispatch_time(now), now);
+
+        release_page(*n, o.fetched ? o.response : 0);
+
+        while (top->path_idx > 1)
+            top = parent_of(*top);
+
+        u.pages.push_back(Updating::Page(top != n ? top : NULL, n, o));
+    }
+
+    stable_sort(u.pages.begin(), u.pages.end());
+
+    for (size_t i = 0 ; i < u.pages.size() ; ++i) {
+        const Node *top = u.pages[i].top; // Those with none are first
+
+        if (top && (i == 0 || top != u.pages[i - 1].top))
+            u.groups.push_back(i);
+    }
+
+    u.groups.push_back(u.pages.size());
+
+    dispatcher->fork_join(bind(&Scheduler::update_domains,
+                               this,
+                               boost::ref(u)), workers - 1);
+
+    for (size_t i = 0 ; i < u.pages.size() ; ++i) {
+        const Updating::Page &p = u.pages[i];
+
+        if (!p.top && p.outcome->fetched)
+            p.node->page->crawled(time, p.outcome->changed);
+
+        if (p.outcome->fetched)
+            schedule_refresh(*p.node, time);
+
+        mark_dirty(*p.node);
+        clean_tree_branch(p.top ? *p.top : *p.node);
+    }
+}
+
+bool
 Scheduler::defer_update(const Deferable &d, event::Subscriber &s)
 {
     assert(update);
-    update->defer(d, s);
+    return update->defer(d, s);
+}
+
+void
+Scheduler::hold_until_updated(const boost::shared_ptr<net::Endpoint> &e)
+{
+    assert(update);
+    update->hold(e);
+}
+
+void
+Scheduler::set_update_bound(size_t b)
+{
+    assert(update);
+    update->set_bound(b);
 }
 
 url::URL::hash_t
@@ -110,16 +637,22 @@ Scheduler::schedule_from_seed(const string &url)
     return schedule(url, true);
 }
 
+/*
+ * The URL was found by the no. of crawls given as links
+ */
 url::URL::hash_t
-Scheduler::schedule_from_crawl(const string &url)
+Scheduler::schedule_from_crawl(const string &url, uint32_t links)
 {
-    return schedule(url, false);
+    return schedule(url, false, links);
 }
 
+/*
+ * When top is given the traversal is confined to the subtree below it
+ */
 Node*
-Scheduler::traverse_branch(Node &n)
+Scheduler::traverse_branch(Node &n, const Node *top)
 {
-    Node *p = select_best_child(n);
+    Node *p = select_best_child(n, &n == top);
 
     if (trail)
         trail->drop_crumb(n.path_idx, n.child_idx); // Leave a breadcrumb trail
@@ -133,84 +666,392 @@ Scheduler::traverse_branch(Node &n)
         if (n.eligible()) // Return when we've found something crawlable
             return &n;
 
+        if (&n == top)
+            return NULL; // We've exhausted the partition
+
         p = parent_of(n); // Begin to backtrack
 
         if (!p)
             return NULL; // We've returned to the root node
     }
 
-    return traverse_branch(*p); // Continue delving deeper
+    return traverse_branch(*p, top); // Continue delving deeper
 }
 
+/*
+ * Mark n, and then its ancestors, as Red for as long as each has had all
+ * of its children visited. Above top the nodes are shared between workers.
+ */
 void
-Scheduler::clean_tree_branch(Node &n) const
+Scheduler::close_branch(Node *n, const Node *top) const
 {
+    while (n && n->visited >= n->size()) {
+        if (n == top) {
+            const lock_guard<mutex> lock(boundary);
+            close_branch(n);
+            return;
+        }
+
+        exhaust_node(*n);
+        n = parent_of(*n);
+    }
+}
+
+void
+Scheduler::clean_tree_branch(Node &n, const Node *top) const
+{
+    if (&n == top)
+        return; // Left to the caller
+
     if (!n.parent) {
-        n.visit_state = Node::Amber;
+        n.set_state(Node::Amber);
         return;
     }
 
     Node *parent = parent_of(n);
 
     if (n.leaf())
-        n.visit_state = Node::Green;
+        n.set_state(Node::Green);
     else
-        n.visit_state = Node::Amber;
+        n.set_state(Node::Amber);
 
-    --parent->visited; // Update the parents index of visited children
+    if (parent->visited > 0)
+        --parent->visited; // Update the parents index of visited children
 
-    clean_tree_branch(*parent);
+    clean_tree_branch(*parent, top);
 }
 
+/*
+ * n is weighed, followed by any of its ancestors whose measure changes as a
+ * result, by the next weigh().
+ */
 void
-Scheduler::weigh_tree_branch(Node &n) const
+Scheduler::mark_dirty(Node &n)
 {
-    for (Node *p = &n ; p ; p = parent_of(*p)) 
-        p->calculate_weight(); // Cannot be run in parallel
+    if (n.dirty || !n.parent)
+        return; // The root is not weighed
+
+    const size_t depth = n.path_idx + 1;
+
+    if (depth > dirty.size())
+        dirty.resize(depth);
+
+    dirty[depth - 1].push_back(&n);
+    n.dirty = true;
 }
 
-Node*
-Scheduler::select_best_child(Node &parent) const
+/*
+ * The staleness of a page grows from nothing as each crawl of it recedes,
+ * so the page at n, crawled by now, is weighed again each time it has risen
+ * by a step. Only the pages due are weighed, not every page crawled.
+ */
+void
+Scheduler::schedule_refresh(Node &n, time_t now)
 {
-    Node *n = NULL;
+    const uint32_t after = n.page->refresh(now);
+
+    if (after)
+        refreshes.schedule(Refresh(&n, n.page->last_crawl), now + after);
+}
+
+void
+Scheduler::refresh()
+{
+    const time_t now = clock->now();
+    vector<Refresh> due;
+
+    refreshes.advance(now, due);
+
+    for (size_t i = 0 ; i < due.size() ; ++i) {
+        Node &n = *due[i].node;
+
+        if (n.page->last_crawl != due[i].crawl)
+            continue; // Crawled since, and so refreshed from then
+
+        mark_dirty(n);
+        schedule_refresh(n, now);
+    }
+}
+
+/*
+ * Worker of update_nodes(). Each page of a group is noted as crawled and
+ * its branch cleaned up to, but not including, the domain.
+ */
+void
+Scheduler::update_domains(Updating &u) const
+{
+    for (size_t i ; (i = __sync_fetch_and_add(&u.next, 1)) <
+                    u.groups.size() - 1 ; )
+    {
+        for (size_t j = u.groups[i] ; j < u.groups[i + 1] ; ++j) {
+            const Updating::Page &p = u.pages[j];
+
+            if (p.outcome->fetched)
+                p.node->page->crawled(u.time, p.outcome->changed);
+
+            clean_tree_branch(*p.node, p.top);
+        }
+    }
+}
+
+/*
+ * Worker of weigh(). Each node of a group passes the change in its measure
+ * to their parent, which is marked dirty afterwards by weigh().
+ */
+void
+Scheduler::weigh_level(Weighing &w) const
+{
+    const vector<Node*> &level = *w.level;
+
+    for (size_t i ; (i = __sync_fetch_and_add(&w.next, 1)) <
+                    w.groups.size() - 1 ; )
+    {
+        for (size_t j = w.groups[i] ; j < w.groups[i + 1] ; ++j) {
+            Node &n = *level[j];
 
+            n.dirty = false;
+            parent_of(n)->revise(n.calculate_weight(w.now));
+        }
+    }
+}
+
+/*
+ * If shared is set the parent heads a partition, its own parent (which any
+ * exhaustion updates) is shared.
+ */
+Node*
+Scheduler::select_best_child(Node &parent, bool shared) const
+{
     /*
-     * Linear search over the breadth of this parent branch
+     * The parent keeps its candidate children ranked by weight so there is
+     * no need to scan (and normalise) the breadth of this branch.
      */
-    for (size_t i = 0 ; i < parent.size() ; ++i) {
-        Node &c = parent.child(i);
+    Node *n = parent.best_child();
 
-        if (c.visit_state == Node::Red) // Skip-over any visited branch
-            continue;
+    if (n) {
+        n->set_state(Node::Amber); // Node visited but not all children
+    } else if (shared) { // No child remains a candidate
+        const lock_guard<mutex> lock(boundary);
+        exhaust_node(parent);
+    } else {
+        exhaust_node(parent);
+    }
 
-        c.visit_state = Node::Amber; // Node visited but not all children
+    return n;
+}
 
-        if (c.page && !c.eligible()) // Ignore ineligible yet crawlable nodes
+void
+Scheduler::exhaust_node(Node &n) const
+{
+    Node *p = parent_of(n);
+
+    n.set_state(Node::Red);
+
+    if (p)
+        ++p->visited; // Update the parent
+}
+
+/*
+ * Re-admit n to the ranking of its parent and reopen any of its ancestors
+ * which were exhausted in its absence.
+ */
+void
+Scheduler::reopen_branch(Node &n) const
+{
+    n.update_rank();
+
+    for (Node *p = &n ; p ; p = parent_of(*p)) {
+        if (p->visit_state != Node::Red)
             continue;
 
-        n = c.weigh_against(n); // Returns the chosen one ;)
+        p->set_state(Node::Amber);
+
+        if (p->parent && parent_of(*p)->visited > 0)
+            --parent_of(*p)->visited;
+    }
+}
+
+/*
+ * Associate the page at n with the politeness state of its host. The host
+ * is kept at the node where the domain of the page ends.
+ */
+void
+Scheduler::attach_host(Node &n, url::URL::hash_t domain_id)
+{
+    const size_t levels = n.page->domain_levels;
+
+    if (levels == 0)
+        return; // No domain to be polite to
+
+    const Node::path_index_t domain = levels - 1;
+    Node *h = &n;
+
+    while (h->path_idx > domain)
+        h = parent_of(*h);
+
+    if (!h->host)
+        h->host = hosts.host(domain_id, *h);
+}
+
+/*
+ * URL::domain_id() of the page at n; that of no domain at all is 0
+ */
+url::URL::hash_t
+Scheduler::domain_of(const Node &n) const
+{
+    const Host *h = n.page_host();
+    return h ? h->id : 0;
+}
+
+/*
+ * Hosts whose delay has expired may be selected once more
+ */
+void
+Scheduler::release_hosts()
+{
+    vector<Host*> ready;
+
+    hosts.release(clock->milliseconds(), ready);
+
+    for (size_t i = 0 ; i < ready.size() ; ++i)
+        reopen_branch(*ready[i]->node);
+}
+
+/*
+ * Assign the page at n to c. Returns the node the traversal should resume
+ * from; once a host has been sent its URL it is withdrawn from the ranking
+ * and the traversal resumes from above it.
+ */
+Node*
+Scheduler::assign_page(Node &n, Crawler &c, Politeness::msec_t now)
+{
+    n.assign_crawler(c);
+    lease_page(n, now);
+
+    if (journal)
+        journal->log_assign(n.page->id, c.id());
+
+    n.update_rank(); // No longer a candidate for selection
+
+    Host *h = n.page_host();
+
+    if (!h)
+        return &n;
+
+    hosts.dispatched(*h, now);
+    h->node->update_rank();
+
+    return h->node;
+}
+
+/*
+ * The assignment of the page at n expires after the lease, if any
+ */
+void
+Scheduler::lease_page(Node &n, Politeness::msec_t now)
+{
+    n.page->dispatched = now; // Modulo 2^32, see PageData::dispatch_time()
+
+    if (lease)
+        leases.schedule(&n, now + lease);
+}
+
+/*
+ * The time the page took to fetch, response, is that reported by its
+ * Crawler; one not crawled (it failed, or was reclaimed) or not measured
+ * says nothing of how quickly its host responds.
+ */
+void
+Scheduler::release_page(Node &n, uint32_t response)
+{
+    if (!n.page->crawler)
+        return;
+
+    n.unassign_crawler();
+
+    /*
+     * The host may be ready again, weigh() re-ranks it
+     */
+    Host *h = n.page_host();
+
+    if (h && response > 0)
+        hosts.completed(*h, response);
+    else if (h)
+        hosts.recalled(*h);
+}
+
+/*
+ * The page at n returns to the frontier as it was before its assignment
+ */
+void
+Scheduler::return_page(Node &n)
+{
+    release_page(n);
+    mark_dirty(n);
+    clean_tree_branch(n);
+}
+
+/*
+ * Return to the frontier every page whose lease has expired and the whole
+ * work unit of every Crawler that is lost (see Crawler::lost()). Each of
+ * their Crawlers is held back, once however many of its pages were taken.
+ */
+void
+Scheduler::reclaim()
+{
+    const Politeness::msec_t now = clock->milliseconds();
+    vector<Node*> expired;
+    vector<Crawler*> ranked;
+    set<Crawler*> failed;
+
+    leases.advance(now, expired);
+
+    for (size_t i = 0 ; i < expired.size() ; ++i) {
+        Node &n = *expired[i];
+        Crawler *c = n.page->crawler;
+
+        if (!c || n.page->dispatch_time(now) + lease > now)
+            continue; // Returned already (and perhaps assigned once more)
+
+        return_page(n);
+        failed.insert(c);
     }
 
-    if (!n) { // No child was a candidate although all were considered
-        parent.visit_state = Node::Red;
+    ranked.reserve(crawlers.size());
+
+    for ( ; !crawlers.empty() ; crawlers.pop()) {
+        Crawler *c = crawlers.top();
+
+        if (c->lost()) {
+            const vector<Node*> unit(c->unit());
 
-        if ((n = parent_of(parent)))
-            ++n->visited; // Update the grandparent
+            for (size_t i = 0 ; i < unit.size() ; ++i)
+                return_page(*unit[i]);
 
-        n = NULL;
+            failed.insert(c);
+        }
+
+        ranked.push_back(c);
     }
 
-    return n;
+    for (set<Crawler*>::iterator i = failed.begin() ; i != failed.end() ; ++i)
+        (*i)->hold(now);
+
+    for (size_t i = 0 ; i < ranked.size() ; ++i) {
+        ranked[i]->resume(now);
+        crawlers.push(ranked[i]);
+    }
 }
 
 Crawler::unit_t
 Scheduler::fill_crawler(Crawler &c, Node *&n)
 {
-    static const Node &const_root = static_cast<const Node&>(tree.root());
-    static Node *root = const_cast<Node*>(&const_root);
+    const Node &const_root = static_cast<const Node&>(tree.root());
+    Node *root = const_cast<Node*>(&const_root);
 
     Node *p = NULL;
     Crawler::unit_t assigned = 0;
+    const Politeness::msec_t now = clock->milliseconds();
     bool exhausted = root->visit_state == Node::Red;
 
     for (n = !n ? root : n ; !exhausted ; n = !n ? root : parent_of(*n)) {
@@ -219,8 +1060,7 @@ Scheduler::fill_crawler(Crawler &c, Node *&n)
             n = traverse_branch(*n); // Locate best candidate for crawling
 
             if (n && n->eligible()) {
-                page_table[n->page->url.page_id()] = n; // Cache it
-                n->page->assign_crawler(&c);
+                n = assign_page(*n, c, now);
                 ++assigned;
             } else if (!n) {
                 exhausted = true; // traverse_branch() exhausted the tree
@@ -234,44 +1074,267 @@ Scheduler::fill_crawler(Crawler &c, Node *&n)
      * If our last node was a leaf node that was assigned to
      * a crawler, mark it's ancestors as Red where necessary.
      */
-    if (n && n->leaf() && (n->page && n->page->crawler)) {
-        for (p = parent_of(*n) ; p ; ) {
-            if (p->visited < p->size()) 
-                break; // Terminate the loop if any unvisited children
+    if (n && n->leaf() && (n->page && n->page->crawler))
+        close_branch(parent_of(*n));
 
-            p->visit_state = Node::Red;
+    return assigned;
+}
 
-            if ((p = parent_of(*p)))
-                ++p->visited; // Update the grandparent
-        }
+/*
+ * Assign pages in order of rank, each to the Crawler its host maps to on
+ * the ring. Every Crawler given work is appended to filled.
+ */
+uint32_t
+Scheduler::fill_by_host(vector<Crawler*> &filled)
+{
+    const Node &const_root = static_cast<const Node&>(tree.root());
+    Node *root = const_cast<Node*>(&const_root), *n = root, *last = NULL;
+
+    const Politeness::msec_t now = clock->milliseconds();
+    set<Crawler*> given;
+    uint32_t assigned = 0;
+
+    ring.prepare();
+
+    if (root->visit_state == Node::Red)
+        return 0;
+
+    while (!ring.full() && (n = traverse_branch(*n))) {
+        Crawler *c = ring.allocate(domain_of(*n));
+
+        assert(c); // The ring had room
+        last = n;
+        given.insert(c);
+
+        n = parent_of(*assign_page(*n, *c, now));
+        ++assigned;
     }
 
+    if (last)
+        close_branch(parent_of(*last));
+
+    filled.insert(filled.end(), given.begin(), given.end());
+
     return assigned;
 }
 
+/*
+ * Worker of run_parallel(). Claims pages from each partition it is handed
+ * until either the demand is met or there are no partitions left.
+ */
+void
+Scheduler::fill_partitions(Partitioning &p)
+{
+    bool satisfied = false;
+
+    for (size_t i ; !satisfied &&
+                    (i = __sync_fetch_and_add(&p.next, 1)) < p.tops.size() ; )
+    {
+        Node &top = *p.tops[i], *n = &top;
+        vector<Node*> &batch = p.batches[i];
+
+        top.set_state(Node::Amber); // Partition visited
+
+        /*
+         * Claim a share of the demand prior to every traversal
+         */
+        while (!(satisfied = __sync_sub_and_fetch(&p.demand, 1) < 0)) {
+            if (!(n = traverse_branch(*n, &top)))
+                break; // Partition exhausted
+
+            batch.push_back(n);
+
+            /*
+             * Hold back the host until the merge dispatches its URL (a host
+             * is never shared by partitions; see divisible()).
+             */
+            if (Host *h = n->page_host()) {
+                h->ready = false;
+
+                if (h->node == &top) {
+                    const lock_guard<mutex> lock(boundary);
+                    top.update_rank();
+                } else {
+                    h->node->update_rank();
+                }
+
+                n = h->node;
+            }
+
+            if (n == &top)
+                break; // Nothing more to be claimed from this partition
+
+            n = parent_of(*n);
+        }
+
+        __sync_add_and_fetch(&p.demand, 1); // Return the unused claim
+
+        if (!batch.empty())
+            close_branch(parent_of(*batch.back()), &top);
+    }
+}
+
+/*
+ * Split the tree into at least n partitions where possible, starting from
+ * the children of the root and repeatedly dividing the broadest partition
+ * into its own children. The partitions are left in order of rank.
+ */
+void
+Scheduler::partition_tree(size_t n, vector<Node*> &tops) const
+{
+    const Node &root = static_cast<const Node&>(tree.root());
+    vector<bool> whole; // Partitions that cannot be divided further
+
+    partitionable_children(root, tops);
+    whole.resize(tops.size(), false);
+
+    while (tops.size() < n) {
+        size_t w = tops.size();
+
+        for (size_t i = 0 ; i < tops.size() ; ++i) {
+            if (!whole[i] && (w == tops.size() ||
+                              tops[i]->size() > tops[w]->size()))
+                w = i;
+        }
+
+        if (w == tops.size())
+            break; // No partition may be divided
+
+        if (!divisible(*tops[w])) {
+            whole[w] = true;
+            continue;
+        }
+
+        vector<Node*> children;
+        partitionable_children(*tops[w], children);
+
+        tops.erase(tops.begin() + w);
+        tops.insert(tops.begin() + w, children.begin(), children.end());
+        whole.erase(whole.begin() + w);
+        whole.insert(whole.begin() + w, children.size(), false);
+    }
+}
+
 url::URL::hash_t
-Scheduler::schedule(const string &url, bool from_seed)
+Scheduler::schedule(const string &url, bool from_seed, uint32_t links)
 {
-    PageData *page = new PageData(url);
-    Node *node = static_cast<Node*> (tree.insert(page->url.begin_tree(),
-                                                 page->url.end_tree()));
+    if (journal && links > 1)
+        journal->log_links(url, links); // Written ahead of the change
+    else if (journal)
+        journal->log_schedule(url, from_seed);
+
+    Node *const *known = page_table.find(url::URL::page_id(url));
+    Node *node = known ? *known : NULL;
+    PageData *page = NULL;
 
-    if (!node->page) { // Newly inserted, unique URL
-        ++leaves;
-        node->page = page; // Ownership of page is implicitly transferred here
+    if (node) { // Found without interning the URL or walking the tree
+        page = node->page;
     } else {
-        delete page;
+        const url::URL u(url);
+
+        node = static_cast<Node*> (tree.insert(u.begin_tree(), u.end_tree()));
+
+        if (!node->page) { // Newly inserted, unique URL
+            ++leaves;
+            node->page = new PageData(u, clock->now());
+            page_table.insert(node->page->id, node);
+            attach_host(*node, u.domain_id());
+        }
+
         page = node->page;
     }
 
     assert(page);
 
     if (!from_seed)
-        ++page->links; // If we're from a seed it doesn't count as a link!
+        page->links += links; // A seed doesn't count as a link!
     
-    weigh_tree_branch(*node); // Calculates branch schedule index (weight)
+    mark_dirty(*node); // Its schedule index (weight) is calculated by weigh()
+
+    return page->id;
+}
+
+/*
+ * As schedule() for every one of urls, appending their page ids to ids in
+ * the same order. The URLs not already known are sorted by their path
+ * through the tree and each is inserted below the node at which it parts
+ * from the one before. Every node touched is then weighed just once.
+ *
+ * If links is given each URL was found by as many crawls as its entry.
+ */
+void
+Scheduler::schedule_batch(const vector<string> &urls,
+                          vector<url::URL::hash_t> &ids,
+                          bool from_seed,
+                          const vector<uint32_t> *links)
+{
+    const time_t now = clock->now();
+    vector<Node*> nodes(urls.size(), static_cast<Node*>(NULL));
+    vector<url::URL> tokenised; // Reserved in full, so never moved
+    vector<Parsed> parsed;
+
+    tokenised.reserve(urls.size());
+
+    for (size_t i = 0 ; i < urls.size() ; ++i) {
+        if (journal && links && (*links)[i] > 1)
+            journal->log_links(urls[i], (*links)[i]);
+        else if (journal)
+            journal->log_schedule(urls[i], from_seed);
+
+        Node *const *n = page_table.find(url::URL::page_id(urls[i]));
+
+        if (n) {
+            nodes[i] = *n;
+        } else {
+            tokenised.push_back(url::URL(urls[i]));
+            parsed.push_back(Parsed(&tokenised.back(), i));
+        }
+    }
+
+    stable_sort(parsed.begin(), parsed.end(), TreeOrder());
+
+    for (size_t i = 0 ; i < parsed.size() ; ++i) {
+        const url::URL &u = *parsed[i].first;
+        url::URL::tree_iterator b = u.begin_tree(), e = u.end_tree();
+        Node *hint = NULL;
+
+        if (i > 0) {
+            const size_t shared = skip_shared(b, e, *parsed[i - 1].first);
+
+            hint = nodes[parsed[i - 1].second]; // Where the last one ended
+
+            for (size_t d = hint->path_idx + 1 ; d > shared ; --d)
+                hint = parent_of(*hint);
+
+            if (shared == 0)
+                hint = NULL; // The root
+        }
+
+        Node *node = static_cast<Node*> (tree.insert(b, e, hint));
+
+        if (!node->page) { // Newly inserted, unique URL
+            ++leaves;
+            node->page = new PageData(u, now);
+            page_table.insert(node->page->id, node);
+            attach_host(*node, u.domain_id());
+        }
+
+        nodes[parsed[i].second] = node;
+    }
+
+    ids.reserve(ids.size() + urls.size());
+
+    for (size_t i = 0 ; i < urls.size() ; ++i) {
+        PageData *page = nodes[i]->page;
+
+        if (!from_seed)
+            page->links += links ? (*links)[i] : 1;
+
+        ids.push_back(page->id);
+    }
 
-    return page->url.page_id();
+    for (size_t i = 0 ; i < nodes.size() ; ++i)
+        mark_dirty(*nodes[i]);
 }
 
 } // sched
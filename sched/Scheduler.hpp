@@ -4,12 +4,21 @@
 // oodles
 #include "Node.hpp"
 #include "Crawler.hpp"
+#include "HashRing.hpp"
+#include "Politeness.hpp"
 #include "utility/Tree.hpp"
+#include "utility/Clock.hpp"
+#include "utility/TimingWheel.hpp"
+#include "utility/FlatHashMap.hpp"
+
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 // STL
 #include <queue>
 #include <string>
-#include <tr1/unordered_map>
+#include <vector>
 
 // libc
 #include <time.h> // For time()
@@ -25,60 +34,194 @@ class Subscriber; // Forward declaration for Scheduler
    
 } // event
 
+namespace net {
+
+class Endpoint; // Forward declaration for Scheduler
+
+} // net
+
 namespace sched {
 
+class Journal; // Forward declaration for Scheduler
+class Snapshot; // Forward declaration for Scheduler
 class Deferable; // Forward declaration for Scheduler
 class DeferredUpdate; // Forward declaration for Scheduler
 
 class Scheduler 
 {
     public:
+        /* Dependent typedefs */
+
+        /*
+         * What a crawl of a page found, see update_nodes()
+         */
+        struct Outcome
+        {
+            url::URL::hash_t id;
+            bool fetched, changed; // A page not fetched is abandoned
+            uint32_t response; // Time its fetch took, in ms, 0 if unknown
+            const Crawler *crawler; // That reported it, NULL if unknown
+
+            Outcome(url::URL::hash_t i,
+                    bool f,
+                    bool c,
+                    uint32_t r = 0,
+                    const Crawler *k = NULL) :
+                id(i),
+                fetched(f),
+                changed(c),
+                response(r),
+                crawler(k)
+            {}
+        };
+
         /* Member functions/methods */
         Scheduler(Dispatcher *d = NULL);
         ~Scheduler();
 
         const TreeBase& url_tree() const { return tree; }
-        void register_crawler(Crawler &c) { crawlers.push(&c); }
+        void register_crawler(Crawler &c); // Taken by the next run
+        void set_journal(Journal *j) { journal = j; } // Log all changes to j
+        void set_host_affinity(bool a) { affinity = a; } // See HashRing
+        Politeness& politeness() { return hosts; }
+        void set_lease(uint32_t l) { lease = l; } // In ms, 0 never expires
+        void set_unit_sizing(const UnitSizing &s) { sizing = s; } // See below
+
+        /*
+         * Must be set, if at all, before the first scheduling run (the unit
+         * sizing before any Crawler is registered)
+         */
+        void set_clock(const Clock &c) { clock = &c; }
+        const Clock& get_clock() const { return *clock; }
+        size_t pages() const { return leaves; }
 
         url::URL::hash_t schedule_from_seed(const std::string &url);
-        url::URL::hash_t schedule_from_crawl(const std::string &url);
+        url::URL::hash_t schedule_from_crawl(const std::string &url,
+                                             uint32_t links = 1);
+        void schedule_batch(const std::vector<std::string> &urls,
+                            std::vector<url::URL::hash_t> &ids,
+                            bool from_seed = false,
+                            const std::vector<uint32_t> *links = NULL);
 
         uint32_t run(BreadCrumbTrail *t = NULL); // Performs a scheduling run
+        uint32_t run_parallel(size_t workers); // Partitioned scheduling run
+        void weigh(size_t workers = 1); // Every node changed since, see run()
         
-        uint32_t update_schedule();
-        void update_node(url::URL::hash_t id, time_t time);
-        void defer_update(const Deferable &d, event::Subscriber &s);
+        uint32_t update_schedule(size_t workers = 1); // See DeferredUpdate
+        void update_node(url::URL::hash_t id,
+                         time_t time,
+                         bool changed = true,
+                         uint32_t response = 0, // See Outcome
+                         const Crawler *reporter = NULL);
+        void abandon_node(url::URL::hash_t id, // Its crawl failed
+                          const Crawler *reporter = NULL);
+        void update_nodes(const std::vector<Outcome> &outcomes,
+                          time_t time,
+                          size_t workers = 1);
+
+        /*
+         * Updates are deferred to the start of the next run, see
+         * DeferredUpdate. Once more than the bound (0 for none) are waiting
+         * true is returned and the session that deferred d should be held
+         * from reading any further until a run has taken them.
+         */
+        bool defer_update(const Deferable &d, event::Subscriber &s);
+        void hold_until_updated(const boost::shared_ptr<net::Endpoint> &e);
+        void set_update_bound(size_t b);
     private:
+        /* Internal Data Structures */
+        struct Partitioning; // Shared by the workers of run_parallel()
+        struct Weighing; // Shared by the workers of weigh()
+        struct Updating; // Shared by the workers of update_nodes()
+
+        /*
+         * A crawled page to be weighed again, its staleness having risen;
+         * stale once the page is crawled again (see PageData::refresh())
+         */
+        struct Refresh
+        {
+            Node *node;
+            uint32_t crawl; // The last_crawl of its page when scheduled
+
+            Refresh(Node *n = NULL, uint32_t c = 0) : node(n), crawl(c) {}
+        };
+
         /* Member variables/attributes */
         size_t leaves;
+        const Clock *clock;
+        bool affinity; // Assign each host to its own Crawler where possible
+        uint32_t lease; // Time a Crawler is given to return a page, in ms
+        UnitSizing sizing; // Of every Crawler's work unit
+        Journal *journal;
+        Dispatcher *dispatcher;
         BreadCrumbTrail *trail;
         DeferredUpdate *update;
+        Politeness hosts;
+        TimingWheel<Node*> leases; // Expiry of every page's assignment
+        TimingWheel<Refresh> refreshes; // Of every crawled page, in seconds
         Tree<Node::value_type> tree;
         std::priority_queue<Crawler*,
                             std::deque<Crawler*>,
                             RankCrawler> crawlers;
+        HashRing ring; // Every registered Crawler, by host
+        std::vector<Crawler*> registered; // Since the last run
+        boost::mutex registration; // Held for registered
+        std::vector<std::vector<Node*> > dirty; // To be weighed, by depth
 
         /*
          * We already have a hash function in URL that identifies the
-         * page, path and domain. TR1 requires the hash functor to
+         * page, path and domain. The table requires the hash functor to
          * take a key type and return a hash of type size_t. We
          * simply return the hash (because that's all we'll be passing
          * around outside of the Scheduler) or id() cast to size_t.
+         * The table is flat, an entry costs a key, a pointer and a byte.
          */
         struct hash_id
         {
             size_t operator() (url::URL::hash_t h) const { return h; }
         };
-        std::tr1::unordered_map<url::URL::hash_t, Node*, hash_id> page_table;
+        typedef FlatHashMap<url::URL::hash_t, Node*, hash_id> PageTable;
+        PageTable page_table;
+
+        /*
+         * During run_parallel() each worker has sole use of the subtrees
+         * (partitions) it fills from. The nodes above the partitions are
+         * shared so any change to them must be made whilst holding this.
+         */
+        mutable boost::mutex boundary;
 
         /* Member functions/methods */
-        Node* traverse_branch(Node &n);
-        void clean_tree_branch(Node &n) const;
-        void weigh_tree_branch(Node &n) const;
-        Node* select_best_child(Node &parent) const;
-        
+        Node* traverse_branch(Node &n, const Node *top = NULL);
+        void close_branch(Node *n, const Node *top = NULL) const;
+        void clean_tree_branch(Node &n, const Node *top = NULL) const;
+        void mark_dirty(Node &n);
+        void schedule_refresh(Node &n, time_t now);
+        void refresh(); // Mark dirty every page due to be weighed again
+        void weigh_level(Weighing &w) const;
+        void update_domains(Updating &u) const;
+        Node* select_best_child(Node &parent, bool shared = false) const;
+        void exhaust_node(Node &n) const;
+        void reopen_branch(Node &n) const;
+
+        void attach_host(Node &n, url::URL::hash_t domain_id);
+        url::URL::hash_t domain_of(const Node &n) const;
+        void release_hosts();
+        void admit_crawlers();
+
+        Node* assign_page(Node &n, Crawler &c, Politeness::msec_t now);
+        void lease_page(Node &n, Politeness::msec_t now);
+        void release_page(Node &n, uint32_t response = 0);
+        static bool leaseholder(const PageData &p, const Crawler *reporter);
+        void return_page(Node &n);
+        void reclaim();
         Crawler::unit_t fill_crawler(Crawler &c, Node *&n);
-        url::URL::hash_t schedule(const std::string &url, bool from_seed);
+        uint32_t fill_by_host(std::vector<Crawler*> &filled);
+        void fill_partitions(Partitioning &p);
+        void partition_tree(size_t n, std::vector<Node*> &tops) const;
+        url::URL::hash_t schedule(const std::string &url, bool from_seed,
+                                  uint32_t links = 1);
+
+        friend class Snapshot; // Requires tree, page_table, hosts &c.
 };
 
 } // sched
@@ -57,11 +57,20 @@ Session::GarbageCollector::trash(Message *m, key_t k)
 }
 
 // Session
-Session::Session()
+Session::Session() : crawler(NULL)
 {
     msg_context[Inbound] = msg_context[Outbound] = INVALID_ID;
 }
 
+/*
+ * The Scheduler reclaims the work of a Crawler left without a Session
+ */
+Session::~Session()
+{
+    if (crawler)
+        crawler->detach(*this);
+}
+
 void
 Session::handle_message(Message *m)
 {
@@ -74,13 +83,13 @@ Session::handle_message(Message *m)
 }
 
 void
-Session::begin_crawl(const vector<url::URL*> &urls)
+Session::begin_crawl(const vector<Node*> &pages)
 {
     BeginCrawl *m = new BeginCrawl;
-    vector<url::URL*>::const_iterator i = urls.begin(), j = urls.end();
-    
+    vector<Node*>::const_iterator i = pages.begin(), j = pages.end();
+
     while (i != j) {
-        m->urls.push_back(*i);
+        m->add((*i)->url());
         ++i;
     }
 
@@ -178,8 +187,9 @@ Session::continue_dialog(const RegisterCrawler &m)
      * based on this incoming data (name, cores etc.)
      */
     Crawler &c = context().create_crawler(m.name, m.cores);
-    scheduler().register_crawler(c);
     c.set_session(this);
+    crawler = &c;
+    context().trigger_schedule(); // It has room for a whole unit
     
 #ifdef DEBUG_SCHED
     std::cerr << "Registered crawler '" << m.name
@@ -198,9 +208,16 @@ Session::continue_dialog(const EndCrawl &m)
      * by the Crawler. We defer the update, however.
      */
     key_t k = reinterpret_cast<key_t>(&m);
-    const sched::Deferable update = {k, m.new_urls, m.scheduled_urls};
+    const sched::Deferable update = {k,
+                                          m.new_urls,
+                                          m.scheduled_urls,
+                                          m.response_times,
+                                          crawler};
+
+    if (scheduler().defer_update(update, garbage))
+        scheduler().hold_until_updated(get_endpoint()); // Backpressure
 
-    scheduler().defer_update(update, garbage);
+    context().trigger_schedule(); // Its unit is done, it awaits another
 
     return k; // We delete later, upon the garbage collector receive()
 }
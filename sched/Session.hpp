@@ -20,7 +20,9 @@
 namespace oodles {
 namespace sched {
 
+class Node; // Forward declaration for Session
 class Context; // Forward declaraton for Session
+class Crawler; // Forward declaration for Session
    
 namespace oop {
 
@@ -37,15 +39,18 @@ class Session : public net::oop::Session
         
         /* Member functions/methods */
         Session();
+        ~Session();
+
         void handle_message(Message *m);
 
         /*
          * The scheduler will eventually respond, after a schedule run,
          * to a RegisterCrawler message by sending URLs to the new crawler,
          * on an existing one, through this method. It passes to it all
-         * URLs it scheduled the crawler to er, crawl.
+         * URLs it scheduled the crawler to er, crawl, as the leaves of their
+         * pages; each URL is rebuilt from its leaf to be sent.
          */
-        void begin_crawl(const std::vector<url::URL*> &urls);
+        void begin_crawl(const std::vector<Node*> &pages);
     private:
         /* Internal Data Structures */
         class GarbageCollector : public event::Subscriber
@@ -86,6 +91,7 @@ class Session : public net::oop::Session
 
         /* Member variables/attributes */
         id_t msg_context[2];
+        Crawler *crawler; // Registered over this Session, if any
         GarbageCollector garbage;
         static const id_t message_subset[];
 };
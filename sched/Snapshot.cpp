@@ -0,0 +1,354 @@
+// oodles
+#include "Snapshot.hpp"
+#include "Scheduler.hpp"
+#include "utility/bytes.hpp"
+#include "utility/MappedFile.hpp"
+
+// STL
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+// libc
+#include <errno.h> // For errno
+#include <fcntl.h> // For open()
+#include <stdio.h> // For rename()
+#include <unistd.h> // For access(), write(), fsync() etc.
+
+// STL
+using std::string;
+using std::min;
+using std::pair;
+using std::vector;
+using std::make_pair;
+using std::numeric_limits;
+
+namespace {
+
+/*
+ * File layout;
+ *
+ * Header: magic, version, generation, #nodes, #pages
+ * Nodes (pre-order): label, #children, flags [, page record]
+ * Page record: origin, domain levels, flags, links, crawl count, last crawl,
+ *              epoch, change history
+ *
+ * The URL of a page is rebuilt from the path to it, see Node::url().
+ */
+const uint32_t MAGIC = 0x4C444F4F; // "OODL"
+const uint32_t VERSION = 5;
+
+enum {
+    HasPage = 1 << 0
+};
+
+enum {
+    Chunk = 1 << 20, // Bytes of an image chunk, see room()
+    Slack = 1 << 12 // Left for the record that ends one
+};
+
+typedef oodles::sched::Node Node;
+typedef oodles::sched::PageData PageData;
+typedef oodles::sched::Snapshot::Image Image;
+
+/*
+ * The chunk of image to append to, begun anew once nearly full so that
+ * no chunk is ever copied as the image grows
+ */
+string&
+room(Image &image)
+{
+    if (image.empty() || image.back().size() > Chunk - Slack) {
+        image.push_back(string());
+        image.back().reserve(Chunk);
+    }
+
+    return image.back();
+}
+
+void
+put_node(string &out, const Node &n)
+{
+    const uint8_t flags = n.page ? HasPage : 0;
+
+    oodles::put_string(out, n.value.str());
+    oodles::put_bytes(out, static_cast<uint32_t>(n.size()));
+    oodles::put_bytes(out, flags);
+
+    if (n.page) {
+        const PageData &p = *n.page;
+
+        oodles::put_string(out, p.origin.str());
+        oodles::put_bytes(out, p.domain_levels);
+        oodles::put_bytes(out, p.flags);
+        oodles::put_bytes(out, p.links);
+        oodles::put_bytes(out, static_cast<uint32_t>(p.crawl_count));
+        oodles::put_bytes(out, static_cast<int64_t>(p.last_crawl));
+        oodles::put_bytes(out, static_cast<int64_t>(p.epoch));
+        oodles::put_bytes(out, p.change.checks);
+        oodles::put_bytes(out, p.change.changes);
+        oodles::put_bytes(out, p.change.observed);
+    }
+}
+
+} // anonymous
+
+namespace oodles {
+namespace sched {
+
+Snapshot::Snapshot(const string &path) : path(path)
+{
+}
+
+bool
+Snapshot::exists() const
+{
+    return access(path.c_str(), R_OK) == 0;
+}
+
+/*
+ * Rebuild the tree from the snapshot returning the generation it was
+ * written with. The scheduler should hold no pages of its own beforehand.
+ */
+uint32_t
+Snapshot::read(Scheduler &s) throw (OpenError, ReadError)
+{
+    const MappedFile file(path);
+    ByteReader r(file.data(), file.size());
+
+    if (r.get<uint32_t>() != MAGIC || r.get<uint32_t>() != VERSION)
+        throw ReadError("Snapshot::read", 0,
+                        "%s is not a version %u scheduler snapshot.",
+                        path.c_str(), VERSION);
+
+    const uint32_t generation = r.get<uint32_t>();
+    const uint64_t nodes = r.get<uint64_t>(), pages = r.get<uint64_t>();
+    const Node &const_root = static_cast<const Node&>(s.tree.root());
+    vector<Node*> restored;
+    uint64_t created = 1; // The root
+
+    /*
+     * Explicit stack of (node, remaining children) in place of recursion
+     */
+    vector<pair<Node*, uint32_t> > stack;
+
+    restored.reserve(pages);
+    r.get_string(); // The root label is fixed by the Scheduler
+    stack.push_back(make_pair(const_cast<Node*>(&const_root),
+                              r.get<uint32_t>()));
+    r.get<uint8_t>();
+
+    while (!stack.empty()) {
+        if (stack.back().second == 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        --stack.back().second;
+
+        Node &parent = *stack.back().first;
+        const Label label(r.get_string());
+        const uint32_t children = r.get<uint32_t>();
+        const uint8_t flags = r.get<uint8_t>();
+        Node *n = static_cast<Node*>(parent.create_child(label,
+                                                         parent.path_idx + 1));
+
+        if (flags & HasPage) {
+            const Label origin(r.get_string());
+            const uint8_t levels = r.get<uint8_t>(), page = r.get<uint8_t>();
+            const uint32_t links = r.get<uint32_t>(),
+                           crawl_count = r.get<uint32_t>();
+            const time_t last_crawl = r.get<int64_t>(),
+                         epoch = r.get<int64_t>();
+            ChangeRate change;
+
+            change.checks = r.get<uint16_t>();
+            change.changes = r.get<uint16_t>();
+            change.observed = r.get<uint32_t>();
+
+            if (!n->page) {
+                const url::URL u(n->url(origin, levels, page));
+
+                n->page = new PageData(u, epoch);
+                s.page_table.insert(n->page->id, n);
+                s.attach_host(*n, u.domain_id());
+                restored.push_back(n);
+                ++s.leaves;
+            }
+
+            n->page->links = links;
+            n->page->crawl_count =
+                min<uint32_t>(crawl_count, numeric_limits<uint16_t>::max());
+            n->page->last_crawl = last_crawl;
+            n->page->change = change;
+        }
+
+        stack.push_back(make_pair(n, children));
+        ++created;
+    }
+
+    if (created != nodes || restored.size() != pages || !r.empty())
+        throw ReadError("Snapshot::read", 0,
+                        "%s is inconsistent; expected %llu nodes, %llu pages.",
+                        path.c_str(),
+                        static_cast<unsigned long long>(nodes),
+                        static_cast<unsigned long long>(pages));
+
+    /*
+     * Weigh the tree only once every node is in place
+     */
+    const time_t now = s.clock->now();
+
+    for (size_t i = 0 ; i < restored.size() ; ++i) {
+        s.mark_dirty(*restored[i]);
+        s.schedule_refresh(*restored[i], now);
+    }
+
+    s.weigh();
+
+    return generation;
+}
+
+void
+Snapshot::write(const Scheduler &s, uint32_t generation)
+throw (OpenError, WriteError)
+{
+    Image chunks;
+
+    image(s, generation, chunks);
+    write(chunks);
+}
+
+/*
+ * Serialise the tree, as it is now, into chunks
+ */
+void
+Snapshot::image(const Scheduler &s, uint32_t generation, Image &chunks)
+{
+    uint64_t nodes = 0, pages = 0;
+    const Node &root = static_cast<const Node&>(s.url_tree().root());
+    vector<const Node*> stack(1, &root);
+
+    chunks.clear();
+
+    string &header = room(chunks);
+
+    put_bytes(header, MAGIC);
+    put_bytes(header, VERSION);
+    put_bytes(header, generation);
+    put_bytes(header, nodes); // Placeholders, rewritten below
+    put_bytes(header, pages);
+
+    const size_t counts = header.size() - sizeof(nodes) - sizeof(pages);
+
+    while (!stack.empty()) {
+        const Node &n = *stack.back();
+        stack.pop_back();
+
+        put_node(room(chunks), n);
+        ++nodes;
+
+        if (n.page)
+            ++pages;
+
+        /*
+         * Push in reverse so children are written in ascending order
+         */
+        for (size_t i = n.size() ; i > 0 ; --i)
+            stack.push_back(&static_cast<const Node&>(n.child(i - 1)));
+    }
+
+    header.replace(counts, sizeof(nodes),
+                   reinterpret_cast<const char*>(&nodes), sizeof(nodes));
+    header.replace(counts + sizeof(nodes), sizeof(pages),
+                   reinterpret_cast<const char*>(&pages), sizeof(pages));
+}
+
+/*
+ * Write to a temporary file and rename() it over any previous snapshot so
+ * a failure part way through never leaves a truncated snapshot behind.
+ * The file, and then its directory, are synced before returning; only then
+ * may the journals it covers be discarded. Touches nothing but image, so
+ * may be called from any thread.
+ */
+void
+Snapshot::write(const Image &image) throw (OpenError, WriteError)
+{
+    const string temporary(path + ".tmp");
+    const int fd = ::open(temporary.c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd == -1)
+        throw OpenError("Snapshot::write", errno,
+                        "Failed to open %s for writing.", temporary.c_str());
+
+    for (Image::const_iterator i = image.begin() ; i != image.end() ; ++i) {
+        const char *p = i->data();
+        size_t n = i->size();
+
+        while (n > 0) {
+            const ssize_t w = ::write(fd, p, n);
+
+            if (w == -1) {
+                if (errno == EINTR)
+                    continue;
+
+                const int error = errno;
+
+                ::close(fd);
+                throw WriteError("Snapshot::write", error,
+                                 "Failed writing snapshot to %s.",
+                                 temporary.c_str());
+            }
+
+            p += w;
+            n -= w;
+        }
+    }
+
+    if (fsync(fd) == -1) {
+        const int error = errno;
+
+        ::close(fd);
+        throw WriteError("Snapshot::write", error,
+                         "Failed to sync %s.", temporary.c_str());
+    }
+
+    if (::close(fd) == -1)
+        throw WriteError("Snapshot::write", errno,
+                         "Failed writing snapshot to %s.", temporary.c_str());
+
+    if (rename(temporary.c_str(), path.c_str()) == -1)
+        throw WriteError("Snapshot::write", errno,
+                         "Failed to rename %s to %s.",
+                         temporary.c_str(), path.c_str());
+
+    sync_directory();
+}
+
+/*
+ * The rename() is only durable once the directory holding path is synced
+ */
+void
+Snapshot::sync_directory() const throw (OpenError, WriteError)
+{
+    const string::size_type slash = path.rfind('/');
+    const string directory(slash == string::npos ? "." :
+                           slash == 0 ? "/" : path.substr(0, slash));
+    const int fd = ::open(directory.c_str(), O_RDONLY);
+
+    if (fd == -1)
+        throw OpenError("Snapshot::sync_directory", errno,
+                        "Failed to open %s.", directory.c_str());
+
+    const int synced = fsync(fd), error = errno;
+
+    ::close(fd);
+
+    if (synced == -1)
+        throw WriteError("Snapshot::sync_directory", error,
+                         "Failed to sync %s.", directory.c_str());
+}
+
+} // sched
+} // oodles
@@ -0,0 +1,62 @@
+#ifndef OODLES_SCHED_SNAPSHOT_HPP
+#define OODLES_SCHED_SNAPSHOT_HPP
+
+// oodles
+#include "common/Exceptions.hpp"
+
+// STL
+#include <list>
+#include <string>
+
+// libc
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+namespace sched {
+
+class Scheduler; // Forward declaration for Snapshot
+
+/*
+ * A binary image of the URL tree and the PageData of every page within it.
+ * Nodes are written in pre-order (depth-first) so a snapshot is rebuilt in
+ * a single pass over the memory-mapped file; each node is created directly
+ * below its parent with no descent from the root. Integers are stored in
+ * host byte order - a snapshot is only read back by the host that wrote it.
+ *
+ * Each snapshot carries a generation so that a Journal written against an
+ * older snapshot is never replayed on top of a newer one.
+ */
+class Snapshot
+{
+    public:
+        /* Dependent typedefs */
+        typedef std::list<std::string> Image; // In chunks, see image()
+
+        /* Member functions/methods */
+        Snapshot(const std::string &path);
+
+        bool exists() const;
+        uint32_t read(Scheduler &s) throw (OpenError, ReadError);
+        void write(const Scheduler &s, uint32_t generation)
+        throw (OpenError, WriteError);
+
+        /*
+         * write() in two steps; image() where the tree is not changing and
+         * then write(image) wherever, e.g. on a thread of its own
+         */
+        static void image(const Scheduler &s,
+                          uint32_t generation,
+                          Image &chunks);
+        void write(const Image &image) throw (OpenError, WriteError);
+    private:
+        /* Member variables/attributes */
+        const std::string path;
+
+        /* Member functions/methods */
+        void sync_directory() const throw (OpenError, WriteError);
+};
+
+} // sched
+} // oodles
+
+#endif
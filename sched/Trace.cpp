@@ -0,0 +1,352 @@
+// oodles
+#include "Node.hpp"
+#include "Trace.hpp"
+#include "Crawler.hpp"
+#include "utility/bytes.hpp"
+#include "utility/TreeBase.hpp"
+#include "utility/file-ops.hpp"
+#include "utility/BreadCrumbTrail.hpp"
+
+// STL
+#include <sstream>
+
+// libc
+#include <errno.h> // For errno
+#include <assert.h> // For assert()
+#include <stdio.h> // For rename()
+#include <fcntl.h> // For open()
+#include <unistd.h> // For write(), close() etc.
+#include <sys/stat.h> // For fstat()
+
+// STL
+using std::string;
+using std::vector;
+using std::ostringstream;
+
+namespace {
+
+/*
+ * File layout;
+ *
+ * Header: magic, version
+ * Records: type, payload length, payload
+ *
+ * Labels payload: count, then an id and text for each
+ * Runs payload: sequence, start, update time, run time, updated, assigned,
+ *               count of crumbs, then a path_idx, child_idx, label id and
+ *               weight for each, count of assignments, then a page id and
+ *               crawler label id for each
+ */
+const uint32_t MAGIC = 0x54444F4F; // "OODT"
+const uint32_t VERSION = 1;
+const size_t OVERHEAD = sizeof(uint8_t) + sizeof(uint32_t); // Per record
+
+string
+numbered(const string &path, size_t n)
+{
+    ostringstream s;
+    s << path << '.' << n;
+    return s.str();
+}
+
+} // anonymous
+
+namespace oodles {
+namespace sched {
+
+// Trace::Reader
+Trace::Reader::Reader(const string &path) throw (ReadError) : offset(0)
+{
+    read_file_data(path, data);
+
+    ByteReader r(data.data(), data.size());
+
+    if (r.remaining() < sizeof(uint32_t) * 2 ||
+        r.get<uint32_t>() != MAGIC ||
+        r.get<uint32_t>() != VERSION)
+        throw ReadError("Trace::Reader::Reader", 0,
+                        "%s is not a trace of scheduling runs.", path.c_str());
+
+    offset = r.offset();
+}
+
+bool
+Trace::Reader::next(Replay &run) throw (ReadError)
+{
+    for (;;) {
+        ByteReader r(data.data() + offset, data.size() - offset);
+
+        if (r.remaining() < OVERHEAD)
+            return false;
+
+        const uint8_t type = r.get<uint8_t>();
+        const uint32_t length = r.get<uint32_t>();
+
+        if (r.remaining() < length)
+            return false; // Torn write
+
+        ByteReader payload(r.take(length), length);
+
+        offset += r.offset();
+
+        if (type == Labels) {
+            for (uint32_t n = payload.get<uint32_t>() ; n > 0 ; --n) {
+                const uint32_t id = payload.get<uint32_t>();
+                labels[id] = payload.get_string();
+            }
+        } else if (type == Runs) {
+            run.sequence = payload.get<uint64_t>();
+            run.start = payload.get<int64_t>();
+            run.update_time = payload.get<uint32_t>();
+            run.run_time = payload.get<uint32_t>();
+            run.updated = payload.get<uint32_t>();
+            run.assigned = payload.get<uint32_t>();
+
+            run.crumbs.resize(payload.get<uint32_t>());
+
+            for (size_t i = 0 ; i < run.crumbs.size() ; ++i) {
+                Crumb &c = run.crumbs[i];
+
+                c.path_idx = payload.get<int16_t>();
+                c.child_idx = payload.get<int32_t>();
+                c.label = labels[payload.get<uint32_t>()];
+                c.weight = payload.get<float>();
+            }
+
+            run.assignments.resize(payload.get<uint32_t>());
+
+            for (size_t i = 0 ; i < run.assignments.size() ; ++i) {
+                Assignment &a = run.assignments[i];
+
+                a.page = payload.get<url::URL::hash_t>();
+                a.crawler = labels[payload.get<uint32_t>()];
+            }
+
+            return true;
+        } else {
+            throw ReadError("Trace::Reader::next", 0,
+                            "Unknown record type %u at offset %lu.",
+                            type, static_cast<unsigned long>(offset));
+        }
+    }
+}
+
+// Trace
+Trace::Trace(const string &path, size_t limit, size_t keep) :
+    fd(-1),
+    path(path),
+    limit(limit),
+    keep(keep),
+    written(0),
+    runs(0),
+    fresh(0)
+{
+}
+
+Trace::~Trace()
+{
+    if (fd != -1)
+        ::close(fd);
+}
+
+/*
+ * Continue the file at path, if there is one, or begin it
+ */
+void
+Trace::open() throw (OpenError, WriteError)
+{
+    assert(fd == -1);
+
+    struct stat s;
+
+    if ((fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644)) == -1
+        || fstat(fd, &s) == -1)
+        throw OpenError("Trace::open", errno,
+                        "Failed to open %s for writing.", path.c_str());
+
+    written = s.st_size;
+    seen.clear(); // Every label is written afresh by this process
+
+    if (written == 0) {
+        write_header();
+        flush();
+    }
+}
+
+/*
+ * Record the run r; trail, if given, is gathered in following it through
+ * tree, which must be as the run left it.
+ */
+void
+Trace::record(const Run &r, const TreeBase &tree, BreadCrumbTrail *trail)
+throw (OpenError, WriteError)
+{
+    uint32_t visited = 0, assigned = 0;
+    string run;
+
+    if (trail)
+        follow(tree, *trail, visited, assigned);
+
+    if (fresh) {
+        string l;
+
+        put_bytes(l, fresh);
+        l.append(labels);
+        append(Labels, l);
+    }
+
+    put_bytes(run, runs++);
+    put_bytes(run, r.start);
+    put_bytes(run, r.update_time);
+    put_bytes(run, r.run_time);
+    put_bytes(run, r.updated);
+    put_bytes(run, r.assigned);
+    put_bytes(run, visited);
+    run.append(crumbs);
+    put_bytes(run, assigned);
+    run.append(assignments);
+    append(Runs, run);
+
+    fresh = 0;
+    labels.clear();
+    crumbs.clear();
+    assignments.clear();
+
+    flush();
+
+    if (written >= limit)
+        rotate();
+}
+
+/*
+ * Walk the trail through the tree from its root. A crumb is left at each
+ * node visited, so the node of a crumb at depth d is a child of the node
+ * of the last crumb at depth d - 1; any deeper were left on the way down
+ * to nodes since backed out of. A leaf visited that is now assigned was
+ * assigned by this run (an assigned leaf is never a candidate).
+ */
+void
+Trace::follow(const TreeBase &tree, BreadCrumbTrail &trail,
+              uint32_t &visited, uint32_t &assigned)
+{
+    const Node &root = static_cast<const Node&>(tree.root());
+    vector<const Node*> path; // Node of the last crumb at each depth + 1
+
+    while (!trail.empty()) {
+        const BreadCrumbTrail::Point p = trail.gather_crumb();
+        const Node *node = &root;
+
+        if (p.first >= 0) {
+            if (static_cast<size_t>(p.first) >= path.size())
+                break; // Not joined to the trail so far, follow no further
+
+            path.resize(p.first + 1); // Back out to the parent
+            node = &static_cast<const Node&>(path.back()->child(p.second));
+        } else {
+            path.clear();
+        }
+
+        path.push_back(node);
+
+        put_bytes(crumbs, static_cast<int16_t>(p.first));
+        put_bytes(crumbs, static_cast<int32_t>(p.second));
+        put_bytes(crumbs, add_label(node->value));
+        put_bytes(crumbs, node->weight());
+        ++visited;
+
+        if (node->leaf() && node->assigned()) {
+            put_bytes(assignments, node->page->id);
+            put_bytes(assignments,
+                      add_label(Label(node->page->crawler->id())));
+            ++assigned;
+        }
+    }
+}
+
+/*
+ * Returns the id of l, its text being written ahead of the run if it has
+ * not yet been to this file
+ */
+uint32_t
+Trace::add_label(const Label &l)
+{
+    const uint32_t id = l.id();
+
+    if (id >= seen.size())
+        seen.resize(id + 1 + (id >> 1));
+
+    if (!seen[id]) {
+        seen[id] = true;
+        put_bytes(labels, id);
+        put_string(labels, l.str());
+        ++fresh;
+    }
+
+    return id;
+}
+
+void
+Trace::append(Record type, const string &payload)
+{
+    put_bytes(buffer, static_cast<uint8_t>(type));
+    put_bytes(buffer, static_cast<uint32_t>(payload.size()));
+    buffer.append(payload);
+}
+
+void
+Trace::write_header()
+{
+    put_bytes(buffer, MAGIC);
+    put_bytes(buffer, VERSION);
+}
+
+void
+Trace::flush() throw (WriteError)
+{
+    const char *p = buffer.data();
+    size_t n = buffer.size();
+
+    while (n > 0) {
+        const ssize_t w = ::write(fd, p, n);
+
+        if (w == -1) {
+            if (errno == EINTR)
+                continue;
+
+            throw WriteError("Trace::flush", errno,
+                             "Failed to write %lu bytes to %s.",
+                             static_cast<unsigned long>(n), path.c_str());
+        }
+
+        p += w;
+        n -= w;
+    }
+
+    written += buffer.size();
+    buffer.clear();
+}
+
+/*
+ * Move each file along by one, the oldest kept being overwritten, and
+ * begin a new one
+ */
+void
+Trace::rotate() throw (OpenError, WriteError)
+{
+    ::close(fd);
+    fd = -1;
+
+    if (keep == 0) {
+        unlink(path.c_str());
+    } else {
+        for (size_t i = keep - 1 ; i > 0 ; --i)
+            rename(numbered(path, i).c_str(), numbered(path, i + 1).c_str());
+
+        rename(path.c_str(), numbered(path, 1).c_str());
+    }
+
+    open();
+}
+
+} // sched
+} // oodles
@@ -0,0 +1,146 @@
+#ifndef OODLES_SCHED_TRACE_HPP
+#define OODLES_SCHED_TRACE_HPP
+
+// oodles
+#include "url/URL.hpp"
+#include "common/Exceptions.hpp"
+#include "utility/StringInterner.hpp"
+
+// STL
+#include <map>
+#include <string>
+#include <vector>
+
+// libc
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint32_t, int64_t
+
+namespace oodles {
+
+class TreeBase; // Forward declaration for Trace
+class BreadCrumbTrail; // Forward declaration for Trace
+
+namespace sched {
+
+/*
+ * A compact binary record of every scheduling run: its timings, the trail
+ * it left through the tree (a path_idx, child_idx pair for each node it
+ * visited, along with the node's label and its weight once the run was
+ * over) and the pages it assigned. Each label's text is written once per
+ * file, ahead of the first run that visits it, and thereafter only its id.
+ *
+ * Records are appended to <path> with a single write() per run and are
+ * never synced; the trace is for diagnosis, not recovery. Once the file
+ * exceeds its limit it is moved to <path>.1 (and that to <path>.2 and so
+ * on, the oldest beyond keep being removed) and a new file is begun.
+ *
+ * Runs made by Scheduler::run_parallel() leave no trail, only their
+ * timings are recorded.
+ */
+class Trace
+{
+    public:
+        /* Dependent typedefs */
+        enum {
+            Limit = 64 << 20, // Bytes of a file before it's rotated
+            Keep = 3 // Rotated files kept
+        };
+
+        struct Run
+        {
+            int64_t start; // In ms since 1970
+            uint32_t update_time, run_time; // In microseconds
+            uint32_t updated, assigned; // No. of URLs
+
+            Run() : start(0), update_time(0), run_time(0),
+                    updated(0), assigned(0) {}
+        };
+
+        struct Crumb
+        {
+            int16_t path_idx; // Depth, -1 for the root
+            int32_t child_idx;
+            std::string label;
+            float weight;
+        };
+
+        struct Assignment
+        {
+            url::URL::hash_t page;
+            std::string crawler;
+        };
+
+        /*
+         * A run as it is read back, see Reader
+         */
+        struct Replay : public Run
+        {
+            uint64_t sequence; // Of the run within the scheduler's life
+            std::vector<Crumb> crumbs;
+            std::vector<Assignment> assignments;
+        };
+
+        /*
+         * Reads every run recorded in a single file, in order. A run torn
+         * by a crash at the end of the file is not returned.
+         */
+        class Reader
+        {
+            public:
+                /* Member functions/methods */
+                Reader(const std::string &path) throw (ReadError);
+
+                bool next(Replay &r) throw (ReadError); // False at the end
+            private:
+                /* Member variables/attributes */
+                std::string data;
+                size_t offset;
+                std::map<uint32_t, std::string> labels; // By id
+        };
+
+        /* Member functions/methods */
+        Trace(const std::string &path, size_t limit = Limit, size_t keep = Keep);
+        ~Trace();
+
+        void open() throw (OpenError, WriteError);
+        void record(const Run &r, const TreeBase &tree, BreadCrumbTrail *trail)
+        throw (OpenError, WriteError);
+    private:
+        /* Internal Data Structures */
+        enum Record {
+            Labels = 1, // Text of labels first seen in the file
+            Runs // A run, its trail and assignments
+        };
+
+        /* Member variables/attributes */
+        int fd;
+        const std::string path;
+        const size_t limit, keep;
+        size_t written; // Bytes of the current file
+        uint64_t runs; // Recorded
+        std::vector<bool> seen; // Label ids written to the current file
+        std::string buffer; // Records yet to be written
+
+        /*
+         * Of the run being recorded
+         */
+        uint32_t fresh; // No. of labels new to the file
+        std::string labels, crumbs, assignments;
+
+        /* Member functions/methods */
+        void follow(const TreeBase &tree, BreadCrumbTrail &trail,
+                    uint32_t &visited, uint32_t &assigned);
+        uint32_t add_label(const Label &l);
+        void append(Record type, const std::string &payload);
+        void write_header();
+        void flush() throw (WriteError);
+        void rotate() throw (OpenError, WriteError);
+
+        Trace(const Trace &t); // Do not allow...
+        Trace& operator= (const Trace &t); // ... copying.
+};
+
+} // sched
+} // oodles
+
+#endif
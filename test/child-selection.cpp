@@ -0,0 +1,266 @@
+// oodles
+#include "sched/Scheduler.hpp"
+
+// STL
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+#include <time.h> // For time()
+#include <sys/time.h> // For gettimeofday()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::string;
+using std::vector;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::sched::Node;
+using oodles::sched::Crawler;
+using oodles::sched::Scheduler;
+
+namespace {
+
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+string
+page_url(int i)
+{
+    ostringstream s;
+    s << "http://www.example.com/wiki/page" << i << ".html";
+    return s.str();
+}
+
+/*
+ * The selection made by the Scheduler prior to the ranked children; a
+ * linear scan over the breadth of the branch normalising every weight.
+ */
+Node*
+scan_best_child(Node &parent)
+{
+    Node *n = NULL;
+
+    for (size_t i = 0 ; i < parent.size() ; ++i) {
+        Node &c = parent.child(i);
+
+        if (c.visit_state == Node::Red) // Skip-over any visited branch
+            continue;
+
+        if (c.page && !c.eligible()) // Ignore ineligible yet crawlable nodes
+            continue;
+
+        if (!n || !(n->weight() > c.weight()))
+            n = &c;
+    }
+
+    return n;
+}
+
+Node*
+ranked_best_child(Node &parent)
+{
+    return parent.best_child();
+}
+
+/*
+ * Follow the broadest branch down from the root to locate the wide node
+ */
+Node&
+widest_node(const Scheduler &s)
+{
+    const Node &root = static_cast<const Node&>(s.url_tree().root());
+    Node *n = const_cast<Node*>(&root);
+
+    while (n->size() > 0) {
+        Node *w = &static_cast<Node&>(n->child(0));
+
+        for (size_t i = 1 ; i < n->size() ; ++i) {
+            Node &c = n->child(i);
+
+            if (c.size() > w->size())
+                w = &c;
+        }
+
+        if (w->size() == 0)
+            break; // The children of n are the pages themselves
+
+        n = w;
+    }
+
+    return *n;
+}
+
+/*
+ * Repeatedly select, assign and re-rank as fill_crawler() would within
+ * the one wide branch. Every selection is recorded in picked.
+ */
+double
+drain(Node &parent,
+      Node* (*select)(Node&),
+      Crawler &c,
+      size_t n,
+      vector<Node*> &picked)
+{
+    struct timeval start;
+    gettimeofday(&start, NULL);
+
+    for (size_t i = 0 ; i < n ; ++i) {
+        Node *x = select(parent);
+
+        if (!x)
+            break;
+
+        x->assign_crawler(c);
+        x->update_rank();
+        picked.push_back(x);
+    }
+
+    const double t = elapsed(start);
+
+    for (size_t i = 0 ; i < picked.size() ; ++i) {
+        picked[i]->unassign_crawler(); // Restore the branch
+        picked[i]->update_rank();
+    }
+
+    return t;
+}
+
+/*
+ * A page heading a path (here the wide node) weighed again, with nothing
+ * changed, must keep the same weight
+ */
+bool
+reweigh(Node &n)
+{
+    const time_t now = time(NULL);
+
+    n.calculate_weight(now);
+    const float once = n.weight();
+    n.calculate_weight(now);
+
+    return n.page && n.weight() == once;
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program << " [pages] [selections] [rounds]\n";
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    if (argc > 4) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int pages = argc > 1 ? atoi(argv[1]) : 20000,
+              selections = argc > 2 ? atoi(argv[2]) : 2000,
+              rounds = argc > 3 ? atoi(argv[3]) : 2000;
+
+    try {
+        Scheduler scheduler;
+        struct timeval start;
+
+        gettimeofday(&start, NULL);
+
+        for (int i = 0 ; i < pages ; ++i)
+            scheduler.schedule_from_seed(page_url(i));
+
+        scheduler.schedule_from_seed("http://www.example.com/wiki");
+
+        /*
+         * Give the pages a spread of (deterministic) popularity
+         */
+        srand(42);
+
+        for (int i = 0 ; i < pages ; ++i) {
+            for (int j = rand() % 4 ; j > 0 ; --j)
+                scheduler.schedule_from_crawl(page_url(rand() % pages));
+        }
+
+        scheduler.weigh();
+
+        cout << "Built a branch of " << pages << " pages in "
+             << elapsed(start) << "s.\n";
+
+        Node &wide = widest_node(scheduler);
+        const bool steady = reweigh(wide);
+
+        cout << "Re-weigh: " << (steady ? "passed" : "failed") << endl;
+
+        if (!steady)
+            return 1;
+
+        Crawler crawler("bench", 1024);
+        vector<Node*> scanned, ranked;
+        const double s = drain(wide, scan_best_child, crawler,
+                               selections, scanned),
+                     r = drain(wide, ranked_best_child, crawler,
+                               selections, ranked);
+
+        cout << "Drain of " << selections << " selections over "
+             << wide.size() << " children:\n"
+             << "\tLinear scan:     " << s << "s\n"
+             << "\tRanked children: " << r << "s\n";
+
+        if (scanned != ranked) {
+            cerr << "Ranked selection differs from the linear scan!\n";
+            return 1;
+        }
+
+        /*
+         * Alternate link updates (which re-rank the branch) with selections
+         */
+        double scan_time = 0, rank_time = 0, update_time = 0;
+
+        for (int i = 0 ; i < rounds ; ++i) {
+            gettimeofday(&start, NULL);
+            scheduler.schedule_from_crawl(page_url(rand() % pages));
+            scheduler.weigh();
+            update_time += elapsed(start);
+
+            gettimeofday(&start, NULL);
+            Node *x = scan_best_child(wide);
+            scan_time += elapsed(start);
+
+            gettimeofday(&start, NULL);
+            Node *y = ranked_best_child(wide);
+            rank_time += elapsed(start);
+
+            if (x != y) {
+                cerr << "Ranked selection differs from the linear scan!\n";
+                return 1;
+            }
+        }
+
+        cout << "Churn of " << rounds << " link updates and selections:\n"
+             << "\tUpdates:         " << update_time << "s\n"
+             << "\tLinear scan:     " << scan_time << "s\n"
+             << "\tRanked children: " << rank_time << "s\n";
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
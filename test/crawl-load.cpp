@@ -0,0 +1,225 @@
+// oodles
+#include "url/URL.hpp"
+#include "utility/Linker.hpp"
+#include "utility/Dispatcher.hpp"
+
+#include "net/oop/Session.hpp"
+#include "net/oop/Protocol.hpp"
+#include "net/oop/Messages.hpp"
+
+#include "net/core/Client.hpp"
+#include "net/core/HandlerCreator.hpp"
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+// STL
+#include <string>
+#include <sstream>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+#include <getopt.h> // For getopt()
+#include <sys/time.h> // For gettimeofday()
+
+// STL
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::string;
+using std::make_pair;
+using std::ostringstream;
+
+// Boost
+using boost::bind;
+using boost::posix_time::seconds;
+using boost::asio::deadline_timer;
+
+// oodles
+using oodles::url::URL;
+using oodles::net::oop::EndCrawl;
+using oodles::net::oop::BeginCrawl;
+using oodles::net::oop::RegisterCrawler;
+
+namespace {
+
+/*
+ * Crawlers that fetch nothing; every URL sent to them is reported at once
+ * as changed along with the given no. of links from it to new pages of its
+ * own host. Measures how many URLs a scheduler (or a router and its
+ * shards) can turn around in a given time.
+ */
+size_t links = 2;
+size_t crawled = 0; // By every crawler
+size_t discovered = 0; // New pages reported
+size_t waits = 0; // Units awaited after reporting one back
+double waited = 0; // Seconds spent in those waits
+
+double elapsed(const struct timeval &from);
+
+class Session : public oodles::net::oop::Session
+{
+    public:
+        Session() : awaiting(false) {}
+        void handle_message(oodles::net::oop::Message *m);
+    private:
+        bool awaiting; // A unit since reporting back at sent
+        struct timeval sent;
+};
+
+struct LoadContext : public oodles::net::CallerContext, public oodles::Linker
+{
+    size_t crawlers; // Connected so far
+
+    LoadContext() : crawlers(0) {}
+
+    void start(oodles::net::SessionHandler &s)
+    {
+        const oodles::Link l(this, static_cast<Session*>(&s));
+        ostringstream name;
+        RegisterCrawler *m = new RegisterCrawler;
+
+        name << "load-" << crawlers++;
+        m->name = name.str();
+        m->cores = 1;
+
+        static_cast<Session&>(s).push_message(m);
+    }
+};
+
+void
+Session::handle_message(oodles::net::oop::Message *m)
+{
+    if (m->id() == oodles::net::oop::BEGIN_CRAWL) {
+        const BeginCrawl &b = static_cast<const BeginCrawl&>(*m);
+        EndCrawl *e = new EndCrawl;
+
+        if (awaiting) {
+            waited += elapsed(sent);
+            ++waits;
+        }
+
+        for (size_t i = 0 ; i < b.hosts.size() ; ++i) {
+            for (size_t j = 0 ; j < b.hosts[i].size() ; ++j) {
+                const URL &url = b.hosts[i][j];
+
+                e->scheduled_urls.push_back(make_pair(url.page_id(),
+                                                      EndCrawl::Changed));
+
+                for (size_t k = 0 ; k < links ; ++k) {
+                    ostringstream u;
+                    u << "http://" << url.host() << "/page" << discovered++
+                      << ".html";
+                    e->new_urls.push_back(make_pair(u.str(), false));
+                }
+            }
+        }
+
+        crawled += b.count();
+        push_message(e);
+
+        gettimeofday(&sent, NULL);
+        awaiting = true;
+    }
+
+    delete m;
+}
+
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+void
+report(oodles::Dispatcher &d, const struct timeval &start)
+{
+    const double t = elapsed(start);
+
+    cout << crawled << " URLs crawled in " << t << "s ("
+         << crawled / t << " URLs/s), " << discovered << " links found.\n";
+
+    if (waits)
+        cout << "Waited " << waited / waits * 1e3 << "ms on average for each"
+             << " of " << waits << " units after reporting back.\n";
+
+    d.stop();
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program << " [-c <host:port>] [-n <crawlers>]"
+         << " [-t <seconds>] [-l <links per page>]\n";
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    int ch = -1, crawlers = 8, duration = 10;
+    string connect_to("127.0.0.1:8888");
+    const char *short_options = "hc:n:t:l:";
+    const struct option long_options[6] = {
+        {"help", no_argument, NULL, short_options[0]},
+        {"connect", required_argument, NULL, short_options[1]},
+        {"crawlers", required_argument, NULL, short_options[3]},
+        {"time", required_argument, NULL, short_options[5]},
+        {"links", required_argument, NULL, short_options[7]},
+        {NULL, 0, NULL, 0}
+    };
+
+    while ((ch = getopt_long(argc, argv,
+                             short_options,
+                             long_options, NULL)) != -1)
+    {
+        switch (ch) {
+            case 'c':
+                connect_to = optarg;
+                break;
+            case 'n':
+                crawlers = atoi(optarg);
+                break;
+            case 't':
+                duration = atoi(optarg);
+                break;
+            case 'l':
+                links = atoi(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    try {
+        typedef oodles::net::oop::Protocol OOP;
+        typedef oodles::net::Creator<OOP, Session> Creator;
+
+        oodles::Dispatcher dispatcher(1); // Sessions are never locked
+        LoadContext context;
+        const Creator creator(context);
+        oodles::net::Client client(dispatcher, creator);
+        deadline_timer timer(dispatcher.io_service());
+        struct timeval start;
+
+        for (int i = 0 ; i < crawlers ; ++i)
+            client.start(connect_to);
+
+        gettimeofday(&start, NULL);
+        timer.expires_from_now(seconds(duration));
+        timer.async_wait(bind(&report, boost::ref(dispatcher), start));
+        dispatcher.wait();
+    } catch (const std::exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,550 @@
+// oodles
+#include "sched/Scheduler.hpp"
+#include "net/oop/Messages.hpp"
+#include "utility/Clock.hpp"
+#include "utility/Dispatcher.hpp"
+#include "utility/Subscriber.hpp"
+#include "sched/DeferredUpdate.hpp"
+
+// Boost
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+// STL
+#include <map>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <tr1/unordered_map>
+
+// libc
+#include <math.h> // For exp(), log() and pow()
+#include <stdlib.h> // For atoi()
+#include <unistd.h> // For sysconf()
+#include <sys/time.h> // For gettimeofday()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ifstream;
+using std::ostringstream;
+
+// Containers
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+using std::make_pair;
+
+// STL algorithm
+using std::sort;
+using std::upper_bound;
+
+// STL exception
+using std::exception;
+
+// Boost
+using boost::mutex;
+using boost::lock_guard;
+
+// oodles
+using oodles::Dispatcher;
+using oodles::ManualClock;
+using oodles::url::URL;
+using oodles::sched::Crawler;
+using oodles::sched::Deferable;
+using oodles::sched::Scheduler;
+using oodles::net::oop::EndCrawl;
+
+namespace {
+
+const uint64_t START = 1300000000000ULL; // Simulated time begins, in ms
+const double DAY = 86400;
+
+/*
+ * xorshift64* - small, fast and identical on every platform so the same
+ * seed always simulates the same web.
+ */
+class Random
+{
+    public:
+        Random(uint64_t seed) : state(seed ? seed : 1) {}
+
+        uint64_t next()
+        {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+
+            return state * 2685821657736338717ULL;
+        }
+
+        double uniform() // [0, 1)
+        {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        double exponential(double rate)
+        {
+            return -log(1.0 - uniform()) / rate;
+        }
+    private:
+        uint64_t state;
+};
+
+/*
+ * A synthetic web of pages spread across hosts whose sizes follow a power
+ * law. Every page has a fan-out of links drawn from a Pareto distribution
+ * (mostly to the same host, otherwise biased to the larger hosts) and a
+ * rate of change between once an hour and once a month, or almost never.
+ * Links and rates are derived from the page no. on demand, not stored.
+ */
+class WebGraph
+{
+    public:
+        WebGraph(uint32_t pages, uint32_t hosts, uint64_t seed);
+
+        uint32_t size() const { return first.back(); }
+        uint32_t hosts() const { return first.size() - 1; }
+        uint32_t home_page(uint32_t host) const { return first[host]; }
+
+        string url(uint32_t page) const;
+        double change_rate(uint32_t page) const;
+        void links(uint32_t page, vector<uint32_t> &targets) const;
+    private:
+        uint64_t seed;
+        vector<uint32_t> first; // First page of each host (and the end)
+
+        uint32_t host_of(uint32_t page) const
+        {
+            return upper_bound(first.begin(), first.end(), page) -
+                   first.begin() - 1;
+        }
+
+        Random random(uint32_t page, uint64_t salt) const
+        {
+            return Random((seed ^ salt) + page * 0x9E3779B97F4A7C15ULL);
+        }
+};
+
+WebGraph::WebGraph(uint32_t pages, uint32_t hosts, uint64_t seed) :
+    seed(seed)
+{
+    vector<double> weight(hosts);
+    double total = 0;
+
+    for (uint32_t i = 0 ; i < hosts ; ++i)
+        total += (weight[i] = 1.0 / pow(i + 1.0, 0.8));
+
+    /*
+     * Every host has its home page, the remainder are shared by weight
+     */
+    const uint32_t spare = pages > hosts ? pages - hosts : 0;
+    uint32_t next = 0;
+
+    first.reserve(hosts + 1);
+
+    for (uint32_t i = 0 ; i < hosts ; ++i) {
+        first.push_back(next);
+        next += 1 + static_cast<uint32_t>(spare * weight[i] / total);
+    }
+
+    first.push_back(next);
+}
+
+string
+WebGraph::url(uint32_t page) const
+{
+    const uint32_t host = host_of(page), n = page - first[host];
+    ostringstream s;
+
+    s << "http://www.host" << host << ".com/";
+
+    if (n > 0)
+        s << "section" << n % 16 << "/page" << n << ".html";
+
+    return s.str();
+}
+
+double
+WebGraph::change_rate(uint32_t page) const
+{
+    Random r(random(page, 0xC4A9E));
+    static const double lowest = log(1 / (30 * DAY)), highest = log(1 / 3600.0);
+
+    if (r.uniform() < 0.2)
+        return 1 / (365 * DAY); // Static
+
+    return exp(lowest + r.uniform() * (highest - lowest));
+}
+
+void
+WebGraph::links(uint32_t page, vector<uint32_t> &targets) const
+{
+    Random r(random(page, 0x11AC5));
+    const uint32_t host = host_of(page),
+                   pages = first[host + 1] - first[host],
+                   n = static_cast<uint32_t>(2 / pow(1 - r.uniform(), 1 / 1.5));
+
+    targets.clear();
+
+    for (uint32_t i = 0 ; i < n && i < 200 ; ++i) {
+        const double u = r.uniform(), v = r.uniform();
+
+        if (u < 0.7) // Within the host, biased to its upper pages
+            targets.push_back(first[host] +
+                              static_cast<uint32_t>(pages * v * v));
+        else // Elsewhere, biased to the larger hosts
+            targets.push_back(static_cast<uint32_t>(size() * v * v * v));
+    }
+}
+
+/*
+ * State of a page on the simulated web, as far as freshness is concerned
+ */
+struct Page
+{
+    bool discovered, crawled;
+    uint32_t stale_at; // Seconds since START of the first change since crawled
+
+    Page() : discovered(false), crawled(false), stale_at(0) {}
+};
+
+/*
+ * A Crawler without a network session. The pages of each work unit are
+ * noted on begin_crawl() so they can be crawled between runs.
+ */
+class SimulatedCrawler : public Crawler
+{
+    public:
+        SimulatedCrawler(const string &name, vector<URL::hash_t> &crawling) :
+            Crawler(name, 8),
+            crawling(crawling)
+        {}
+
+        void begin_crawl()
+        {
+            for (size_t i = 0 ; i < work_unit.size() ; ++i)
+                crawling.push_back(work_unit[i]->page->id);
+        }
+    private:
+        bool offline() const { return false; }
+
+        vector<URL::hash_t> &crawling;
+};
+
+/*
+ * Frees each EndCrawl once the DeferredUpdate is done with it, as the
+ * scheduler's Session does.
+ */
+class GarbageCollector : public oodles::event::Subscriber
+{
+    public:
+        ~GarbageCollector()
+        {
+            typedef map<Deferable::key_t, EndCrawl*>::iterator iterator;
+
+            for (iterator i = garbage.begin() ; i != garbage.end() ; ++i)
+                delete i->second;
+        }
+
+        void receive(const oodles::event::Event::Ref e)
+        {
+            const oodles::sched::Update &u = *e;
+            const lock_guard<mutex> lock(guard);
+            map<Deferable::key_t, EndCrawl*>::iterator i = garbage.find(u.key);
+
+            delete i->second;
+            garbage.erase(i);
+        }
+
+        void trash(EndCrawl *m, Deferable::key_t k)
+        {
+            const lock_guard<mutex> lock(guard);
+            garbage[k] = m;
+        }
+    private:
+        mutex guard;
+        map<Deferable::key_t, EndCrawl*> garbage;
+};
+
+struct Statistics
+{
+    vector<double> runs; // Time of each scheduling run
+    double scheduling, updating; // Total time spent in each
+    uint64_t assigned, refetched, changed;
+    double freshness; // Sum over every run
+
+    Statistics() :
+        scheduling(0),
+        updating(0),
+        assigned(0),
+        refetched(0),
+        changed(0),
+        freshness(0)
+    {}
+};
+
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+size_t
+resident()
+{
+    size_t pages = 0, rss = 0;
+    ifstream statm("/proc/self/statm");
+
+    statm >> pages >> rss;
+
+    return rss * sysconf(_SC_PAGESIZE);
+}
+
+double
+percentile(const vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+/*
+ * The simulation proper. Each round is a scheduling run followed, interval
+ * seconds later, by every page handed out having been crawled and reported
+ * through a DeferredUpdate.
+ */
+class Simulation
+{
+    public:
+        Simulation(const WebGraph &g,
+                   Scheduler &s,
+                   ManualClock &c,
+                   GarbageCollector &gc) :
+            graph(g),
+            scheduler(s),
+            clock(c),
+            garbage(gc),
+            random(42),
+            web(g.size())
+        {
+            ids.rehash(g.size());
+        }
+
+        void seed();
+        void round(uint32_t interval, Statistics &stats);
+
+        vector<URL::hash_t> crawling; // Page IDs handed out by the last run
+    private:
+        const WebGraph &graph;
+        Scheduler &scheduler;
+        ManualClock &clock;
+        GarbageCollector &garbage;
+        Random random;
+        vector<Page> web;
+        std::tr1::unordered_map<URL::hash_t, uint32_t> ids; // To page no.
+
+        void discover(uint32_t page, EndCrawl *m);
+        double freshness(uint32_t now) const;
+};
+
+void
+Simulation::seed()
+{
+    for (uint32_t i = 0 ; i < graph.hosts() ; ++i) {
+        const uint32_t page = graph.home_page(i);
+
+        web[page].discovered = true;
+        ids[scheduler.schedule_from_seed(graph.url(page))] = page;
+    }
+}
+
+void
+Simulation::round(uint32_t interval, Statistics &stats)
+{
+    struct timeval start;
+
+    gettimeofday(&start, NULL);
+    stats.assigned += scheduler.run();
+    stats.runs.push_back(elapsed(start));
+    stats.scheduling += stats.runs.back();
+
+    clock.advance(interval * 1000ULL); // The crawl takes place
+
+    const uint32_t now = (clock.milliseconds() - START) / 1000;
+    EndCrawl *m = new EndCrawl;
+
+    for (size_t i = 0 ; i < crawling.size() ; ++i) {
+        const uint32_t page = ids[crawling[i]];
+        Page &p = web[page];
+        EndCrawl::Result result = EndCrawl::Changed;
+
+        if (p.crawled) {
+            ++stats.refetched;
+
+            if (now >= p.stale_at)
+                ++stats.changed;
+            else
+                result = EndCrawl::Unchanged;
+        } else {
+            p.crawled = true;
+            discover(page, m); // Its links are only followed once
+        }
+
+        p.stale_at = now + static_cast<uint32_t>(
+                           random.exponential(graph.change_rate(page)));
+        m->scheduled_urls.push_back(make_pair(crawling[i], result));
+    }
+
+    crawling.clear();
+
+    const Deferable::key_t key = reinterpret_cast<Deferable::key_t>(m);
+    const Deferable update = {key,
+                               m->new_urls,
+                               m->scheduled_urls,
+                               m->response_times,
+                               NULL};
+
+    garbage.trash(m, key);
+    scheduler.defer_update(update, garbage);
+
+    gettimeofday(&start, NULL);
+    scheduler.update_schedule();
+    stats.updating += elapsed(start);
+    stats.freshness += freshness(now);
+}
+
+void
+Simulation::discover(uint32_t page, EndCrawl *m)
+{
+    vector<uint32_t> targets;
+
+    graph.links(page, targets);
+
+    for (size_t i = 0 ; i < targets.size() ; ++i) {
+        Page &p = web[targets[i]];
+        const string url(graph.url(targets[i]));
+
+        if (!p.discovered) {
+            p.discovered = true;
+            ids[URL(url).page_id()] = targets[i];
+        }
+
+        m->new_urls.push_back(make_pair(url, false));
+    }
+}
+
+/*
+ * The fraction of the discovered pages whose latest crawl is still current
+ */
+double
+Simulation::freshness(uint32_t now) const
+{
+    size_t discovered = 0, fresh = 0;
+
+    for (size_t i = 0 ; i < web.size() ; i += 1 + web.size() / 100000) {
+        const Page &p = web[i];
+
+        if (p.discovered) {
+            ++discovered;
+
+            if (p.crawled && now < p.stale_at)
+                ++fresh;
+        }
+    }
+
+    return discovered ? static_cast<double>(fresh) / discovered : 0;
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program
+         << " [pages] [hosts] [crawlers] [rounds] [interval (seconds)]\n";
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    if (argc > 6) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const uint32_t pages = argc > 1 ? atoi(argv[1]) : 200000,
+                   hosts = argc > 2 ? atoi(argv[2]) : 2000,
+                   crawlers = argc > 3 ? atoi(argv[3]) : 16,
+                   rounds = argc > 4 ? atoi(argv[4]) : 200,
+                   interval = argc > 5 ? atoi(argv[5]) : 60;
+
+    if (pages == 0 || hosts == 0 || crawlers == 0 || hosts > pages) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        const WebGraph graph(pages, hosts, 1);
+        ManualClock clock(START);
+        GarbageCollector garbage; // Outlives the Dispatcher posting to it
+        Dispatcher dispatcher(1);
+        Scheduler scheduler(&dispatcher);
+        Simulation simulation(graph, scheduler, clock, garbage);
+        vector<SimulatedCrawler> pool;
+        Statistics stats;
+
+        scheduler.set_clock(clock);
+        pool.reserve(crawlers);
+
+        for (uint32_t i = 0 ; i < crawlers ; ++i) {
+            ostringstream name;
+            name << "crawler" << i;
+            pool.push_back(SimulatedCrawler(name.str(), simulation.crawling));
+        }
+
+        for (uint32_t i = 0 ; i < crawlers ; ++i)
+            scheduler.register_crawler(pool[i]);
+
+        const size_t baseline = resident();
+
+        simulation.seed();
+
+        for (uint32_t i = 0 ; i < rounds ; ++i)
+            simulation.round(interval, stats);
+
+        const size_t known = scheduler.pages();
+        vector<double> &runs = stats.runs;
+
+        sort(runs.begin(), runs.end());
+
+        cout << rounds << " runs, " << interval << "s apart, over "
+             << graph.size() << " pages on " << hosts << " hosts with "
+             << crawlers << " crawlers:\n"
+             << "\tDiscovered:  " << known << " URLs, "
+             << (resident() - baseline) / (known ? known : 1)
+             << " bytes/URL resident\n"
+             << "\tScheduled:   " << stats.assigned << " URLs at "
+             << stats.assigned / stats.scheduling << " URLs/s ("
+             << stats.updating << "s updating)\n"
+             << "\tRun latency: p50 " << percentile(runs, 0.5) * 1e3
+             << "ms, p90 " << percentile(runs, 0.9) * 1e3
+             << "ms, p99 " << percentile(runs, 0.99) * 1e3
+             << "ms, max " << percentile(runs, 1) * 1e3 << "ms\n"
+             << "\tFreshness:   " << stats.freshness / rounds
+             << " on average, " << stats.changed << " of " << stats.refetched
+             << " recrawls found a change\n";
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
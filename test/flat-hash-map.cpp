@@ -0,0 +1,270 @@
+// oodles
+#include "utility/hash.hpp"
+#include "utility/FlatHashMap.hpp"
+
+// STL
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <tr1/unordered_map>
+
+// libc
+#include <stdlib.h> // For atoi(), rand()
+#include <sys/time.h> // For gettimeofday()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::string;
+using std::vector;
+using std::make_pair;
+using std::tr1::unordered_map;
+
+// STL algorithm
+using std::random_shuffle;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::FlatHashMap;
+
+namespace {
+
+#ifdef HAS_64_BITS
+typedef uint64_t hash_t; // As URL::hash_t
+#else
+typedef uint32_t hash_t;
+#endif
+
+struct hash_id
+{
+    size_t operator() (hash_t h) const { return h; }
+};
+
+size_t allocated = 0; // Bytes held through Counter
+
+/*
+ * Counts the bytes held by the containers using it
+ */
+template<class T>
+struct Counter : public std::allocator<T>
+{
+    template<class U> struct rebind { typedef Counter<U> other; };
+
+    Counter() {}
+    template<class U> Counter(const Counter<U>&) {}
+
+    T* allocate(size_t n, const void *hint = 0)
+    {
+        allocated += n * sizeof(T);
+        return std::allocator<T>::allocate(n, hint);
+    }
+
+    void deallocate(T *p, size_t n)
+    {
+        allocated -= n * sizeof(T);
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+typedef FlatHashMap<hash_t, void*, hash_id> Flat;
+typedef unordered_map<hash_t,
+                      void*,
+                      hash_id,
+                      std::equal_to<hash_t>,
+                      Counter<std::pair<const hash_t, void*> > > Map;
+
+/*
+ * Keys as the Scheduler sees them; FNV hashes of URLs
+ */
+hash_t
+page_id(uint32_t i)
+{
+    ostringstream s;
+    s << "http://www.example.com/wiki/page" << i << ".html";
+
+    const string url(s.str());
+
+#ifdef HAS_64_BITS
+    return oodles::fnv64(url.data(), url.size());
+#else
+    return oodles::fnv32(url.data(), url.size());
+#endif
+}
+
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+/*
+ * Insert, find and erase keys at random in both tables; they must agree
+ */
+bool
+test_against_map(uint32_t operations)
+{
+    Flat flat;
+    Map map;
+
+    srand(1);
+
+    for (uint32_t i = 0 ; i < operations ; ++i) {
+        const hash_t k = page_id(rand() % (operations / 4 + 1));
+        void *v = reinterpret_cast<void*>(static_cast<size_t>(i + 1));
+        void *const *found = flat.find(k);
+        const Map::iterator j = map.find(k);
+
+        if ((found == NULL) != (j == map.end()))
+            return false;
+
+        if (found && *found != j->second)
+            return false;
+
+        switch (rand() % 3) {
+            case 0:
+            case 1:
+                if (flat.insert(k, v) != map.insert(make_pair(k, v)).second)
+                    return false;
+                break;
+            case 2:
+                if (flat.erase(k) != (map.erase(k) == 1))
+                    return false;
+                break;
+        }
+
+        if (flat.size() != map.size())
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * The operations benchmarked, in terms of each table's own API
+ */
+void
+insert(Map &m, hash_t k)
+{
+    m.insert(make_pair(k, static_cast<void*>(NULL)));
+}
+
+void
+insert(Flat &f, hash_t k)
+{
+    f.insert(k, NULL);
+}
+
+bool
+found(const Map &m, hash_t k)
+{
+    return m.find(k) != m.end();
+}
+
+bool
+found(const Flat &f, hash_t k)
+{
+    return f.find(k) != NULL;
+}
+
+size_t
+memory(const Map &m)
+{
+    return sizeof(m) + allocated; // Buckets and a node per entry
+}
+
+size_t
+memory(const Flat &f)
+{
+    return f.memory();
+}
+
+/*
+ * Time n inserts, lookups (of present and absent keys, in another order)
+ * and erasures, noting the memory held by the table once full. Malloc's
+ * own overhead on each node of the map is not counted.
+ */
+template<class Table>
+void
+benchmark(const char *name, const vector<hash_t> &keys,
+          const vector<hash_t> &lookups)
+{
+    const size_t n = keys.size() / 2;
+    Table *t = new Table;
+    struct timeval start;
+    size_t hits = 0;
+
+    gettimeofday(&start, NULL);
+
+    for (size_t i = 0 ; i < n ; ++i)
+        insert(*t, keys[i]);
+
+    const double inserting = elapsed(start);
+    const size_t bytes = memory(*t);
+
+    gettimeofday(&start, NULL);
+
+    for (size_t i = 0 ; i < lookups.size() ; ++i)
+        hits += found(*t, lookups[i]);
+
+    const double finding = elapsed(start);
+
+    gettimeofday(&start, NULL);
+
+    for (size_t i = 0 ; i < n ; ++i)
+        t->erase(keys[i]);
+
+    const double erasing = elapsed(start);
+
+    delete t;
+
+    cout << '\t' << name << ": " << bytes / n << " bytes/entry, insert "
+         << n / inserting / 1e6 << "M/s, find " << keys.size() / finding / 1e6
+         << "M/s (" << hits << " hits), erase " << n / erasing / 1e6
+         << "M/s\n";
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    const uint32_t n = argc > 1 ? atoi(argv[1]) : 2000000;
+
+    try {
+        if (!test_against_map(1000000)) {
+            cerr << "Flat hash map disagreed with unordered_map" << endl;
+            return 1;
+        }
+
+        vector<hash_t> keys;
+
+        keys.reserve(n * 2);
+
+        for (uint32_t i = 0 ; i < n * 2 ; ++i)
+            keys.push_back(page_id(i)); // The second half are never inserted
+
+        vector<hash_t> lookups(keys);
+
+        random_shuffle(lookups.begin(), lookups.end());
+
+        cout << "Against unordered_map: passed\n" << n << " page ids:\n";
+
+        benchmark<Map>("unordered_map", keys, lookups);
+        benchmark<Flat>("FlatHashMap  ", keys, lookups);
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
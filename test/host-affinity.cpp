@@ -0,0 +1,212 @@
+// oodles
+#include "sched/Scheduler.hpp"
+
+// STL
+#include <map>
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::map;
+using std::string;
+using std::vector;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::url::URL;
+using oodles::sched::Crawler;
+using oodles::sched::Scheduler;
+
+namespace {
+
+typedef std::pair<URL::hash_t, const Crawler*> Crawl; // Page and Crawler
+
+/*
+ * A Crawler without a network session which may be taken offline. The
+ * pages of each work unit are noted on begin_crawl() so they can be
+ * completed.
+ */
+class SimulatedCrawler : public Crawler
+{
+    public:
+        SimulatedCrawler(const string &name,
+                         uint16_t cores,
+                         vector<Crawl> &crawled) :
+            Crawler(name, cores),
+            available(true),
+            crawled(crawled)
+        {}
+
+        void begin_crawl()
+        {
+            for (size_t i = 0 ; i < work_unit.size() ; ++i)
+                crawled.push_back(Crawl(work_unit[i]->page->id, this));
+        }
+
+        bool available;
+    private:
+        bool offline() const { return !available; }
+
+        vector<Crawl> &crawled;
+};
+
+typedef map<URL::hash_t, int> Domains; // Page to domain
+typedef map<int, const Crawler*> Placement; // Domain to Crawler
+
+string
+page_url(int i, int domains)
+{
+    ostringstream s;
+    s << "http://www.site" << i % domains << ".com/page" << i << ".html";
+    return s.str();
+}
+
+/*
+ * No. of domains placed on a different Crawler by to than by from
+ */
+int
+remapped(const Placement &from, const Placement &to)
+{
+    int n = 0;
+
+    for (Placement::const_iterator i = to.begin() ; i != to.end() ; ++i) {
+        const Placement::const_iterator j = from.find(i->first);
+
+        if (j != from.end() && j->second != i->second)
+            ++n;
+    }
+
+    return n;
+}
+
+/*
+ * Perform rounds runs, completing every page between runs. Each domain is
+ * sent one URL a run; placement is left with the Crawlers of the last run
+ * and churn counts the domains that moved between runs.
+ */
+uint32_t
+schedule(Scheduler &s,
+         vector<Crawl> &crawled,
+         const Domains &domains,
+         Placement &placement,
+         int rounds,
+         int &churn)
+{
+    uint32_t assigned = 0;
+
+    churn = 0;
+
+    for (int i = 0 ; i < rounds ; ++i) {
+        Placement p;
+
+        assigned += s.run();
+
+        for (size_t j = 0 ; j < crawled.size() ; ++j) {
+            const Crawl &c = crawled[j];
+
+            p[domains.find(c.first)->second] = c.second;
+            s.update_node(c.first, time(NULL));
+        }
+
+        if (i > 0)
+            churn += remapped(placement, p);
+
+        placement.swap(p);
+        crawled.clear();
+    }
+
+    return assigned;
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program << " [pages] [domains] [crawlers] [rounds]\n";
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    if (argc > 5) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int pages = argc > 1 ? atoi(argv[1]) : 20000,
+              domains = argc > 2 ? atoi(argv[2]) : 500,
+              crawlers = argc > 3 ? atoi(argv[3]) : 8,
+              rounds = argc > 4 ? atoi(argv[4]) : 10;
+
+    try {
+        Scheduler s;
+        Domains domain;
+        vector<Crawl> crawled;
+        vector<SimulatedCrawler> pool;
+
+        s.set_host_affinity(true);
+        s.politeness().set_delay(0, 0); // Every host is ready every round
+
+        for (int i = 0 ; i < pages ; ++i)
+            domain[s.schedule_from_seed(page_url(i, domains))] = i % domains;
+
+        pool.reserve(crawlers);
+
+        for (int i = 0 ; i < crawlers ; ++i) {
+            ostringstream name;
+            name << "crawler" << i;
+            pool.push_back(SimulatedCrawler(name.str(), 1 + i % 4, crawled));
+        }
+
+        for (int i = 0 ; i < crawlers ; ++i)
+            s.register_crawler(pool[i]);
+
+        Placement before, after;
+        int x = 0, y = 0;
+        const uint32_t a = schedule(s, crawled, domain, before, rounds, x);
+
+        pool[0].available = false; // Its domains must move, few others
+
+        const uint32_t b = schedule(s, crawled, domain, after, rounds, y);
+        int orphaned = 0;
+
+        for (Placement::iterator i = before.begin() ; i != before.end() ; ++i)
+            if (i->second == &pool[0])
+                ++orphaned;
+
+        for (Placement::iterator i = after.begin() ; i != after.end() ; ++i) {
+            if (i->second == &pool[0]) {
+                cerr << "URLs were assigned to an offline crawler!\n";
+                return 1;
+            }
+        }
+
+        const int moved = remapped(before, after) - orphaned;
+
+        cout << rounds << " runs over " << pages << " pages, " << domains
+             << " domains and " << crawlers << " crawlers:\n"
+             << "\tAll online:  " << a << " URLs, " << x
+             << " domains moved between runs\n"
+             << "\tOne offline: " << b << " URLs, " << y
+             << " domains moved between runs\n"
+             << "\tGoing offline moved the " << orphaned << " domains of the "
+             << "crawler and " << moved << " others\n";
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
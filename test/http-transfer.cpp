@@ -266,7 +266,7 @@ int main(int argc, char *argv[])
                 const oodles::url::URL url(argv[i]);
 
                 if (!url.port().empty())
-                    port = url.port();
+                    port = url.port().str();
 
                 const Item item(url.host() + ":" + port, empty);
                 const pair<Iterator, bool> entry(requests.insert(item));
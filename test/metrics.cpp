@@ -0,0 +1,214 @@
+// oodles
+#include "utility/Metrics.hpp"
+#include "common/Exceptions.hpp"
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+// STL
+#include <string>
+#include <sstream>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+#include <sys/time.h> // For gettimeofday()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::string;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::metrics::Gauge;
+using oodles::metrics::Counter;
+using oodles::metrics::Registry;
+using oodles::metrics::Histogram;
+using oodles::metrics::labelled;
+
+namespace {
+
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+void
+add_many(Counter &c, Histogram &h, int n)
+{
+    for (int i = 0 ; i < n ; ++i) {
+        c.add();
+        h.record(i);
+    }
+}
+
+/*
+ * Updates from several threads at once are all counted, and cost little
+ */
+bool
+test_sharding(int threads, int n)
+{
+    Registry r;
+    Counter &c = r.counter("adds_total", "Adds");
+    Histogram &h = r.histogram("values", "Values");
+    boost::thread_group group;
+    struct timeval start;
+
+    gettimeofday(&start, NULL);
+
+    for (int i = 0 ; i < threads ; ++i)
+        group.create_thread(boost::bind(&add_many,
+                                        boost::ref(c),
+                                        boost::ref(h),
+                                        n));
+
+    group.join_all();
+
+    const double t = elapsed(start);
+    const uint64_t expected = static_cast<uint64_t>(threads) * n;
+
+    cout << "\t" << expected << " updates from " << threads << " threads in "
+         << t << "s (" << t / expected * 1e9 << "ns each)\n";
+
+    if (c.value() != expected || h.count() != expected) {
+        cerr << "Counted " << c.value() << " and recorded " << h.count()
+             << " of " << expected << " updates" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Every value falls in a bucket no wider than 1/Sub of its lowest value,
+ * and the quantiles of a uniform spread are known as closely
+ */
+bool
+test_histogram(int n)
+{
+    Histogram h("h", "");
+
+    for (uint64_t v = 0 ; v < 1000000 ; v = v * 9 / 8 + 1) {
+        const size_t b = Histogram::bucket(v);
+        const uint64_t l = Histogram::lowest(b), u = Histogram::highest(b);
+
+        if (v < l || v > u || (u - l) * Histogram::Sub > l) {
+            cerr << v << " in bucket " << b << " of [" << l << ", " << u
+                 << "]" << endl;
+            return false;
+        }
+    }
+
+    if (Histogram::bucket(~static_cast<uint64_t>(0)) != Histogram::Buckets - 1)
+    {
+        cerr << "The largest value is not in the last bucket" << endl;
+        return false;
+    }
+
+    for (int i = 1 ; i <= n ; ++i)
+        h.record(i);
+
+    const double qs[] = {0.5, 0.9, 0.99};
+
+    for (size_t i = 0 ; i < sizeof(qs) / sizeof(qs[0]) ; ++i) {
+        const double q = h.quantile(qs[i]), exact = qs[i] * n;
+
+        if (q < exact || q > exact * (1 + 1.0 / Histogram::Sub)) {
+            cerr << "Quantile " << qs[i] << " given as " << q << " not "
+                 << exact << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * The metrics of a family are written together, under one HELP and TYPE
+ */
+bool
+test_registry()
+{
+    Registry r;
+    ostringstream text, json;
+    Gauge &a = r.gauge(labelled("assigned", "crawler", "a"), "Assigned");
+    Gauge &b = r.gauge(labelled("assigned", "crawler", "b"), "Assigned");
+
+    r.counter("assigned_total", "All assigned").add(5);
+    a.set(3);
+    b.set(4);
+    b.add(-1.5);
+
+    if (&r.gauge(labelled("assigned", "crawler", "a"), "") != &a) {
+        cerr << "A metric was created twice" << endl;
+        return false;
+    }
+
+    try {
+        r.counter("assigned_total", "").add();
+        r.gauge("assigned_total", "");
+        cerr << "A counter was found as a gauge" << endl;
+        return false;
+    } catch (const oodles::TypeError&) {
+    }
+
+    r.write_text(text);
+    r.write_json(json);
+
+    const string expected_text("# HELP assigned Assigned\n"
+                               "# TYPE assigned gauge\n"
+                               "assigned{crawler=\"a\"} 3\n"
+                               "assigned{crawler=\"b\"} 2.5\n"
+                               "# HELP assigned_total All assigned\n"
+                               "# TYPE assigned_total counter\n"
+                               "assigned_total 6\n"),
+                 expected_json("{\n"
+                               "  \"assigned{crawler=\\\"a\\\"}\": 3,\n"
+                               "  \"assigned{crawler=\\\"b\\\"}\": 2.5,\n"
+                               "  \"assigned_total\": 6\n"
+                               "}\n");
+
+    if (text.str() != expected_text || json.str() != expected_json) {
+        cerr << "Written as:\n" << text.str() << json.str() << endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    const int threads = argc > 1 ? atoi(argv[1]) : 4,
+              n = argc > 2 ? atoi(argv[2]) : 1000000;
+    bool passed = false;
+
+    try {
+        const bool sharding = test_sharding(threads, n),
+                   histogram = test_histogram(n),
+                   registry = test_registry();
+
+        cout << "Sharding:  " << (sharding ? "passed" : "failed") << '\n'
+             << "Histogram: " << (histogram ? "passed" : "failed") << '\n'
+             << "Registry:  " << (registry ? "passed" : "failed") << endl;
+
+        passed = sharding && histogram && registry;
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+    }
+
+    return passed ? 0 : 1;
+}
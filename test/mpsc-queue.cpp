@@ -0,0 +1,133 @@
+// oodles
+#include "utility/MPSCQueue.hpp"
+
+// Boost
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+// STL
+#include <vector>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+#include <sys/time.h> // For gettimeofday()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// Containers
+using std::vector;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::MPSCQueue;
+
+namespace {
+
+struct Item
+{
+    Item *next;
+    int producer, sequence;
+};
+
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+void
+produce(MPSCQueue<Item> &q, Item *items, int n)
+{
+    for (int i = 0 ; i < n ; ++i)
+        q.push(items + i);
+}
+
+/*
+ * Every item pushed by several threads is drained, whilst they push, once
+ * and in the order each thread pushed them
+ */
+bool
+test_drain(int threads, int n)
+{
+    MPSCQueue<Item> q;
+    vector<Item> items(static_cast<size_t>(threads) * n);
+    vector<int> expected(threads, 0); // Next sequence of each producer
+    boost::thread_group group;
+    struct timeval start;
+    size_t drained = 0, batches = 0;
+
+    for (size_t i = 0 ; i < items.size() ; ++i) {
+        items[i].producer = i / n;
+        items[i].sequence = i % n;
+    }
+
+    gettimeofday(&start, NULL);
+
+    for (int i = 0 ; i < threads ; ++i)
+        group.create_thread(boost::bind(&produce,
+                                        boost::ref(q),
+                                        &items[static_cast<size_t>(i) * n],
+                                        n));
+
+    while (drained < items.size()) {
+        size_t m = 0;
+
+        for (Item *i = q.drain(m) ; i ; i = i->next) {
+            if (i->sequence != expected[i->producer]++) {
+                cerr << "Drained " << i->sequence << " of producer "
+                     << i->producer << " out of order" << endl;
+                group.join_all();
+                return false;
+            }
+        }
+
+        if (m > 0)
+            ++batches;
+
+        drained += m;
+    }
+
+    group.join_all();
+
+    const double t = elapsed(start);
+
+    cout << "\t" << drained << " items from " << threads << " threads in "
+         << batches << " batches, " << t / drained * 1e9 << "ns each\n";
+
+    size_t m = 0;
+
+    if (q.drain(m) || m != 0 || q.size() != 0 || !q.empty()) {
+        cerr << "Items were left once all were drained" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    const int threads = argc > 1 ? atoi(argv[1]) : 4,
+              n = argc > 2 ? atoi(argv[2]) : 1000000;
+    bool passed = false;
+
+    try {
+        passed = test_drain(threads, n);
+
+        cout << "Drain: " << (passed ? "passed" : "failed") << endl;
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+    }
+
+    return passed ? 0 : 1;
+}
@@ -1,9 +1,11 @@
 // oodles
 #include "url/URL.hpp"
 #include "utility/Linker.hpp"
+#include "utility/file-ops.hpp"
 #include "common/Exceptions.hpp"
 #include "utility/Dispatcher.hpp"
 
+#include "net/oop/Factory.hpp"
 #include "net/oop/Session.hpp"
 #include "net/oop/Protocol.hpp"
 #include "net/oop/Messages.hpp"
@@ -14,10 +16,12 @@
 
 // STL
 #include <string>
+#include <vector>
 #include <iostream>
 
 // libc
 #include <getopt.h>
+#include <sys/time.h> // For gettimeofday()
 
 // STL
 using std::list;
@@ -25,29 +29,31 @@ using std::cout;
 using std::cerr;
 using std::endl;
 using std::string;
+using std::vector;
 using std::make_pair;
 
+// oodles
+using oodles::url::URL;
+using oodles::net::oop::Message;
+using oodles::net::oop::Factory;
+using oodles::net::oop::EndCrawl;
+using oodles::net::oop::BeginCrawl;
+
 namespace {
 
 /*
- * Find a value but dereference the pointer as well as the iterator
+ * Whether url is among those of any host of m
  */
-template<typename Iterator, typename Type> struct find
+bool
+find(const BeginCrawl &m, const URL &url)
 {
-    find() {}
-
-    bool operator() (Iterator i, Iterator j, const Type &value) const
-    {
-        while (i != j) {
-            if (*(*i) == value)
+    for (size_t i = 0 ; i < m.hosts.size() ; ++i)
+        for (size_t j = 0 ; j < m.hosts[i].size() ; ++j)
+            if (m.hosts[i][j] == url)
                 return true;
 
-            ++i;
-        }
-
-        return false;
-    }
-};
+    return false;
+}
 
 class Session : public oodles::net::oop::Session
 {
@@ -61,7 +67,8 @@ class Session : public oodles::net::oop::Session
 struct ClientContext : public oodles::net::CallerContext, public oodles::Linker
 {
     size_t limit;
-    ClientContext() : limit(0) {}
+    Message::Format format;
+    ClientContext() : limit(0), format(Message::Binary) {}
     
     inline void start(oodles::net::SessionHandler &s)
     {
@@ -77,6 +84,7 @@ struct ClientContext : public oodles::net::CallerContext, public oodles::Linker
         m->name = "tarantula";
         m->cores = 8;
 
+        s.set_format(format); // The server answers in kind
         s.push_message(m);
     }
 };
@@ -132,9 +140,9 @@ Session::handle_message(oodles::net::oop::Message *m)
             assert(r.name == "tarantula");
             assert(r.cores == 8);
             
-            s->urls.push_back(&a);
-            s->urls.push_back(&y);
-            s->urls.push_back(&f);
+            s->add(a);
+            s->add(y);
+            s->add(f);
             
             push_message(s);
             }
@@ -143,18 +151,19 @@ Session::handle_message(oodles::net::oop::Message *m)
             {
             EndCrawl *s = new EndCrawl; // send
             BeginCrawl &r = static_cast<BeginCrawl&>(*m); // recv
-            list<URL*>::const_iterator begin(r.urls.begin()),
-                                           end(r.urls.end());
-            static const find<list<URL*>::const_iterator, URL> finder;
-
-            assert(r.urls.size() == 3);
-            assert(finder(begin, end, a));
-            assert(finder(begin, end, y));
-            assert(finder(begin, end, f));
+
+            assert(r.count() == 3);
+            assert(find(r, a));
+            assert(find(r, y));
+            assert(find(r, f));
             
-            s->scheduled_urls.push_back(make_pair(a.page_id(), true));
-            s->scheduled_urls.push_back(make_pair(y.page_id(), true));
-            s->scheduled_urls.push_back(make_pair(f.page_id(), true));
+            s->scheduled_urls.push_back(make_pair(a.page_id(),
+                                                  EndCrawl::Changed));
+            s->scheduled_urls.push_back(make_pair(y.page_id(),
+                                                  EndCrawl::Unchanged));
+            s->scheduled_urls.push_back(make_pair(f.page_id(),
+                                                  EndCrawl::Failed));
+            s->response_times.push_back(make_pair(a.page_id(), 120U));
 
             push_message(s);
             ++counter;
@@ -166,11 +175,13 @@ Session::handle_message(oodles::net::oop::Message *m)
             EndCrawl &r = static_cast<EndCrawl&>(*m); // recv
 
             assert(r.scheduled_urls.size() == 3);
+            assert(r.scheduled_urls.front().second == EndCrawl::Changed);
+            assert(r.scheduled_urls.back().second == EndCrawl::Failed);
             assert(r.new_urls.empty());
             
-            s->urls.push_back(&a);
-            s->urls.push_back(&y);
-            s->urls.push_back(&f);
+            s->add(a);
+            s->add(y);
+            s->add(f);
             
             push_message(s);
             ++counter;
@@ -189,14 +200,208 @@ Session::handle_message(oodles::net::oop::Message *m)
     delete m;
 }
 
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+/*
+ * The bytes a peer receives for m, sent in format f
+ */
+string
+encode(Message &m, Message::Format f)
+{
+    m.deconstruct(f);
+
+    string wire(m.size(), '\0');
+    m.to_buffer(&wire[0], wire.size());
+
+    return wire;
+}
+
+/*
+ * The message a peer reconstructs from the bytes it received
+ */
+Message*
+decode(const string &wire)
+{
+    const Message::Header h(Message::buffer2header(wire.data()));
+    Message *m = Factory::instance().create(h);
+
+    m->from_buffer(wire.data() + h.header_size, wire.size() - h.header_size);
+    m->reconstruct();
+
+    return m;
+}
+
+bool
+same(const BeginCrawl &a, const BeginCrawl &b)
+{
+    if (a.hosts.size() != b.hosts.size())
+        return false;
+
+    for (size_t i = 0 ; i < a.hosts.size() ; ++i) {
+        if (a.hosts[i].size() != b.hosts[i].size())
+            return false;
+
+        for (size_t j = 0 ; j < a.hosts[i].size() ; ++j) {
+            const URL &x = a.hosts[i][j], &y = b.hosts[i][j];
+
+            if (x != y || x.path_id() != y.path_id() ||
+                x.domain_id() != y.domain_id() ||
+                x.to_string() != y.to_string())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Text carries no response times
+ */
+bool
+same(const EndCrawl &a, const EndCrawl &b)
+{
+    return a.new_urls == b.new_urls &&
+           a.scheduled_urls == b.scheduled_urls &&
+           (b.format() == Message::Text ||
+            a.response_times == b.response_times);
+}
+
+/*
+ * Every URL of the seed file is sent in a BeginCrawl, and reported on in
+ * an EndCrawl, rounds times in format f. Each is read back as it was
+ * sent; the bytes and the time taken for each are printed.
+ */
+bool
+benchmark(const vector<URL> &urls, size_t rounds, Message::Format f)
+{
+    BeginCrawl begin;
+    EndCrawl end;
+    size_t begin_bytes = 0, end_bytes = 0;
+    double encoding = 0, decoding = 0;
+    bool passed = true;
+
+    for (size_t i = 0 ; i < urls.size() ; ++i) {
+        const URL &u = urls[i];
+
+        begin.add(u);
+        end.scheduled_urls.push_back(
+            make_pair(u.page_id(), static_cast<EndCrawl::Result>(i % 3)));
+        end.new_urls.push_back(make_pair(u.to_string(), i & 1));
+
+        if (i % 3)
+            end.response_times.push_back(make_pair(u.page_id(), 40 + i % 500));
+    }
+
+    for (size_t i = 0 ; i < rounds && passed ; ++i) {
+        BeginCrawl b(begin);
+        EndCrawl e(end);
+        struct timeval start;
+
+        gettimeofday(&start, NULL);
+
+        const string b_wire(encode(b, f)), e_wire(encode(e, f));
+
+        encoding += elapsed(start);
+        gettimeofday(&start, NULL);
+
+        Message *b_read = decode(b_wire), *e_read = decode(e_wire);
+
+        decoding += elapsed(start);
+
+        passed = b_read->format() == f &&
+                 same(begin, static_cast<BeginCrawl&>(*b_read)) &&
+                 same(end, static_cast<EndCrawl&>(*e_read));
+
+        begin_bytes = b_wire.size();
+        end_bytes = e_wire.size();
+
+        delete b_read;
+        delete e_read;
+    }
+
+    cout << '\t' << (f == Message::Binary ? "Binary" : "Text  ") << ": "
+         << begin_bytes << " + " << end_bytes << " bytes, encoded in "
+         << encoding / rounds * 1e6 << "us, decoded in "
+         << decoding / rounds * 1e6 << "us, for " << urls.size()
+         << " URLs of " << begin.hosts.size() << " hosts\n";
+
+    return passed;
+}
+
+/*
+ * A BeginCrawl counting more hosts than its body has bytes left is refused
+ */
+bool
+bounded()
+{
+    BeginCrawl b;
+    string wire(encode(b, Message::Binary)); // Its host count is last
+    bool refused = false;
+
+    wire[wire.size() - 1] = 0x7F;
+
+    const Message::Header h(Message::buffer2header(wire.data()));
+    Message *m = Factory::instance().create(h);
+
+    m->from_buffer(wire.data() + h.header_size, wire.size() - h.header_size);
+
+    try {
+        m->reconstruct();
+    } catch (const oodles::ReadError &e) {
+        refused = true;
+    }
+
+    delete m;
+
+    return refused;
+}
+
+/*
+ * Runs the benchmark over the URLs of a seed file in each format
+ */
+bool
+benchmark(const string &path, size_t rounds)
+{
+    string data;
+    vector<URL> urls;
+
+    oodles::read_file_data(path, data);
+
+    for (string::size_type b = 0, e = data.find('\n') ; e != string::npos ;
+         b = e + 1, e = data.find('\n', b))
+        urls.push_back(URL(data.substr(b, e - b)));
+
+    const bool text = benchmark(urls, rounds, Message::Text),
+               binary = benchmark(urls, rounds, Message::Binary),
+               counts = bounded();
+
+    cout << "Text:   " << (text ? "passed" : "failed") << '\n'
+         << "Binary: " << (binary ? "passed" : "failed") << '\n'
+         << "Counts: " << (counts ? "passed" : "failed") << endl;
+
+    return text && binary && counts;
+}
+
 } // anonymous
 
 static void print_usage(const char *program)
 {
-    cerr << program << " [-h|-c <host:port>|-s <ip:port>] [-l <limit>]\n\n";
+    cerr << program << " [-h|-c <host:port>|-s <ip:port>] [-l <limit>]"
+                       " [-w <binary|text>]\n"
+         << program << " -b <seed file> [-l <rounds>]\n\n";
 
     cerr << "Provide -c (or --client) and a host:port pair to run a client.\n";
     cerr << "Provide -s (or --server) and an ip:port pair to run a server.\n";
+    cerr << "Provide -w (or --wire) to choose the format the client sends.\n";
+    cerr << "Provide -b (or --bench) and a seed file to benchmark encoding\n"
+            "and decoding its URLs, in each format, without a network.\n";
 }
 
 int main(int argc, char *argv[])
@@ -206,13 +411,17 @@ int main(int argc, char *argv[])
     bool client_only = false,
          server_only = false;
     string listen_on("127.0.0.1:8888"),
-           connect_to("localhost:8888");
-    const char *short_options = "hl:c:s:";
-    const struct option long_options[5] = {
+           connect_to("localhost:8888"),
+           bench;
+    Message::Format format = Message::Binary;
+    const char *short_options = "hl:c:s:w:b:";
+    const struct option long_options[7] = {
         {"help", no_argument, NULL, short_options[0]},
         {"limit", required_argument, NULL, short_options[1]},
         {"client", required_argument, NULL, short_options[3]},
         {"server", required_argument, NULL, short_options[5]},
+        {"wire", required_argument, NULL, short_options[7]},
+        {"bench", required_argument, NULL, short_options[9]},
         {NULL, 0, NULL, 0}
     };
 
@@ -232,6 +441,17 @@ int main(int argc, char *argv[])
                 listen_on = optarg;
                 server_only = true;
                 break;
+            case 'w':
+                if (string(optarg) == "text") {
+                    format = Message::Text;
+                } else if (string(optarg) != "binary") {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'b':
+                bench = optarg;
+                break;
             default:
                 print_usage(argv[0]);
                 return 1;
@@ -241,6 +461,18 @@ int main(int argc, char *argv[])
     argc -= optind;
     argv += optind;
 
+    if (!bench.empty()) {
+        bool passed = false;
+
+        try {
+            passed = benchmark(bench, limit);
+        } catch (const std::exception &e) {
+            cerr << e.what() << endl;
+        }
+
+        return passed ? 0 : 1;
+    }
+
     try {
         typedef oodles::net::oop::Protocol OOP;
         typedef oodles::net::Creator<OOP, Session> Creator;
@@ -264,6 +496,7 @@ int main(int argc, char *argv[])
             static const Creator creator(context);
             
             context.limit = limit;
+            context.format = format;
             
             client = new oodles::net::Client(dispatcher, creator);
             client->start(connect_to);
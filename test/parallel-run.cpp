@@ -0,0 +1,205 @@
+// oodles
+#include "sched/Scheduler.hpp"
+#include "utility/Dispatcher.hpp"
+
+// STL
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+#include <sys/time.h> // For gettimeofday()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::string;
+using std::vector;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::Dispatcher;
+using oodles::url::URL;
+using oodles::sched::Crawler;
+using oodles::sched::Scheduler;
+
+namespace {
+
+/*
+ * A Crawler without a network session that is always online. The pages
+ * of each work unit are noted on begin_crawl() so they can be completed.
+ */
+class SimulatedCrawler : public Crawler
+{
+    public:
+        SimulatedCrawler(const string &name, vector<URL::hash_t> &crawled) :
+            Crawler(name, 8),
+            crawled(crawled)
+        {}
+
+        void begin_crawl()
+        {
+            for (size_t i = 0 ; i < work_unit.size() ; ++i)
+                crawled.push_back(work_unit[i]->page->id);
+        }
+    private:
+        bool offline() const { return false; }
+
+        vector<URL::hash_t> &crawled;
+};
+
+double
+elapsed(const struct timeval &from)
+{
+    struct timeval to;
+    gettimeofday(&to, NULL);
+
+    return (to.tv_sec - from.tv_sec) + (to.tv_usec - from.tv_usec) / 1e6;
+}
+
+string
+page_url(int i, int domains)
+{
+    static const char *tld[] = {"com", "net", "org", "co.uk", "de"};
+    const int d = i % domains;
+    ostringstream s;
+
+    s << "http://www.site" << d << '.' << tld[d % 5] << "/section"
+      << (i / domains) % 7 << "/page" << i << ".html";
+
+    return s.str();
+}
+
+/*
+ * Schedule rounds runs, completing every page handed out between runs.
+ * Returns the time spent within the scheduling runs alone, that spent
+ * completing the pages is added to updating.
+ */
+double
+schedule(Scheduler &s,
+         vector<URL::hash_t> &crawled,
+         size_t workers,
+         int rounds,
+         uint32_t &assigned,
+         double &updating)
+{
+    double t = 0;
+    struct timeval start;
+    vector<Scheduler::Outcome> outcomes;
+
+    assigned = 0;
+    updating = 0;
+
+    for (int i = 0 ; i < rounds ; ++i) {
+        gettimeofday(&start, NULL);
+
+        if (workers > 1)
+            assigned += s.run_parallel(workers);
+        else
+            assigned += s.run();
+
+        t += elapsed(start);
+        gettimeofday(&start, NULL);
+
+        if (workers > 1) {
+            outcomes.clear();
+
+            for (size_t j = 0 ; j < crawled.size() ; ++j)
+                outcomes.push_back(Scheduler::Outcome(crawled[j], true, j & 1));
+
+            s.update_nodes(outcomes, time(NULL), workers);
+        } else {
+            for (size_t j = 0 ; j < crawled.size() ; ++j)
+                s.update_node(crawled[j], time(NULL), j & 1);
+        }
+
+        updating += elapsed(start);
+        crawled.clear();
+    }
+
+    return t;
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program
+         << " [pages] [domains] [crawlers] [rounds] [threads]\n";
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    if (argc > 6) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int pages = argc > 1 ? atoi(argv[1]) : 200000,
+              domains = argc > 2 ? atoi(argv[2]) : 4000,
+              crawlers = argc > 3 ? atoi(argv[3]) : 64,
+              rounds = argc > 4 ? atoi(argv[4]) : 20;
+    const size_t threads = argc > 5 ? atoi(argv[5]) :
+                                      boost::thread::hardware_concurrency();
+
+    try {
+        Dispatcher dispatcher(threads);
+        vector<URL::hash_t> crawled[2];
+        vector<SimulatedCrawler> pool[2];
+        Scheduler serial(&dispatcher), parallel(&dispatcher);
+        Scheduler *schedulers[2] = {&serial, &parallel};
+
+        for (int i = 0 ; i < 2 ; ++i) {
+            /*
+             * Without a delay a host is ready again as soon as its URL has
+             * been crawled, so both runs see the same hosts each round.
+             */
+            schedulers[i]->politeness().set_delay(0, 0);
+
+            for (int j = 0 ; j < pages ; ++j)
+                schedulers[i]->schedule_from_seed(page_url(j, domains));
+
+            pool[i].reserve(crawlers);
+
+            for (int j = 0 ; j < crawlers ; ++j) {
+                ostringstream name;
+                name << "crawler" << j;
+                pool[i].push_back(SimulatedCrawler(name.str(), crawled[i]));
+            }
+
+            for (int j = 0 ; j < crawlers ; ++j)
+                schedulers[i]->register_crawler(pool[i][j]);
+        }
+
+        uint32_t s = 0, p = 0;
+        double u = 0, v = 0;
+        const double x = schedule(serial, crawled[0], 1, rounds, s, u),
+                     y = schedule(parallel, crawled[1], threads, rounds, p, v);
+
+        cout << rounds << " runs over " << pages << " pages, " << domains
+             << " domains and " << crawlers << " crawlers:\n"
+             << "\tSerial:   " << s << " URLs in " << x << "s ("
+             << s / x << " URLs/s), updated in " << u << "s\n"
+             << "\tParallel: " << p << " URLs in " << y << "s ("
+             << p / y << " URLs/s, " << threads << " threads), updated in "
+             << v << "s\n";
+
+        if (s != p) {
+            cerr << "Parallel runs assigned a different no. of URLs!\n";
+            return 1;
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
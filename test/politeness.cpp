@@ -0,0 +1,266 @@
+// oodles
+#include "sched/Scheduler.hpp"
+#include "utility/Clock.hpp"
+#include "utility/TimingWheel.hpp"
+
+// STL
+#include <map>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+// libc
+#include <stdlib.h> // For rand()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::string;
+using std::vector;
+using std::multimap;
+using std::make_pair;
+
+// STL algorithm
+using std::sort;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::TimingWheel;
+using oodles::ManualClock;
+using oodles::url::URL;
+using oodles::sched::Crawler;
+using oodles::sched::Scheduler;
+
+namespace {
+
+typedef TimingWheel<int>::tick_t tick_t;
+
+/*
+ * A Crawler, online until told otherwise, that notes the pages it is sent
+ */
+class PoliteCrawler : public Crawler
+{
+    public:
+        PoliteCrawler(const string &name, vector<URL::hash_t> &crawled) :
+            Crawler(name, 64),
+            available(true),
+            crawled(crawled)
+        {}
+
+        void begin_crawl()
+        {
+            for (size_t i = 0 ; i < work_unit.size() ; ++i)
+                crawled.push_back(work_unit[i]->page->id);
+        }
+
+        bool available;
+    private:
+        bool offline() const { return !available; }
+
+        vector<URL::hash_t> &crawled;
+};
+
+/*
+ * Expire timers from both the wheel and a reference multimap up to now
+ */
+bool
+expire(TimingWheel<int> &w, multimap<tick_t, int> &reference, tick_t now)
+{
+    vector<int> expired, expected;
+
+    w.advance(now, expired);
+
+    while (!reference.empty() && reference.begin()->first <= now) {
+        expected.push_back(reference.begin()->second);
+        reference.erase(reference.begin());
+    }
+
+    sort(expired.begin(), expired.end());
+    sort(expected.begin(), expected.end());
+
+    return expired == expected;
+}
+
+/*
+ * Schedule and expire timers at random, near and far into the future
+ */
+bool
+test_timing_wheel(int operations)
+{
+    tick_t now = 12345;
+    TimingWheel<int> w(now);
+    multimap<tick_t, int> reference;
+
+    srand(1);
+
+    for (int i = 0 ; i < operations ; ++i) {
+        if (rand() % 3 < 2) {
+            const tick_t expiry = now + (rand() % 5 == 0 ?
+                                         tick_t(rand()) * (rand() % 300) :
+                                         rand() % 2000);
+
+            w.schedule(i, expiry);
+            reference.insert(make_pair(expiry > now ? expiry : now + 1, i));
+        } else {
+            now += rand() % 4 == 0 ? rand() % 70000 : rand() % 50;
+
+            if (!expire(w, reference, now)) {
+                cerr << "Timers expired out of turn at " << now << endl;
+                return false;
+            }
+        }
+    }
+
+    if (!expire(w, reference, now + (tick_t(1) << 41)) || w.size() > 0) {
+        cerr << "Timers were left on the wheel" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+string
+page_url(int i, int domains)
+{
+    ostringstream s;
+
+    s << "http://www.site" << i % domains << ".com/page" << i << ".html";
+
+    return s.str();
+}
+
+/*
+ * No host may be sent a second URL until its first has been crawled and
+ * its delay has expired.
+ */
+bool
+test_scheduler(int pages, int domains)
+{
+    Scheduler s;
+    vector<URL::hash_t> crawled;
+    PoliteCrawler c("crawler", crawled);
+
+    s.politeness().set_delay(60000, 60000);
+
+    for (int i = 0 ; i < pages ; ++i)
+        s.schedule_from_seed(page_url(i, domains));
+
+    s.register_crawler(c);
+
+    uint32_t assigned = s.run();
+
+    if (assigned != static_cast<uint32_t>(domains)) {
+        cerr << "Assigned " << assigned << " URLs to " << domains
+             << " hosts in one run" << endl;
+        return false;
+    }
+
+    for (size_t i = 0 ; i < crawled.size() ; ++i)
+        s.update_node(crawled[i], time(NULL));
+
+    crawled.clear();
+
+    if ((assigned = s.run()) > 0) {
+        cerr << "Assigned " << assigned << " URLs before any delay expired"
+             << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Pages that are never returned go back to the frontier once their lease
+ * expires, and at once should their Crawler go offline. Either way their
+ * Crawler is held back for a while, and what it reports late of pages
+ * since leased to another is ignored.
+ */
+bool
+test_leases(int domains)
+{
+    Scheduler s;
+    ManualClock clock(1000000);
+    vector<URL::hash_t> crawled;
+    PoliteCrawler a("a", crawled), b("b", crawled);
+    uint32_t assigned = 0;
+
+    s.set_clock(clock);
+    s.set_lease(60000);
+    s.politeness().set_delay(0, 0);
+
+    for (int i = 0 ; i < domains ; ++i)
+        s.schedule_from_seed(page_url(i, domains));
+
+    s.register_crawler(a);
+    s.run();
+    clock.advance(30000);
+
+    if ((assigned = s.run()) > 0) {
+        cerr << "Assigned " << assigned << " URLs before any lease expired"
+             << endl;
+        return false;
+    }
+
+    clock.advance(30000);
+
+    if ((assigned = s.run()) > 0 || a.assigned() > 0) {
+        cerr << "Expired leases were reassigned to their crawler" << endl;
+        return false;
+    }
+
+    s.register_crawler(b);
+    clock.advance(500);
+
+    if (s.run() != static_cast<uint32_t>(domains) || a.assigned() > 0) {
+        cerr << "Expired leases were not reassigned" << endl;
+        return false;
+    }
+
+    for (size_t i = 0 ; i < crawled.size() ; ++i) // As a reports them late
+        s.update_node(crawled[i], time(NULL), true, 0, &a);
+
+    if (b.assigned() != static_cast<uint32_t>(domains)) {
+        cerr << "A crawler reported pages leased to another" << endl;
+        return false;
+    }
+
+    b.available = false;
+    clock.advance(2000); // a is no longer held back
+
+    if (s.run() != static_cast<uint32_t>(domains) || b.assigned() > 0) {
+        cerr << "The work of an offline crawler was not reclaimed" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // anonymous
+
+int main()
+{
+    bool passed = false;
+
+    try {
+        const bool wheel = test_timing_wheel(200000),
+                   scheduler = test_scheduler(2000, 50),
+                   leases = test_leases(50);
+
+        cout << "Timing wheel: " << (wheel ? "passed" : "failed") << '\n'
+             << "Scheduler:    " << (scheduler ? "passed" : "failed") << '\n'
+             << "Leases:       " << (leases ? "passed" : "failed") << endl;
+
+        passed = wheel && scheduler && leases;
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+    }
+
+    return passed ? 0 : 1;
+}
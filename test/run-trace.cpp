@@ -0,0 +1,299 @@
+// oodles
+#include "sched/Trace.hpp"
+#include "sched/Scheduler.hpp"
+#include "utility/NodeIO.hpp"
+#include "utility/file-ops.hpp"
+#include "utility/BreadCrumbTrail.hpp"
+
+// STL
+#include <set>
+#include <sstream>
+#include <iostream>
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::set;
+using std::pair;
+using std::string;
+using std::vector;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::NodeBase;
+using oodles::BreadCrumbTrail;
+using oodles::read_file_data;
+using oodles::io::DotMatrix;
+using oodles::url::URL;
+using oodles::sched::Node;
+using oodles::sched::Trace;
+using oodles::sched::Crawler;
+using oodles::sched::Scheduler;
+
+namespace {
+
+typedef set<pair<URL::hash_t, string> > Assigned; // Page, crawler
+
+/*
+ * A Crawler without a network session that is always online. The pages
+ * of each work unit are noted on begin_crawl() so they can be completed.
+ */
+class SimulatedCrawler : public Crawler
+{
+    public:
+        SimulatedCrawler(const string &name) : Crawler(name, 2), to(NULL) {}
+
+        void note(Assigned &a) { to = &a; } // The pages of later units
+
+        void begin_crawl()
+        {
+            for (size_t i = 0 ; i < work_unit.size() ; ++i)
+                to->insert(make_pair(work_unit[i]->page->id, id()));
+        }
+    private:
+        bool offline() const { return false; }
+
+        Assigned *to;
+};
+
+void
+seed(Scheduler &s, const string &urls)
+{
+    string::size_type b = 0, e = urls.find_first_of('\n', b);
+
+    while (e != string::npos) {
+        s.schedule_from_seed(urls.substr(b, e - b));
+
+        b = e + 1;
+        e = urls.find_first_of('\n', b);
+    }
+}
+
+/*
+ * The run read back left the trail given, through the nodes of the tree,
+ * and assigned the pages given
+ */
+bool
+compare(const Trace::Replay &r,
+        const Scheduler &s,
+        BreadCrumbTrail trail,
+        const Assigned &assigned)
+{
+    vector<const NodeBase*> path;
+
+    if (r.crumbs.size() != static_cast<size_t>(trail.size())) {
+        cerr << "Run " << r.sequence << " has " << r.crumbs.size()
+             << " crumbs, not " << trail.size() << endl;
+        return false;
+    }
+
+    for (size_t i = 0 ; i < r.crumbs.size() ; ++i) {
+        const Trace::Crumb &c = r.crumbs[i];
+        const BreadCrumbTrail::Point p = trail.gather_crumb();
+        const NodeBase *n = &s.url_tree().root();
+
+        if (c.path_idx >= 0) {
+            path.resize(c.path_idx + 1);
+            n = &path.back()->child(c.child_idx);
+        } else {
+            path.clear();
+        }
+
+        path.push_back(n);
+
+        if (c.path_idx != p.first || c.child_idx != p.second ||
+            !(static_cast<const Node*>(n)->value == c.label))
+        {
+            cerr << "Crumb " << i << " of run " << r.sequence << " is "
+                 << c.label << " at " << c.path_idx << ", " << c.child_idx
+                 << endl;
+            return false;
+        }
+    }
+
+    Assigned replayed;
+
+    for (size_t i = 0 ; i < r.assignments.size() ; ++i)
+        replayed.insert(make_pair(r.assignments[i].page,
+                                  r.assignments[i].crawler));
+
+    if (replayed != assigned || r.assigned != assigned.size()) {
+        cerr << "Run " << r.sequence << " assigned " << replayed.size()
+             << " pages, not " << assigned.size() << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Every run is recorded, and read back from the rotated files in order
+ */
+bool
+test_trace(const string &urls, const string &directory)
+{
+    const int runs = 3;
+    const string path(directory + "/trace");
+    Assigned assigned[runs];
+    BreadCrumbTrail trails[runs];
+    Scheduler s;
+    Trace trace(path, 1, runs); // Every run is rotated into a file its own
+    vector<SimulatedCrawler*> crawlers;
+
+    seed(s, urls);
+    trace.open();
+
+    for (int i = 0 ; i < 4 ; ++i) {
+        crawlers.push_back(new SimulatedCrawler(string(1, 'A' + i)));
+        s.register_crawler(*crawlers.back());
+    }
+
+    for (int i = 0 ; i < runs ; ++i) {
+        BreadCrumbTrail trail;
+        Trace::Run r;
+
+        for (size_t j = 0 ; j < crawlers.size() ; ++j)
+            crawlers[j]->note(assigned[i]);
+
+        r.assigned = s.run(&trail);
+        trails[i] = trail;
+        trace.record(r, s.url_tree(), &trail);
+
+        /*
+         * Complete the work so the next run assigns more
+         */
+        for (Assigned::const_iterator j = assigned[i].begin() ;
+             j != assigned[i].end() ; ++j)
+            s.update_node(j->first, 1);
+    }
+
+    for (size_t i = 0 ; i < crawlers.size() ; ++i)
+        delete crawlers[i];
+
+    if (assigned[0].empty()) {
+        cerr << "The first run assigned nothing" << endl;
+        return false;
+    }
+
+    for (int i = runs ; i > 0 ; --i) {
+        ostringstream file;
+        file << path << '.' << i;
+
+        Trace::Reader reader(file.str());
+        Trace::Replay r;
+
+        if (!reader.next(r) || r.sequence != static_cast<uint64_t>(runs - i) ||
+            !compare(r, s, trails[r.sequence], assigned[r.sequence]) ||
+            reader.next(r))
+        {
+            cerr << file.str() << " does not hold run " << runs - i << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t
+count(const NodeBase &n)
+{
+    size_t c = 1;
+
+    for (size_t i = 0 ; i < n.size() ; ++i)
+        c += count(n.child(i));
+
+    return c;
+}
+
+size_t
+edges(const DotMatrix &dot)
+{
+    ostringstream s;
+    size_t n = 0;
+
+    s << dot;
+
+    for (string::size_type i = s.str().find("->") ; i != string::npos ;
+         i = s.str().find("->", i + 1))
+        ++n;
+
+    return n;
+}
+
+/*
+ * Every node, those within depth of the root, or of a subtree, are drawn
+ */
+bool
+test_dot(const string &urls)
+{
+    Scheduler s;
+
+    seed(s, urls);
+
+    const NodeBase &root = s.url_tree().root();
+    DotMatrix dot(s.url_tree());
+    size_t cut = 0;
+
+    for (size_t i = 0 ; i < root.size() ; ++i)
+        if (root.child(i).size() > 0)
+            ++cut; // Noted as having more below
+
+    const size_t all = edges(dot);
+
+    dot.set_depth(1);
+
+    const size_t bounded = edges(dot);
+
+    dot.set_depth(0);
+    dot.set_root(root.child(0));
+
+    const size_t subtree = edges(dot);
+
+    if (all != count(root) - 1 ||
+        bounded != root.size() + cut ||
+        subtree != count(root.child(0)) - 1)
+    {
+        cerr << "Drew " << all << ", " << bounded << " and " << subtree
+             << " edges" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        cerr << "usage: " << argv[0]
+             << " <seed file> <empty directory>\n";
+        return 1;
+    }
+
+    bool passed = false;
+
+    try {
+        string urls;
+
+        read_file_data(argv[1], urls);
+
+        const bool trace = test_trace(urls, argv[2]),
+                   dot = test_dot(urls);
+
+        cout << "Trace: " << (trace ? "passed" : "failed") << '\n'
+             << "DOT:   " << (dot ? "passed" : "failed") << endl;
+
+        passed = trace && dot;
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+    }
+
+    return passed ? 0 : 1;
+}
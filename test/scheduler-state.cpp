@@ -0,0 +1,154 @@
+// oodles
+#include "sched/Journal.hpp"
+#include "sched/PageData.hpp"
+#include "sched/Snapshot.hpp"
+#include "sched/Scheduler.hpp"
+#include "utility/file-ops.hpp"
+
+// STL
+#include <sstream>
+#include <iostream>
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostream;
+using std::ostringstream;
+
+// Containers
+using std::string;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::read_file_data;
+using oodles::sched::Node;
+using oodles::sched::Journal;
+using oodles::sched::Snapshot;
+using oodles::sched::Scheduler;
+
+namespace {
+
+/*
+ * Pre-order listing of every node and the page data it holds
+ */
+void
+print_tree(ostream &s, const Node &n, int depth = 0)
+{
+    s << string(depth, ' ') << n.value;
+
+    if (n.page)
+        s << " links=" << n.page->links
+          << " crawls=" << n.page->crawl_count
+          << " last=" << n.page->last_crawl
+          << " epoch=" << n.page->epoch
+          << " weight=" << n.weight();
+
+    s << '\n';
+
+    for (size_t i = 0 ; i < n.size() ; ++i)
+        print_tree(s, n.child(i), depth + 1);
+}
+
+string
+print_tree(Scheduler &s)
+{
+    ostringstream o;
+
+    s.weigh(); // Any nodes changed since the last run
+    print_tree(o, static_cast<const Node&>(s.url_tree().root()));
+    return o.str();
+}
+
+void
+seed(Scheduler &s, const string &urls)
+{
+    string::size_type b = 0, e = urls.find_first_of('\n', b);
+
+    while (e != string::npos) {
+        s.schedule_from_seed(urls.substr(b, e - b));
+
+        b = e + 1;
+        e = urls.find_first_of('\n', b);
+    }
+}
+
+bool
+compare(const string &what, Scheduler &x, const string &y)
+{
+    const bool same = print_tree(x) == y;
+
+    cout << what << (same ? ": restored.\n" : ": differs!\n");
+
+    return same;
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program << " <seed file> <empty state directory>\n";
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        string urls;
+        const string directory(argv[2]);
+
+        read_file_data(argv[1], urls);
+
+        /*
+         * Seed, snapshot and then continue to log changes
+         */
+        Scheduler original;
+        Snapshot snapshot(directory + "/snapshot");
+        Journal journal(directory);
+
+        seed(original, urls);
+        journal.replay(original, 0); // No logs, so just initialises it
+        journal.rotate();
+        snapshot.write(original, journal.generation());
+
+        const string seeded(print_tree(original));
+
+        original.set_journal(&journal);
+        original.schedule_from_crawl("http://www.example.com/new/page.html");
+        original.schedule_from_crawl("http://www.example.com/new/page.html");
+        original.schedule_from_crawl("http://www.example.com/new/link.html", 3);
+        journal.sync();
+
+        {
+            Scheduler restored;
+
+            if (snapshot.read(restored) != journal.generation() ||
+                !compare("Snapshot", restored, seeded))
+                return 1;
+        }
+
+        /*
+         * The snapshot alone misses the logged changes, replay restores them
+         */
+        Scheduler restored;
+        Journal replayed(directory);
+        const uint32_t n = replayed.replay(restored, snapshot.read(restored));
+
+        cout << "Replayed " << n << " journal records.\n";
+
+        if (!compare("Snapshot and journal", restored, print_tree(original)))
+            return 1;
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+// oodles
+#include "sched/Node.hpp"
+#include "sched/PageData.hpp"
+#include "sched/Scheduler.hpp"
+
+// STL
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+#include <unistd.h> // For sysconf()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ifstream;
+using std::ostringstream;
+
+// Containers
+using std::string;
+using std::vector;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::NodeBase;
+using oodles::sched::Node;
+using oodles::sched::PageData;
+using oodles::sched::Scheduler;
+
+namespace {
+
+size_t
+resident()
+{
+    size_t pages = 0, rss = 0;
+    ifstream statm("/proc/self/statm");
+
+    statm >> pages >> rss;
+
+    return rss * sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * A URL of one of hosts sites, each with a handful of sections
+ */
+string
+page_url(int i, int hosts)
+{
+    static const char *tlds[] = {"com", "org", "co.uk", "net", "de"};
+    const int site = i % hosts;
+    ostringstream s;
+
+    s << "http://www.site" << site << '.' << tlds[site % 5]
+      << "/section" << (i / hosts) % 7 << "/page" << i << ".html";
+
+    return s.str();
+}
+
+size_t
+count_nodes(const NodeBase &n)
+{
+    size_t nodes = 1;
+
+    for (size_t i = 0 ; i < n.size() ; ++i)
+        nodes += count_nodes(n.child(i));
+
+    return nodes;
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program << " [pages] [hosts]\n";
+}
+
+} // anonymous
+
+/*
+ * Schedule pages URLs over hosts sites and report the memory held per URL
+ * by the URL tree (and the PageData at its leaves).
+ */
+int main(int argc, char *argv[])
+{
+    if (argc > 3) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int pages = argc > 1 ? atoi(argv[1]) : 1000000,
+              hosts = argc > 2 ? atoi(argv[2]) : 10000;
+
+    try {
+        Scheduler s;
+        const size_t baseline = resident();
+        vector<string> batch;
+        vector<oodles::url::URL::hash_t> ids;
+
+        batch.reserve(10000);
+
+        for (int i = 0 ; i < pages ; ) {
+            batch.clear();
+            ids.clear();
+
+            for ( ; i < pages && batch.size() < batch.capacity() ; ++i)
+                batch.push_back(page_url(i, hosts));
+
+            s.schedule_batch(batch, ids, true);
+        }
+
+        s.weigh();
+
+        const size_t bytes = resident() - baseline,
+                     nodes = count_nodes(s.url_tree().root()),
+                     known = s.pages() ? s.pages() : 1;
+
+        cout << known << " URLs on " << hosts << " hosts in " << nodes
+             << " nodes:\n"
+             << "\tNode:     " << sizeof(Node) << " bytes, "
+             << static_cast<double>(nodes) / known << " per URL\n"
+             << "\tPageData: " << sizeof(PageData) << " bytes\n"
+             << "\tResident: " << bytes / known << " bytes/URL\n";
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+// oodles
+#include "sched/Scheduler.hpp"
+#include "utility/Clock.hpp"
+
+// STL
+#include <map>
+#include <set>
+#include <vector>
+#include <sstream>
+#include <iostream>
+
+// libc
+#include <stdlib.h> // For atoi()
+
+// IO streams
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::ostringstream;
+
+// Containers
+using std::set;
+using std::pair;
+using std::string;
+using std::vector;
+using std::multimap;
+using std::make_pair;
+
+// STL exception
+using std::exception;
+
+// oodles
+using oodles::ManualClock;
+using oodles::url::URL;
+using oodles::sched::Crawler;
+using oodles::sched::Scheduler;
+
+namespace {
+
+class TimedCrawler; // Forward declaration for Returns
+
+typedef pair<URL::hash_t, TimedCrawler*> Crawl; // Page and Crawler
+typedef multimap<uint64_t, Crawl> Returns; // By time returned
+
+/*
+ * A Crawler that crawls the URLs it is sent one after another, each taking
+ * a fixed time, and returns each once crawled
+ */
+class TimedCrawler : public Crawler
+{
+    public:
+        TimedCrawler(const string &name,
+                     uint32_t pace,
+                     const ManualClock &clock,
+                     Returns &returns) :
+            Crawler(name, 4),
+            crawled(0),
+            pace(pace),
+            clock(clock),
+            returns(returns),
+            busy_until(0)
+        {}
+
+        void begin_crawl()
+        {
+            if (busy_until < clock.milliseconds())
+                busy_until = clock.milliseconds();
+
+            for (size_t i = 0 ; i < work_unit.size() ; ++i) {
+                const URL::hash_t id = work_unit[i]->page->id;
+
+                if (sent.insert(id).second) {
+                    busy_until += pace;
+                    returns.insert(make_pair(busy_until, Crawl(id, this)));
+                }
+            }
+        }
+
+        void returned(URL::hash_t id) { sent.erase(id); ++crawled; }
+
+        uint32_t crawled;
+    private:
+        bool offline() const { return false; }
+
+        const uint32_t pace; // ms per URL
+        const ManualClock &clock;
+        Returns &returns;
+        set<URL::hash_t> sent; // URLs of the work unit already noted
+        uint64_t busy_until; // Time the last URL sent will be crawled
+};
+
+string
+page_url(int i, int domains)
+{
+    ostringstream s;
+    s << "http://www.site" << i % domains << ".com/page" << i << ".html";
+    return s.str();
+}
+
+void
+usage(const string &program)
+{
+    cerr << "usage: " << program << " [pages] [domains] [seconds]\n";
+}
+
+} // anonymous
+
+/*
+ * Two Crawlers, one crawling 10 times faster than the other, are scheduled
+ * once a second. Each should be given a unit of about the URLs it crawls
+ * in a cycle (a minute), within the bounds.
+ */
+int main(int argc, char *argv[])
+{
+    if (argc > 4) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int pages = argc > 1 ? atoi(argv[1]) : 200000,
+              domains = argc > 2 ? atoi(argv[2]) : 20000,
+              seconds = argc > 3 ? atoi(argv[3]) : 600;
+
+    try {
+        Scheduler s;
+        ManualClock clock(1000000);
+        Returns returns;
+        TimedCrawler fast("fast", 10, clock, returns),
+                     slow("slow", 100, clock, returns);
+
+        s.set_clock(clock);
+        s.politeness().set_delay(0, 0);
+
+        for (int i = 0 ; i < pages ; ++i)
+            s.schedule_from_seed(page_url(i, domains));
+
+        s.register_crawler(fast);
+        s.register_crawler(slow);
+
+        for (int i = 0 ; i < seconds ; ++i) {
+            s.run();
+            clock.advance(1000);
+
+            while (!returns.empty() &&
+                   returns.begin()->first <= clock.milliseconds())
+            {
+                const Crawl c = returns.begin()->second;
+
+                returns.erase(returns.begin());
+                s.update_node(c.first, clock.now());
+                c.second->returned(c.first);
+            }
+        }
+
+        cout << seconds << "s over " << pages << " pages and " << domains
+             << " domains:\n"
+             << "\tFast crawler: unit of " << fast.max_unit_size() << " URLs, "
+             << fast.crawled << " crawled\n"
+             << "\tSlow crawler: unit of " << slow.max_unit_size() << " URLs, "
+             << slow.crawled << " crawled\n";
+
+        if (fast.max_unit_size() != 1024 || // 6000 a minute, 256 per core
+            slow.max_unit_size() < 540 || slow.max_unit_size() > 660)
+        {
+            cerr << "Units were not sized by throughput\n";
+            return 1;
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -21,7 +21,7 @@ using std::string;
 // STL exception
 using std::exception;
 
-static oodles::Tree<std::string> tree;
+static oodles::Tree<oodles::Label> tree;
 
 static
 bool
@@ -1,6 +1,9 @@
 #ifndef OODLES_URL_ITERATOR_HPP
 #define OODLES_URL_ITERATOR_HPP
 
+// oodles
+#include "utility/StringInterner.hpp"
+
 // STL
 #include <iterator>
 
@@ -10,7 +13,7 @@ namespace url {
 class URL; // Forward declaration for Iterator
 
 class Iterator :
-    public std::iterator<std::bidirectional_iterator_tag, std::string>
+    public std::iterator<std::bidirectional_iterator_tag, Label>
 {
     private:
         enum {Invalid = 0, Begin, Transient, End};
@@ -22,7 +25,7 @@ class Iterator :
         Iterator& operator++();
         Iterator& operator--();
 
-        const std::string& operator*()
+        const Label& operator*()
         {
             return *value;
         }
@@ -43,7 +46,7 @@ class Iterator :
         friend class URL; // URL wants access only to enums above
     private:
         int internal_state, external_state;
-        const std::string *value;
+        const Label *value;
         const URL *url;
         size_t index;
 };
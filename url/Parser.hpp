@@ -1,6 +1,9 @@
 #ifndef OODLES_URL_PARSER_HPP
 #define OODLES_URL_PARSER_HPP
 
+// oodles
+#include "utility/StringInterner.hpp"
+
 // STL
 #include <string>
 #include <vector>
@@ -8,23 +11,33 @@
 namespace oodles {
 namespace url {
 
-struct Attributes
+template<class Component> struct Components
 {
     bool ip; // Is the domain stored in fact an IP address?
     
-    std::string port,
-                page,
-                scheme,
-                username,
-                password;
-    std::vector<std::string> path, domain;
+    Component port,
+              page,
+              scheme,
+              username,
+              password;
+    std::vector<Component> path, domain;
     
-    Attributes() : ip(false) {}
+    Components() : ip(false) {}
 };
 
+/*
+ * Every component of a URL is interned, so the labels shared by many URLs
+ * (such as "http", "com" or "www") are each held just once. Nothing is
+ * ever released by the interner, so a process that keeps no tree of URLs
+ * reads them as Tokens instead, see URL::identify().
+ */
+typedef Components<Label> Attributes;
+typedef Components<std::string> Tokens;
+
 struct Parser
 {
     bool parse(const std::string &url, Attributes &attributes);
+    bool parse(const std::string &url, Tokens &tokens); // Nothing interned
 };
 
 } // url
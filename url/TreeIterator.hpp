@@ -1,8 +1,10 @@
 #ifndef OODLES_URL_TREEITERATOR_HPP
 #define OODLES_URL_TREEITERATOR_HPP
 
+// oodles
+#include "utility/StringInterner.hpp"
+
 // STL
-#include <string>
 #include <iterator>
 
 namespace oodles {
@@ -11,8 +13,7 @@ namespace url {
 class URL; // Forward declaration for Iterator
 
 class TreeIterator :
-    public std::iterator<std::bidirectional_iterator_tag,
-                         std::string>
+    public std::iterator<std::bidirectional_iterator_tag, Label>
 {
     private:
         enum {Invalid = 0, Begin, Transient, End};
@@ -24,7 +25,7 @@ class TreeIterator :
         TreeIterator& operator++();
         TreeIterator& operator--();
 
-        const std::string& operator*()
+        const Label& operator*()
         {
             return *value;
         }
@@ -45,7 +46,7 @@ class TreeIterator :
         friend class URL; // URL wants access only to enums above
     private:
         int internal_state, external_state;
-        const std::string *value;
+        const Label *value;
         const URL *url;
         size_t index;
 };
@@ -31,7 +31,7 @@ template<class Container>
 hash_t
 hasher(const Container &input, hash_t seed);
 
-// Provide the two necessary specialisations of hasher:
+// Provide the specialisations of hasher, a Label hashing as its string:
 template<>
 inline
 hash_t
@@ -47,9 +47,21 @@ hasher<string>(const string &input, hash_t seed)
 template<>
 inline
 hash_t
-hasher<vector<string> >(const vector<string> &input, hash_t seed)
+hasher<oodles::Label>(const oodles::Label &input, hash_t seed)
 {
-    vector<string>::const_iterator i = input.begin();
+#ifdef HAS_64_BITS
+    return oodles::fnv64(input.data(), input.size(), seed);
+#else
+    return oodles::fnv32(input.data(), input.size(), seed);
+#endif
+}
+
+template<class Component>
+inline
+hash_t
+hash_components(const vector<Component> &input, hash_t seed)
+{
+    typename vector<Component>::const_iterator i = input.begin();
 
     for ( ; i != input.end() ; ++i)
         seed = hasher(*i, seed);
@@ -57,6 +69,23 @@ hasher<vector<string> >(const vector<string> &input, hash_t seed)
     return seed;
 }
 
+template<>
+inline
+hash_t
+hasher<vector<string> >(const vector<string> &input, hash_t seed)
+{
+    return hash_components(input, seed);
+}
+
+template<>
+inline
+hash_t
+hasher<vector<oodles::Label> >(const vector<oodles::Label> &input,
+                               hash_t seed)
+{
+    return hash_components(input, seed);
+}
+
 template<class Type>
 class IDGenerator
 {
@@ -79,6 +108,44 @@ class IDGenerator
         const Type &content;
 };
 
+/*
+ * The domain, path and page hashes of the given components, whether they
+ * are interned or not
+ */
+template<class Component>
+void
+identify_components(const oodles::url::Components<Component> &c,
+                    hash_t &domain_id,
+                    hash_t &path_id,
+                    hash_t &page_id)
+{
+    IDGenerator<Component> page(c.page);
+    IDGenerator<vector<Component> > path(c.path), domain(c.domain);
+
+    domain_id = domain.id();
+    path_id = path.id(domain_id);
+    page_id = page.id(path_id);
+}
+
+/*
+ * Tokenise the given URL without interning any of its components, for a
+ * process that only needs the URL's identity
+ */
+oodles::url::Tokens
+tokenise_only(const string &url) throw(oodles::url::ParseError)
+{
+    oodles::url::Parser p;
+    oodles::url::Tokens t;
+
+    if (!p.parse(url, t))
+       throw oodles::url::ParseError("URL::tokenise_only",
+                                     0,
+                                     "Failed to parse input '%s'.",
+                                     url.c_str());
+
+    return t;
+}
+
 } // anonymous
 
 namespace oodles {
@@ -92,6 +159,10 @@ URL::URL(const string &url) : id(tokenise(url))
 {
 }
 
+URL::URL(const Attributes &a) : attributes(a), id(identify())
+{
+}
+
 URL::URL(const URL &url) : attributes(url.attributes), id(url.id)
 {
 }
@@ -137,21 +208,39 @@ URL::domain_id() const
     return id.domain;
 }
 
+URL::hash_t
+URL::page_id(const string &url) throw(ParseError)
+{
+    hash_t domain, path, page;
+    identify_components(tokenise_only(url), domain, path, page);
+
+    return page;
+}
+
+URL::hash_t
+URL::domain_id(const string &url) throw(ParseError)
+{
+    hash_t domain, path, page;
+    identify_components(tokenise_only(url), domain, path, page);
+
+    return domain;
+}
+
 string
 URL::host() const
 {
     string s;
     
     if (!attributes.domain.empty()) {
-        vector<string>::const_iterator i = attributes.domain.begin(),
-                                       j = attributes.domain.end() - 1;
+        vector<Label>::const_iterator i = attributes.domain.begin(),
+                                      j = attributes.domain.end() - 1;
 
         while (i != j) {
-            s += *i + ".";
+            s.append(i->data(), i->size()) += '.';
             ++i;
         }
 
-        s += *j;
+        s.append(j->data(), j->size());
     }
 
     return s;
@@ -163,18 +252,18 @@ URL::resource() const
     string s("/");
     
     if (!attributes.path.empty()) {
-        vector<string>::const_iterator i = attributes.path.begin(),
-                                       j = attributes.path.end() - 1;
+        vector<Label>::const_iterator i = attributes.path.begin(),
+                                      j = attributes.path.end() - 1;
 
         while (i != j) {
-            s += *i + "/";
+            s.append(i->data(), i->size()) += '/';
             ++i;
         }
 
-        s += *j + "/";
+        s.append(j->data(), j->size()) += '/';
     }
 
-    s += attributes.page;
+    s.append(attributes.page.data(), attributes.page.size());
 
     return s;
 }
@@ -221,17 +310,40 @@ URL::ID
 URL::tokenise(const string &url) throw(ParseError)
 {
     Parser p;
-    IDGenerator<string> page(attributes.page);
-    IDGenerator<vector<string> > path(attributes.path),
-                                 domain(attributes.domain);
 
     if (!p.parse(url, attributes))
        throw ParseError("URL::tokenise", 0, "Failed to parse input '%s'.",
                         url.c_str());
 
-    const ID x = {domain.id(),
-                  path.id(domain.id()),
-                  page.id(path.id(domain.id()))};
+    return identify();
+}
+
+URL::ID
+URL::identify() const
+{
+    ID x;
+    identify_components(attributes, x.domain, x.path, x.page);
+
+    return x;
+}
+
+/*
+ * As identify(), but the domain hash, and the path hash too if the path is
+ * alike, are those already computed for sibling
+ */
+URL::ID
+URL::identify(const URL &sibling) const
+{
+    ID x = sibling.id;
+
+    if (attributes.path != sibling.attributes.path) {
+        IDGenerator<vector<Label> > path(attributes.path);
+        x.path = path.id(x.domain);
+    }
+
+    IDGenerator<Label> page(attributes.page);
+    x.page = page.id(x.path);
+
     return x;
 }
 
@@ -48,6 +48,7 @@ class URL
         /* Member functions/methods */
         URL();
         URL(const std::string &url);
+        explicit URL(const Attributes &a); // Components already tokenised
         
         URL(const URL &url);
         URL& operator= (const URL &url);
@@ -58,13 +59,22 @@ class URL
         hash_t page_id() const;
         hash_t path_id() const;
         hash_t domain_id() const;
+
+        /*
+         * As the above but straight from a URL string, so that a process
+         * keeping no URLs need not intern the components of every one
+         */
+        static hash_t page_id(const std::string &url) throw(ParseError);
+        static hash_t domain_id(const std::string &url) throw(ParseError);
         
         std::string host() const;
         std::string resource() const;
-        const std::string& port() const { return attributes.port; }
-        const std::string& scheme() const { return attributes.scheme; }
-        const std::string& username() const { return attributes.username; }
-        const std::string& password() const { return  attributes.password; }
+        size_t domain_levels() const { return attributes.domain.size(); }
+        const Label& port() const { return attributes.port; }
+        const Label& scheme() const { return attributes.scheme; }
+        const Label& username() const { return attributes.username; }
+        const Label& password() const { return attributes.password; }
+        const Attributes& components() const { return attributes; }
         
         std::string to_string() const;
         void print(std::ostream &stream) const;
@@ -97,6 +107,8 @@ class URL
         /* Member functions/methods */
         void to_stream(std::ostream &stream) const;
         ID tokenise(const std::string &url) throw(ParseError);
+        ID identify() const; // Hashes of the tokenised components
+        ID identify(const URL &sibling) const; // Of the same domain
 
         /* Member variables/attributes */
         Attributes attributes;
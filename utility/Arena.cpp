@@ -0,0 +1,77 @@
+// oodles
+#include "Arena.hpp"
+
+// Boost.thread
+#include <boost/thread/locks.hpp>
+
+// STL
+#include <new>
+
+// libc
+#include <sys/mman.h> // For mmap(), madvise()
+
+// Boost
+using boost::lock_guard;
+
+namespace oodles {
+
+Arena::Arena(size_t block, size_t slab) :
+    block((block + sizeof(void*) - 1) & ~(sizeof(void*) - 1)),
+    slab(slab),
+    next(NULL),
+    end(NULL),
+    free_list(NULL),
+    blocks(0)
+{
+}
+
+void*
+Arena::allocate()
+{
+    const lock_guard<boost::mutex> lock(mutex);
+    void *b = free_list;
+
+    if (b) {
+        free_list = *static_cast<void**>(b);
+    } else {
+        if (next + block > end)
+            map_slab();
+
+        b = next;
+        next += block;
+    }
+
+    ++blocks;
+
+    return b;
+}
+
+void
+Arena::deallocate(void *b)
+{
+    const lock_guard<boost::mutex> lock(mutex);
+
+    *static_cast<void**>(b) = free_list;
+    free_list = b;
+    --blocks;
+}
+
+void
+Arena::map_slab()
+{
+    void *s = mmap(NULL, slab, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (s == MAP_FAILED)
+        throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+    madvise(s, slab, MADV_HUGEPAGE); // Only advice; failure is harmless
+#endif
+
+    next = static_cast<char*>(s);
+    end = next + slab;
+    slabs.push_back(next);
+}
+
+} // oodles
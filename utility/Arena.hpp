@@ -0,0 +1,52 @@
+#ifndef OODLES_ARENA_HPP
+#define OODLES_ARENA_HPP
+
+// Boost.thread
+#include <boost/thread/mutex.hpp>
+
+// STL
+#include <vector>
+
+// libc
+#include <stddef.h> // For size_t
+
+namespace oodles {
+
+/*
+ * Blocks of one fixed size carved, end to end, from large slabs of
+ * anonymous memory; no block carries a header of its own. The slabs are
+ * advised to be backed by huge pages where the system supports them, so
+ * walking a tree allocated here costs fewer TLB misses. Blocks given back
+ * are kept on a free list to be reused; the slabs are held for the life of
+ * the process.
+ */
+class Arena
+{
+    public:
+        /* Member functions/methods */
+        Arena(size_t block, size_t slab = 8 << 20);
+
+        void* allocate();
+        void deallocate(void *b);
+
+        size_t size() const { return blocks; } // No. of blocks allocated
+        size_t memory() const { return slabs.size() * slab; }
+    private:
+        /* Member variables/attributes */
+        const size_t block, slab; // Sizes in bytes
+        char *next, *end; // Remainder of the current slab
+        void *free_list; // Each free block holds the next
+        size_t blocks;
+        std::vector<char*> slabs;
+        boost::mutex mutex;
+
+        /* Member functions/methods */
+        void map_slab();
+
+        Arena(const Arena &a); // Do not allow...
+        Arena& operator= (const Arena &a); // ... copying.
+};
+
+} // oodles
+
+#endif
@@ -0,0 +1,43 @@
+// oodles
+#include "ChildArray.hpp"
+
+// libc
+#include <string.h> // For memcpy(), memmove()
+
+namespace oodles {
+
+ChildArray::~ChildArray()
+{
+    delete[] block;
+}
+
+void
+ChildArray::insert(NodeBase *n, size_t k)
+{
+    if (count == capacity)
+        grow();
+
+    uint32_t *o = order();
+
+    memmove(o + k + 1, o + k, (count - k) * sizeof(uint32_t));
+    o[k] = count;
+    nodes()[count++] = n;
+}
+
+void
+ChildArray::grow()
+{
+    const uint32_t c = capacity ? capacity * 2 : 1;
+    char *b = new char[c * (sizeof(NodeBase*) + sizeof(uint32_t))];
+
+    if (block) {
+        memcpy(b, block, count * sizeof(NodeBase*));
+        memcpy(b + c * sizeof(NodeBase*), order(), count * sizeof(uint32_t));
+        delete[] block;
+    }
+
+    block = b;
+    capacity = c;
+}
+
+} // oodles
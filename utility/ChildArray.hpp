@@ -0,0 +1,54 @@
+#ifndef OODLES_CHILDARRAY_HPP
+#define OODLES_CHILDARRAY_HPP
+
+// libc
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+
+class NodeBase; // Forward declaration for ChildArray
+
+/*
+ * The children of a node, held contiguously in the order they were added
+ * (their child_idx), along with their indices in order of key so a child
+ * may be looked up by binary search. Both are held in a single block that
+ * doubles in size as it fills; a leaf holds no block at all.
+ */
+class ChildArray
+{
+    public:
+        /* Member functions/methods */
+        ChildArray() : block(NULL), count(0), capacity(0) {}
+        ~ChildArray();
+
+        size_t size() const { return count; }
+        NodeBase* operator[] (size_t i) const { return nodes()[i]; }
+        uint32_t ordered(size_t k) const { return order()[k]; } // By key
+
+        /*
+         * Add n, the child of index size(), as the k-th child in key order
+         */
+        void insert(NodeBase *n, size_t k);
+    private:
+        /* Member variables/attributes */
+        char *block; // capacity nodes followed by capacity indices
+        uint32_t count, capacity;
+
+        /* Member functions/methods */
+        NodeBase** nodes() const { return reinterpret_cast<NodeBase**>(block); }
+        uint32_t* order() const
+        {
+            return reinterpret_cast<uint32_t*>(block +
+                                               capacity * sizeof(NodeBase*));
+        }
+
+        void grow();
+
+        ChildArray(const ChildArray &a); // Do not allow...
+        ChildArray& operator= (const ChildArray &a); // ... copying.
+};
+
+} // oodles
+
+#endif
@@ -0,0 +1,32 @@
+// oodles
+#include "Clock.hpp"
+
+// libc
+#include <stddef.h> // For NULL
+#include <sys/time.h> // For gettimeofday()
+
+namespace oodles {
+
+time_t
+Clock::now() const
+{
+    return time(NULL);
+}
+
+uint64_t
+Clock::milliseconds() const
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+
+    return static_cast<uint64_t>(t.tv_sec) * 1000 + t.tv_usec / 1000;
+}
+
+const Clock&
+Clock::system()
+{
+    static const Clock clock;
+    return clock;
+}
+
+} // oodles
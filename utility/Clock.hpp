@@ -0,0 +1,45 @@
+#ifndef OODLES_CLOCK_HPP
+#define OODLES_CLOCK_HPP
+
+// libc
+#include <time.h> // For time_t
+#include <stdint.h> // For uint64_t
+
+namespace oodles {
+
+/*
+ * Source of the current time. The system clock is used by default; a
+ * ManualClock may be injected in its place so that time only moves when
+ * told to (e.g. to simulate days of crawling in seconds, repeatably).
+ */
+class Clock
+{
+    public:
+        /* Member functions/methods */
+        virtual ~Clock() {}
+
+        virtual time_t now() const; // Seconds since the epoch
+        virtual uint64_t milliseconds() const; // Milliseconds since the epoch
+
+        static const Clock& system();
+};
+
+class ManualClock : public Clock
+{
+    public:
+        /* Member functions/methods */
+        ManualClock(uint64_t milliseconds = 0) : current(milliseconds) {}
+
+        time_t now() const { return current / 1000; }
+        uint64_t milliseconds() const { return current; }
+
+        void set(uint64_t milliseconds) { current = milliseconds; }
+        void advance(uint64_t milliseconds) { current += milliseconds; }
+    private:
+        /* Member variables/attributes */
+        uint64_t current;
+};
+
+} // oodles
+
+#endif
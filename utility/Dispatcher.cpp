@@ -3,11 +3,60 @@
 
 // Boost.bind
 #include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+// Boost.threads
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 // Boost
 using boost::bind;
+using boost::mutex;
+using boost::function;
+using boost::shared_ptr;
+using boost::unique_lock;
 using boost::asio::io_service;
 
+namespace {
+
+/*
+ * Shared by the caller of fork_join() and the helpers it posts. Helpers
+ * that are only run once the join has begun must not run the task as its
+ * arguments may no longer be valid.
+ */
+struct Join
+{
+    mutex guard;
+    boost::condition_variable done;
+    size_t active;
+    bool closed;
+
+    Join() : active(0), closed(false) {}
+};
+
+void
+help(shared_ptr<Join> j, function<void ()> task)
+{
+    {
+        const boost::lock_guard<mutex> lock(j->guard);
+
+        if (j->closed)
+            return;
+
+        ++j->active;
+    }
+
+    task();
+
+    const boost::lock_guard<mutex> lock(j->guard);
+
+    if (--j->active == 0)
+        j->done.notify_one();
+}
+
+} // anonymous
+
 namespace oodles {
 
 Dispatcher::Dispatcher(size_t threads) : running(false), work(ios)
@@ -41,6 +90,29 @@ Dispatcher::wait()
 {
     threads.join_all();
 }
+
+/*
+ * Run task on the calling thread and concurrently on up to helpers of the
+ * Dispatcher threads, returning once every running instance has completed.
+ * The caller always takes part so no progress depends on a free thread; any
+ * helper not yet started when the caller finishes is simply cancelled.
+ */
+void
+Dispatcher::fork_join(const function<void ()> &task, size_t helpers)
+{
+    shared_ptr<Join> j(new Join);
+
+    for (size_t i = 0 ; i < helpers ; ++i)
+        ios.post(bind(&help, j, task));
+
+    task();
+
+    unique_lock<mutex> lock(j->guard);
+    j->closed = true;
+
+    while (j->active > 0)
+        j->done.wait(lock);
+}
  
 } // oodles
 
@@ -7,6 +7,9 @@
 // Boost.threads
 #include <boost/thread/thread.hpp>
 
+// Boost.function
+#include <boost/function.hpp>
+
 namespace oodles {
 
 class Dispatcher
@@ -18,7 +21,10 @@ class Dispatcher
 
         void stop();
         void wait();
+        void fork_join(const boost::function<void ()> &task, size_t helpers);
+
         bool stopped() const { return !running; }
+        size_t size() const { return threads.size(); }
         boost::asio::io_service& io_service() { return ios; }
     private:
         /* Member variables/attributes */
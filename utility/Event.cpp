@@ -3,9 +3,6 @@
 #include "Publisher.hpp"
 #include "Subscriber.hpp"
 
-// STL
-using std::set;
-
 namespace oodles {
 namespace event {
 
@@ -17,13 +14,11 @@ Event::Event()
 
 Event::~Event()
 {
-    set<Subscriber*>::iterator i = subscribers.begin(), j = subscribers.end();
-
-    while (i != j) {
-        Subscriber &s = *(*i);
-        remove_subscriber(s);
-        ++i;
-    }
+    /*
+     * remove_subscriber() erases from subscribers, so always take the first
+     */
+    while (!subscribers.empty())
+        remove_subscriber(**subscribers.begin());
 }
 
 void
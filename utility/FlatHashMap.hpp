@@ -0,0 +1,140 @@
+#ifndef OODLES_FLATHASHMAP_HPP // Interface
+#define OODLES_FLATHASHMAP_HPP
+
+// oodles
+#include "hash.hpp" // For HAS_64_BITS
+
+// STL
+#include <vector>
+#include <utility>
+
+// libc
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint8_t
+
+namespace oodles {
+
+/*
+ * An open addressing hash table with linear, robin hood probing (Celis).
+ * Entries are held in one flat array, in place of a node allocated per
+ * entry, with a parallel array of one byte per slot giving the distance of
+ * its entry from the slot it hashed to (0 for an empty slot). An insertion
+ * takes the slot of any entry nearer its own home so probe sequences stay
+ * short and a lookup may stop as soon as it meets an entry nearer its home
+ * than the key sought would be. An erasure shifts the entries following
+ * back a slot, so no tombstones are needed and the table never degrades.
+ *
+ * The hash of Hash is spread with a multiplicative (Fibonacci) hash so
+ * keys that are already hashes, such as URL ids, may be passed straight
+ * through. Key and T must be default constructible and copyable.
+ */
+template<class Key, class T, class Hash>
+class FlatHashMap
+{
+    public:
+        /* Dependent typedefs */
+        typedef std::pair<Key, T> value_type;
+
+        /*
+         * Visits every entry in no particular order; invalidated by any
+         * insert() or erase().
+         */
+        class const_iterator
+        {
+            public:
+                const_iterator(const FlatHashMap &m, size_t slot) :
+                    map(&m),
+                    slot(slot)
+                {
+                    skip();
+                }
+
+                const value_type& operator* () const
+                {
+                    return map->slots[slot];
+                }
+
+                const value_type* operator-> () const
+                {
+                    return &map->slots[slot];
+                }
+
+                const_iterator& operator++ ()
+                {
+                    ++slot;
+                    skip();
+                    return *this;
+                }
+
+                bool operator== (const const_iterator &i) const
+                {
+                    return slot == i.slot;
+                }
+
+                bool operator!= (const const_iterator &i) const
+                {
+                    return slot != i.slot;
+                }
+            private:
+                void skip() // To the next slot holding an entry, if any
+                {
+                    while (slot < map->slots.size() && !map->probes[slot])
+                        ++slot;
+                }
+
+                const FlatHashMap *map;
+                size_t slot;
+        };
+
+        /* Member functions/methods */
+        FlatHashMap(size_t capacity = 0, const Hash &h = Hash());
+
+        const_iterator begin() const { return const_iterator(*this, 0); }
+        const_iterator end() const
+        {
+            return const_iterator(*this, slots.size());
+        }
+
+        T* find(const Key &k); // NULL if k is absent
+        const T* find(const Key &k) const;
+        bool insert(const Key &k, const T &v); // False if k is present
+        bool erase(const Key &k);
+        void reserve(size_t n);
+        void clear();
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        size_t capacity() const { return slots.size(); }
+        size_t memory() const; // Bytes used by the table
+    private:
+        /* Internal Data Structures */
+        enum {
+            MinSlots = 16,
+            MaxProbe = 0xff, // Largest distance (+ 1) held in a probe
+            LoadNumerator = 7, // Grow beyond 7/8 full
+            LoadDenominator = 8
+        };
+
+        /* Member variables/attributes */
+        std::vector<uint8_t> probes; // Distance (+ 1) of each entry from home
+        std::vector<value_type> slots;
+        size_t count; // No. of entries held
+        size_t mask; // No. of slots - 1
+        int shift; // Bits of the spread hash to discard for a slot
+        Hash hasher;
+
+        /* Member functions/methods */
+        size_t home(const Key &k) const;
+        size_t locate(const Key &k) const; // Slot of k or capacity()
+        void place(value_type v);
+        void rehash(size_t n);
+
+        /* Friend class declarations */
+        friend class const_iterator; // Accesses slots & probes
+};
+
+} // oodles
+
+#include "FlatHashMap.ipp" // Implementation
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef OODLES_FLATHASHMAP_IPP // Implementation
+#define OODLES_FLATHASHMAP_IPP
+
+namespace oodles {
+
+template<class Key, class T, class Hash>
+FlatHashMap<Key, T, Hash>::FlatHashMap(size_t capacity, const Hash &h) :
+    count(0),
+    mask(0),
+    shift(0),
+    hasher(h)
+{
+    rehash(MinSlots);
+    reserve(capacity);
+}
+
+template<class Key, class T, class Hash>
+T*
+FlatHashMap<Key, T, Hash>::find(const Key &k)
+{
+    const size_t i = locate(k);
+    return i < slots.size() ? &slots[i].second : NULL;
+}
+
+template<class Key, class T, class Hash>
+const T*
+FlatHashMap<Key, T, Hash>::find(const Key &k) const
+{
+    const size_t i = locate(k);
+    return i < slots.size() ? &slots[i].second : NULL;
+}
+
+/*
+ * An existing entry for k is left as it is
+ */
+template<class Key, class T, class Hash>
+bool
+FlatHashMap<Key, T, Hash>::insert(const Key &k, const T &v)
+{
+    if (locate(k) < slots.size())
+        return false;
+
+    if ((count + 1) * LoadDenominator > slots.size() * LoadNumerator)
+        rehash(slots.size() * 2);
+
+    place(value_type(k, v));
+    ++count;
+
+    return true;
+}
+
+/*
+ * The entries following k's, up to an empty slot or one at home, are each
+ * shifted back a slot into the gap it leaves.
+ */
+template<class Key, class T, class Hash>
+bool
+FlatHashMap<Key, T, Hash>::erase(const Key &k)
+{
+    size_t i = locate(k);
+
+    if (i == slots.size())
+        return false;
+
+    for (size_t j = (i + 1) & mask ; probes[j] > 1 ; j = (j + 1) & mask) {
+        slots[i] = slots[j];
+        probes[i] = probes[j] - 1;
+        i = j;
+    }
+
+    slots[i] = value_type(); // Release anything the entry held
+    probes[i] = 0;
+    --count;
+
+    return true;
+}
+
+/*
+ * Make room for n entries without further growth
+ */
+template<class Key, class T, class Hash>
+void
+FlatHashMap<Key, T, Hash>::reserve(size_t n)
+{
+    size_t capacity = slots.size();
+
+    while (n * LoadDenominator > capacity * LoadNumerator)
+        capacity *= 2;
+
+    if (capacity > slots.size())
+        rehash(capacity);
+}
+
+template<class Key, class T, class Hash>
+void
+FlatHashMap<Key, T, Hash>::clear()
+{
+    std::vector<uint8_t>().swap(probes);
+    std::vector<value_type>().swap(slots);
+    count = 0;
+    rehash(MinSlots);
+}
+
+template<class Key, class T, class Hash>
+size_t
+FlatHashMap<Key, T, Hash>::memory() const
+{
+    return sizeof(*this) + probes.capacity() +
+           slots.capacity() * sizeof(value_type);
+}
+
+// Private methods
+
+template<class Key, class T, class Hash>
+size_t
+FlatHashMap<Key, T, Hash>::home(const Key &k) const
+{
+#ifdef HAS_64_BITS
+    static const size_t golden = 11400714819323198485U; // 2^64 / phi
+#else
+    static const size_t golden = 2654435769U; // 2^32 / phi
+#endif
+
+    return (static_cast<size_t>(hasher(k)) * golden) >> shift;
+}
+
+template<class Key, class T, class Hash>
+size_t
+FlatHashMap<Key, T, Hash>::locate(const Key &k) const
+{
+    size_t i = home(k);
+
+    /*
+     * Once an entry nearer its home than k would be is met, k is absent;
+     * it would have taken that entry's slot. An empty slot (0) is nearest.
+     */
+    for (unsigned int d = 1 ; probes[i] >= d ; ++d, i = (i + 1) & mask)
+        if (slots[i].first == k)
+            return i;
+
+    return slots.size();
+}
+
+/*
+ * Robin hood insertion of v, which must be absent, from its home slot
+ */
+template<class Key, class T, class Hash>
+void
+FlatHashMap<Key, T, Hash>::place(value_type v)
+{
+    size_t i = home(v.first);
+    unsigned int d = 1;
+
+    for ( ; probes[i] != 0 ; ++d, i = (i + 1) & mask) {
+        if (d >= MaxProbe) { // Pathological clustering; spread it out
+            rehash(slots.size() * 2);
+            place(v);
+            return;
+        }
+
+        if (probes[i] < d) { // Take from the richer entry, carry it on
+            const unsigned int e = probes[i];
+
+            std::swap(slots[i], v);
+            probes[i] = d;
+            d = e;
+        }
+    }
+
+    slots[i] = v;
+    probes[i] = d;
+}
+
+/*
+ * Re-place every entry into n slots, a power of two
+ */
+template<class Key, class T, class Hash>
+void
+FlatHashMap<Key, T, Hash>::rehash(size_t n)
+{
+    std::vector<uint8_t> old_probes(n, 0);
+    std::vector<value_type> old_slots(n);
+
+    old_probes.swap(probes);
+    old_slots.swap(slots);
+    mask = n - 1;
+    shift = sizeof(size_t) * 8;
+
+    while (n > 1) {
+        --shift;
+        n >>= 1;
+    }
+
+    for (size_t i = 0 ; i < old_slots.size() ; ++i)
+        if (old_probes[i] != 0)
+            place(old_slots[i]);
+}
+
+} // oodles
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef OODLES_MPSCQUEUE_HPP // Interface
+#define OODLES_MPSCQUEUE_HPP
+
+// libc
+#include <stddef.h> // For size_t
+
+namespace oodles {
+
+/*
+ * A lock-free, intrusive queue for many producers and a single consumer.
+ * T must have a member 'T *next' which the queue owns whilst T is queued;
+ * nothing is allocated by the queue itself.
+ *
+ * Producers push onto the head of a singly linked stack with a CAS. The
+ * consumer never takes one item but the whole stack at once, swapping the
+ * head for NULL, and reverses it; each batch drained is in the order it
+ * was pushed. As no node is ever popped from under a producer there is
+ * no ABA problem.
+ */
+template<class T>
+class MPSCQueue
+{
+    public:
+        /* Member functions/methods */
+        MPSCQueue() : head(NULL), count(0) {}
+
+        /*
+         * Any thread. Returns the no. of items queued, t included.
+         */
+        size_t push(T *t);
+
+        /*
+         * The consumer only. Returns every item queued, oldest first, as a
+         * list linked by next (NULL if there are none) and its length in n.
+         */
+        T* drain(size_t &n);
+
+        size_t size() const { return count; } // Approximate
+        bool empty() const { return head == NULL; }
+    private:
+        /* Member variables/attributes */
+        T * volatile head; // Most recently pushed
+        volatile size_t count;
+
+        /* Member functions/methods */
+        MPSCQueue(const MPSCQueue &q); // Do not allow...
+        MPSCQueue& operator= (const MPSCQueue &q); // ... copying.
+};
+
+} // oodles
+
+#include "MPSCQueue.ipp" // Implementation
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef OODLES_MPSCQUEUE_IPP // Implementation
+#define OODLES_MPSCQUEUE_IPP
+
+namespace oodles {
+
+template<class T>
+size_t
+MPSCQueue<T>::push(T *t)
+{
+    T *h = NULL;
+
+    do {
+        h = head;
+        t->next = h;
+    } while (!__sync_bool_compare_and_swap(&head, h, t));
+
+    return __sync_add_and_fetch(&count, 1);
+}
+
+template<class T>
+T*
+MPSCQueue<T>::drain(size_t &n)
+{
+    T *h = NULL, *r = NULL;
+
+    do {
+        h = head;
+    } while (h &&
+             !__sync_bool_compare_and_swap(&head, h, static_cast<T*>(NULL)));
+
+    for (n = 0 ; h ; ++n) { // Newest first to oldest first
+        T *next = h->next;
+
+        h->next = r;
+        r = h;
+        h = next;
+    }
+
+    __sync_sub_and_fetch(&count, n);
+
+    return r;
+}
+
+} // oodles
+
+#endif
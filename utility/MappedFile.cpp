@@ -0,0 +1,55 @@
+// oodles
+#include "MappedFile.hpp"
+
+// libc
+#include <fcntl.h> // For open()
+#include <unistd.h> // For close()
+#include <sys/mman.h> // For mmap()
+#include <sys/stat.h> // For fstat()
+
+// STL
+using std::string;
+
+namespace oodles {
+
+MappedFile::MappedFile(const string &path) throw (OpenError) :
+    address(NULL),
+    length(0)
+{
+    struct stat s;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1)
+        throw OpenError("MappedFile::MappedFile", errno,
+                        "Failed to open %s for reading.", path.c_str());
+
+    if (fstat(fd, &s) == -1) {
+        const int e = errno;
+        ::close(fd);
+        throw OpenError("MappedFile::MappedFile", e,
+                        "Failed to stat %s.", path.c_str());
+    }
+
+    if ((length = s.st_size) > 0) {
+        address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (address == MAP_FAILED) {
+            const int e = errno;
+            ::close(fd);
+            throw OpenError("MappedFile::MappedFile", e,
+                            "Failed to map %s into memory.", path.c_str());
+        }
+
+        madvise(address, length, MADV_SEQUENTIAL); // Advisory only
+    }
+
+    ::close(fd); // The mapping remains valid
+}
+
+MappedFile::~MappedFile()
+{
+    if (address)
+        munmap(address, length);
+}
+
+} // oodles
@@ -0,0 +1,37 @@
+#ifndef OODLES_MAPPEDFILE_HPP
+#define OODLES_MAPPEDFILE_HPP
+
+// oodles
+#include "common/Exceptions.hpp"
+
+// STL
+#include <string>
+
+namespace oodles {
+
+/*
+ * Read-only, private memory mapping of an entire file. The mapping is
+ * released when the instance goes out of scope.
+ */
+class MappedFile
+{
+    public:
+        /* Member functions/methods */
+        MappedFile(const std::string &path) throw (OpenError);
+        ~MappedFile();
+
+        size_t size() const { return length; }
+        const char* data() const { return static_cast<const char*>(address); }
+    private:
+        /* Member variables/attributes */
+        void *address;
+        size_t length;
+
+        /* Member functions/methods */
+        MappedFile(const MappedFile &m); // Do not allow...
+        MappedFile& operator= (const MappedFile &m); // ... copying.
+};
+
+} // oodles
+
+#endif
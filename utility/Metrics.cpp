@@ -0,0 +1,437 @@
+// oodles
+#include "Metrics.hpp"
+#include "common/Exceptions.hpp"
+
+// Boost.thread
+#include <boost/thread/locks.hpp>
+
+// STL
+#include <new>
+
+// libc
+#include <string.h> // For memcpy(), memset()
+#include <stdlib.h> // For posix_memalign(), free()
+
+// STL
+using std::map;
+using std::string;
+using std::ostream;
+
+// Boost
+using boost::lock_guard;
+
+namespace {
+
+/*
+ * Returns name with suffix added to its family, ahead of any labels
+ */
+string
+suffixed(const string &name, const char *suffix)
+{
+    const size_t i = name.find('{');
+
+    if (i == string::npos)
+        return name + suffix;
+
+    return name.substr(0, i) + suffix + name.substr(i);
+}
+
+void
+write_json_string(ostream &s, const string &v)
+{
+    s << '"';
+
+    for (size_t i = 0 ; i < v.size() ; ++i) {
+        if (v[i] == '"' || v[i] == '\\')
+            s << '\\';
+
+        s << v[i];
+    }
+
+    s << '"';
+}
+
+inline
+uint64_t
+bits_of(double v)
+{
+    uint64_t b = 0;
+
+    memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+inline
+double
+double_of(uint64_t b)
+{
+    double v = 0;
+
+    memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+} // anonymous
+
+namespace oodles {
+namespace metrics {
+
+/*
+ * Each thread is handed the next shard the first time it asks; the shard
+ * is then kept thread local so it costs no more than a load thereafter.
+ */
+size_t
+shard()
+{
+    static size_t handed = 0;
+    static __thread size_t mine = 0; // Its shard + 1, or 0 if none yet
+
+    if (!mine)
+        mine = __sync_fetch_and_add(&handed, 1) % Shards + 1;
+
+    return mine - 1;
+}
+
+std::string
+labelled(const string &name, const string &label, const string &value)
+{
+    const string l(label + "=\"" + value + '"');
+
+    if (name.empty() || name[name.size() - 1] != '}')
+        return name + '{' + l + '}';
+
+    return name.substr(0, name.size() - 1) + ',' + l + '}';
+}
+
+// Metric
+Metric::Metric(const string &name, const string &help) : id(name), text(help)
+{
+}
+
+string
+Metric::family() const
+{
+    return id.substr(0, id.find('{'));
+}
+
+// Counter
+Counter::Counter(const string &name, const string &help) : Metric(name, help)
+{
+    memset(cells, 0, sizeof(cells));
+}
+
+uint64_t
+Counter::value() const
+{
+    uint64_t v = 0;
+
+    for (size_t i = 0 ; i < Shards ; ++i)
+        v += cells[i].value;
+
+    return v;
+}
+
+void
+Counter::write_text(ostream &s) const
+{
+    s << name() << ' ' << value() << '\n';
+}
+
+void
+Counter::write_json(ostream &s) const
+{
+    s << value();
+}
+
+// Gauge
+Gauge::Gauge(const string &name, const string &help) :
+    Metric(name, help),
+    bits(bits_of(0))
+{
+}
+
+void
+Gauge::set(double v)
+{
+    bits = bits_of(v); // An aligned 64 bit store is atomic
+}
+
+void
+Gauge::add(double d)
+{
+    uint64_t b = bits;
+
+    while (!__sync_bool_compare_and_swap(&bits, b, bits_of(double_of(b) + d)))
+        b = bits;
+}
+
+double
+Gauge::value() const
+{
+    return double_of(bits);
+}
+
+void
+Gauge::write_text(ostream &s) const
+{
+    s << name() << ' ' << value() << '\n';
+}
+
+void
+Gauge::write_json(ostream &s) const
+{
+    s << value();
+}
+
+// Histogram
+Histogram::Histogram(const string &name, const string &help) :
+    Metric(name, help),
+    shards(NULL)
+{
+    void *p = NULL;
+
+    if (posix_memalign(&p, Line, Shards * sizeof(Shard)) != 0)
+        throw std::bad_alloc();
+
+    memset(p, 0, Shards * sizeof(Shard));
+    shards = static_cast<Shard*>(p);
+}
+
+Histogram::~Histogram()
+{
+    free(shards);
+}
+
+void
+Histogram::record(uint64_t v)
+{
+    Shard &s = shards[shard()];
+
+    __sync_add_and_fetch(&s.buckets[bucket(v)], 1);
+    __sync_add_and_fetch(&s.sum, v);
+    __sync_add_and_fetch(&s.count, 1);
+}
+
+uint64_t
+Histogram::count() const
+{
+    uint64_t n = 0;
+
+    for (size_t i = 0 ; i < Shards ; ++i)
+        n += shards[i].count;
+
+    return n;
+}
+
+uint64_t
+Histogram::sum() const
+{
+    uint64_t n = 0;
+
+    for (size_t i = 0 ; i < Shards ; ++i)
+        n += shards[i].sum;
+
+    return n;
+}
+
+/*
+ * The shards are read as they're updated so the buckets summed may be a
+ * few values ahead of, or behind, the count; only the buckets are used.
+ */
+uint64_t
+Histogram::quantile(double q) const
+{
+    uint64_t buckets[Buckets], n = 0, seen = 0;
+
+    merge(buckets);
+
+    for (size_t b = 0 ; b < Buckets ; ++b)
+        n += buckets[b];
+
+    if (n == 0)
+        return 0;
+
+    const uint64_t rank = static_cast<uint64_t>(q * (n - 1)) + 1;
+
+    for (size_t b = 0 ; b < Buckets ; ++b)
+        if ((seen += buckets[b]) >= rank)
+            return highest(b);
+
+    return highest(Buckets - 1);
+}
+
+/*
+ * Values below Sub have a bucket each; every larger value v, whose highest
+ * bit set is e, falls in the sub-bucket given by its SubBits bits below e.
+ */
+size_t
+Histogram::bucket(uint64_t v)
+{
+    if (v < Sub)
+        return v;
+
+    const size_t e = 63 - __builtin_clzll(v);
+
+    return (e - SubBits + 1) * Sub + ((v >> (e - SubBits)) & (Sub - 1));
+}
+
+uint64_t
+Histogram::lowest(size_t b)
+{
+    if (b < Sub)
+        return b;
+
+    const size_t e = b / Sub + SubBits - 1;
+
+    return static_cast<uint64_t>(Sub + b % Sub) << (e - SubBits);
+}
+
+uint64_t
+Histogram::highest(size_t b)
+{
+    if (b < Sub)
+        return b;
+
+    const size_t e = b / Sub + SubBits - 1;
+
+    return lowest(b) + ((static_cast<uint64_t>(1) << (e - SubBits)) - 1);
+}
+
+void
+Histogram::write_text(ostream &s) const
+{
+    static const char *quantiles[] = {"0.5", "0.9", "0.99", "1"};
+    static const double values[] = {0.5, 0.9, 0.99, 1};
+
+    for (size_t i = 0 ; i < sizeof(values) / sizeof(values[0]) ; ++i)
+        s << labelled(name(), "quantile", quantiles[i]) << ' '
+          << quantile(values[i]) << '\n';
+
+    s << suffixed(name(), "_sum") << ' ' << sum() << '\n'
+      << suffixed(name(), "_count") << ' ' << count() << '\n';
+}
+
+void
+Histogram::write_json(ostream &s) const
+{
+    s << "{\"count\": " << count()
+      << ", \"sum\": " << sum()
+      << ", \"p50\": " << quantile(0.5)
+      << ", \"p90\": " << quantile(0.9)
+      << ", \"p99\": " << quantile(0.99)
+      << ", \"max\": " << quantile(1) << '}';
+}
+
+void
+Histogram::merge(uint64_t *buckets) const
+{
+    memset(buckets, 0, Buckets * sizeof(uint64_t));
+
+    for (size_t i = 0 ; i < Shards ; ++i)
+        for (size_t b = 0 ; b < Buckets ; ++b)
+            buckets[b] += shards[i].buckets[b];
+}
+
+// Registry
+Registry::~Registry()
+{
+    for (map<string, Metric*>::iterator i = metrics.begin() ;
+         i != metrics.end() ; ++i)
+        delete i->second;
+}
+
+Counter&
+Registry::counter(const string &name, const string &help)
+{
+    return find<Counter>(name, help);
+}
+
+Gauge&
+Registry::gauge(const string &name, const string &help)
+{
+    return find<Gauge>(name, help);
+}
+
+Histogram&
+Registry::histogram(const string &name, const string &help)
+{
+    return find<Histogram>(name, help);
+}
+
+/*
+ * Metrics are held in order of family, then labels, so those of a family
+ * are adjacent and share a HELP and TYPE line.
+ */
+void
+Registry::write_text(ostream &s) const
+{
+    const lock_guard<boost::mutex> lock(mutex);
+    string last;
+
+    for (map<string, Metric*>::const_iterator i = metrics.begin() ;
+         i != metrics.end() ; ++i)
+    {
+        const Metric &m = *i->second;
+        const string f(m.family());
+
+        if (f != last) {
+            s << "# HELP " << f << ' ' << m.help() << '\n'
+              << "# TYPE " << f << ' ' << m.type() << '\n';
+            last = f;
+        }
+
+        m.write_text(s);
+    }
+}
+
+void
+Registry::write_json(ostream &s) const
+{
+    const lock_guard<boost::mutex> lock(mutex);
+
+    s << '{';
+
+    for (map<string, Metric*>::const_iterator i = metrics.begin() ;
+         i != metrics.end() ; ++i)
+    {
+        s << (i == metrics.begin() ? "\n  " : ",\n  ");
+        write_json_string(s, i->second->name());
+        s << ": ";
+        i->second->write_json(s);
+    }
+
+    s << "\n}\n";
+}
+
+Registry&
+Registry::global()
+{
+    static Registry metrics;
+    return metrics;
+}
+
+template<class T>
+T&
+Registry::find(const string &name, const string &help)
+{
+    const lock_guard<boost::mutex> lock(mutex);
+    const size_t labels = name.find('{');
+    Metric *&m = metrics[labels == string::npos ?
+                         name :
+                         name.substr(0, labels) + ' ' + name.substr(labels)];
+
+    if (!m)
+        m = new T(name, help);
+
+    T *t = dynamic_cast<T*>(m);
+
+    if (!t)
+        throw TypeError("Registry::find", 0,
+                        "Metric '%s' is already a %s.",
+                        name.c_str(), m->type());
+
+    return *t;
+}
+
+} // metrics
+} // oodles
@@ -0,0 +1,201 @@
+#ifndef OODLES_METRICS_HPP
+#define OODLES_METRICS_HPP
+
+// Boost.thread
+#include <boost/thread/mutex.hpp>
+
+// STL
+#include <map>
+#include <string>
+#include <iostream>
+
+// libc
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint64_t
+
+namespace oodles {
+namespace metrics {
+
+/*
+ * Metrics are updated by many threads without taking a lock. Counters and
+ * histograms are split into shards, each on cache lines of its own; every
+ * thread adds into the shard it was handed when it first touched a metric
+ * and the shards are only summed when the metric is read. Threads beyond
+ * the first Shards share shards, which they update atomically all the same.
+ */
+enum {
+    Shards = 16,
+    Line = 64 // Bytes per cache line
+};
+
+size_t shard(); // That of the calling thread
+
+class Metric
+{
+    public:
+        /* Member functions/methods */
+        Metric(const std::string &name, const std::string &help);
+        virtual ~Metric() {}
+
+        const std::string& name() const { return id; }
+        const std::string& help() const { return text; }
+        std::string family() const; // The name without its labels
+
+        virtual const char* type() const = 0; // As the text format has it
+        virtual void write_text(std::ostream &s) const = 0;
+        virtual void write_json(std::ostream &s) const = 0;
+    private:
+        /* Member variables/attributes */
+        const std::string id, text;
+};
+
+/*
+ * A count that only ever rises
+ */
+class Counter : public Metric
+{
+    public:
+        /* Member functions/methods */
+        Counter(const std::string &name, const std::string &help);
+
+        void add(uint64_t n = 1)
+        {
+            __sync_add_and_fetch(&cells[shard()].value, n);
+        }
+
+        uint64_t value() const;
+
+        const char* type() const { return "counter"; }
+        void write_text(std::ostream &s) const;
+        void write_json(std::ostream &s) const;
+    private:
+        /* Internal Data Structures */
+        struct Cell
+        {
+            uint64_t value;
+            char padding[Line - sizeof(uint64_t)];
+        };
+
+        /* Member variables/attributes */
+        Cell cells[Shards];
+};
+
+/*
+ * A value that is set, or moved either way, as whatever it tracks changes
+ */
+class Gauge : public Metric
+{
+    public:
+        /* Member functions/methods */
+        Gauge(const std::string &name, const std::string &help);
+
+        void set(double v);
+        void add(double d);
+        double value() const;
+
+        const char* type() const { return "gauge"; }
+        void write_text(std::ostream &s) const;
+        void write_json(std::ostream &s) const;
+    private:
+        /* Member variables/attributes */
+        volatile uint64_t bits; // Of the double, so it can be swapped
+};
+
+/*
+ * The distribution of values recorded, such as latencies, in log-linear
+ * buckets: each power of two is split into Sub buckets of equal width so
+ * any value is known to within 1/Sub of itself, from 0 to 2^64 - 1.
+ */
+class Histogram : public Metric
+{
+    public:
+        /* Dependent typedefs */
+        enum {
+            SubBits = 3,
+            Sub = 1 << SubBits,
+            Buckets = (64 - SubBits + 1) * Sub
+        };
+
+        /* Member functions/methods */
+        Histogram(const std::string &name, const std::string &help);
+        ~Histogram();
+
+        void record(uint64_t v);
+
+        uint64_t count() const;
+        uint64_t sum() const;
+        uint64_t quantile(double q) const; // Highest value of its bucket
+
+        static size_t bucket(uint64_t v);
+        static uint64_t lowest(size_t b); // Value held by bucket b
+        static uint64_t highest(size_t b);
+
+        const char* type() const { return "summary"; }
+        void write_text(std::ostream &s) const;
+        void write_json(std::ostream &s) const;
+    private:
+        /* Internal Data Structures */
+        struct Shard
+        {
+            uint64_t count, sum;
+            uint64_t buckets[Buckets];
+            char padding[Line - (2 + Buckets) * sizeof(uint64_t) % Line];
+        };
+
+        /* Member variables/attributes */
+        Shard *shards; // Line aligned, Shards of them
+
+        /* Member functions/methods */
+        void merge(uint64_t *buckets) const;
+
+        Histogram(const Histogram &h); // Do not allow...
+        Histogram& operator= (const Histogram &h); // ... copying.
+};
+
+/*
+ * Every metric of the process by name, which may carry labels such as
+ * crawler_assigned{crawler="a"}; see labelled(). Metrics are created on
+ * first use and live as long as the Registry so a reference to one may be
+ * kept, and should be where it's updated often: finding a metric takes a
+ * lock whereas updating it never does.
+ */
+class Registry
+{
+    public:
+        /* Member functions/methods */
+        Registry() {}
+        ~Registry();
+
+        Counter& counter(const std::string &name, const std::string &help);
+        Gauge& gauge(const std::string &name, const std::string &help);
+        Histogram& histogram(const std::string &name, const std::string &help);
+
+        void write_text(std::ostream &s) const; // Prometheus text format
+        void write_json(std::ostream &s) const; // An object keyed by name
+
+        static Registry& global(); // Of the process
+    private:
+        /* Member variables/attributes */
+        std::map<std::string, Metric*> metrics; // By family, ' ', labels
+        mutable boost::mutex mutex; // Held to add to or walk metrics
+
+        /* Member functions/methods */
+        template<class T> T& find(const std::string &name,
+                                  const std::string &help);
+
+        Registry(const Registry &r); // Do not allow...
+        Registry& operator= (const Registry &r); // ... copying.
+};
+
+/*
+ * Returns name{label="value"}, or name with label="value" added to those
+ * it already has
+ */
+std::string labelled(const std::string &name,
+                     const std::string &label,
+                     const std::string &value);
+
+} // metrics
+} // oodles
+
+#endif
@@ -4,10 +4,6 @@
 // oodles
 #include "NodeIO.hpp"
 #include "NodeBase.hpp"
-#include "IndexedSet.hpp"
-
-// STL
-#include <functional>
 
 namespace oodles {
 
@@ -19,11 +15,6 @@ class Node : public NodeBase
     public:
         /* Member functions/methods */
         Node* create_child(const T &v, path_index_t i);
-
-        NodeBase& child(size_t i) { return *children[i]; }
-        const NodeBase& child(size_t i) const { return *children[i]; }
-
-        size_t size() const { return children.size(); }
         void print(std::ostream &s, const io::PrinterBase &p) const;
 
         /* Member variables/attributes */
@@ -36,20 +27,9 @@ class Node : public NodeBase
         virtual void visit();
         virtual Node* new_node(const T &v) const;
     private:
-        /* Internal Data Structures */
-        struct KeyCmp : public std::binary_function<NodeBase, NodeBase, bool>
-        {
-            bool operator() (const NodeBase *lhs, const NodeBase *rhs) const
-            {
-                const Node<T> &l = *lhs, &r = *rhs;
-                return l.value < r.value;
-            }
-        };
-
-        /* Member variables/attributes */
-        IndexedSet<NodeBase*, KeyCmp> children;
-
         /* Member functions/methods */
+        const T& key(size_t k) const; // Value of the k-th child in key order
+
         Node();
         Node(const Node &n); // Do not allow...
         Node& operator=(const Node &n); // ... copying presently.
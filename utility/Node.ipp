@@ -3,7 +3,6 @@
 
 // STL
 #include <typeinfo>
-#include <algorithm>
 
 namespace oodles {
 
@@ -14,25 +13,34 @@ template<class T>
 Node<T>*
 Node<T>::create_child(const T &v, path_index_t i)
 {
-    Node *n = new_node(v);
-    const std::pair<size_t, bool> x(children.insert(n));
+    size_t b = 0, e = children.size();
+
+    while (b < e) { // Locate the first child whose value is not below v
+        const size_t m = b + (e - b) / 2;
+
+        if (key(m) < v)
+            b = m + 1;
+        else
+            e = m;
+    }
 
-    if (!x.second) {
+    if (b < children.size() && !(v < key(b))) {
         /*
          * Node with value v already existed - return it.
          */
-        Node &r = child(x.first);
-        delete n;
-        n = &r;
-    } else {
-        /*
-         * Node with value v is new - initialise it.
-         */
-        n->path_idx = i;
-        n->parent = this;
-        n->child_idx = x.first;
+        return static_cast<Node*>(children[children.ordered(b)]);
     }
 
+    /*
+     * Node with value v is new - initialise it.
+     */
+    Node *n = new_node(v);
+
+    n->path_idx = i;
+    n->parent = this;
+    n->child_idx = children.size();
+    children.insert(n, b);
+
     return n;
 }
  
@@ -69,7 +77,7 @@ Node<T>::print(std::ostream &s, const io::PrinterBase &p) const
  * Protected methods
  */
 template<class T>
-Node<T>::Node(const T &v) : NodeBase(), value(v), children(true)
+Node<T>::Node(const T &v) : NodeBase(), value(v)
 {
 }
 
@@ -100,7 +108,15 @@ Node<T>::new_node(const T &v) const
  * Private methods
  */
 template<class T>
-Node<T>::Node() : children(true)
+inline
+const T&
+Node<T>::key(size_t k) const
+{
+    return static_cast<const Node*>(children[children.ordered(k)])->value;
+}
+
+template<class T>
+Node<T>::Node()
 {
 }
 
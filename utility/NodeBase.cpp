@@ -4,15 +4,17 @@
 namespace oodles {
 
 NodeBase::NodeBase() :
-    visit_state(Green),
     parent(NULL),
+    child_idx(0),
     path_idx(0),
-    child_idx(0)
+    visit_state(Green)
 {
 }
 
 NodeBase::~NodeBase()
 {
+    for (size_t i = 0 ; i < children.size() ; ++i)
+        delete children[i];
 }
 
 } // oodles
@@ -1,11 +1,14 @@
 #ifndef OODLES_NODEBASE_HPP
 #define OODLES_NODEBASE_HPP
 
+// oodles
+#include "ChildArray.hpp"
+
 // STL
 #include <iostream>
 
 // libc
-#include <stdint.h> // For int16_t
+#include <stdint.h> // For int8_t, int16_t
 
 namespace oodles {
 namespace io {
@@ -18,7 +21,8 @@ class PrinterBase; // Forward declration for Node
  * Bare-bones base class for any Node type.
  * It must remain non-templated and defines
  * only necessary, common place methods and
- * attributes.
+ * attributes. The children are held here so
+ * a traversal never needs a virtual call.
  */
 class NodeBase
 {
@@ -31,15 +35,15 @@ class NodeBase
         NodeBase();
         virtual ~NodeBase();
 
+        NodeBase& child(size_t index) { return *children[index]; }
+        const NodeBase& child(size_t index) const { return *children[index]; }
+        size_t size() const { return children.size(); }
+
         /*
          * Ensure this is a pure virtual (abstract) class and
-         * indicate that these methods *must* be provided by
+         * indicate that this method *must* be provided by
          * derived Node types.
          */
-        virtual NodeBase& child(size_t index) = 0;
-        virtual const NodeBase& child(size_t index) const = 0;
-
-        virtual size_t size() const = 0;
         virtual void print(std::ostream &s, const io::PrinterBase &p) const = 0;
 
         bool leaf() const { return parent && size() == 0; }
@@ -65,10 +69,13 @@ class NodeBase
         };
 
         /* Member variables/attributes */
-        int visit_state; // Visitation state
         NodeBase *parent; // Pointer to parent node
-        path_index_t path_idx; // Index of this node within it's path
         child_index_t child_idx; // Index of this node amoung it's siblings
+        path_index_t path_idx; // Index of this node within it's path
+        int8_t visit_state; // Visitation state
+    protected:
+        /* Member variables/attributes */
+        ChildArray children; // By child_idx, each owned by this node
 };
 
 } // oodles
@@ -4,6 +4,13 @@
 #include "BreadCrumbTrail.hpp"
 
 // STL
+#include <vector>
+
+// libc
+#include <assert.h> // For assert()
+
+// STL
+using std::vector;
 using std::ostream;
 
 namespace oodles {
@@ -55,7 +62,11 @@ ASCIIArt::print(ostream &s, const NodeBase &n) const
     return s;
 }
 
-DotMatrix::DotMatrix(const TreeBase &t) : PrinterBase(t), trail(NULL)
+DotMatrix::DotMatrix(const TreeBase &t) :
+    PrinterBase(t),
+    trail(NULL),
+    top(NULL),
+    depth(0)
 {
 }
 
@@ -68,72 +79,110 @@ DotMatrix::set_trail(BreadCrumbTrail &t)
 ostream&
 DotMatrix::print(ostream &s, const NodeBase &n) const
 {
-    /*
-     * Use the pointer addresses as the Node IDs
-     */
-    ptrdiff_t edge[2] = {reinterpret_cast<ptrdiff_t>(&n),
-                         reinterpret_cast<ptrdiff_t>(n.parent)};
+    const NodeBase &r = top ? *top : n;
 
     /*
      * The root node is special, here we can set graph
      * options and begin the graph block DOT expects.
      */
-    if (!n.parent) {
-        s << "digraph oodles {\n\n"
-          << edge[0] << " [label = \"ROOT\"];\n";
-    }
+    s << "digraph oodles {\n\n";
 
-    print_vertex(s, n);
+    if (!r.parent)
+        s << reinterpret_cast<ptrdiff_t>(&r) << " [label = \"ROOT\"];\n";
 
-    if (!trail) {
-        print_edge(s, edge);
+    if (!trail)
+        print_tree(s, r);
+    else
+        print_trail(s, r);
+
+    /*
+     * Terminate the graph block
+     */
+    return s << "}\n";
+}
+
+/*
+ * Every node below r, depth-first (each before its children in order), as
+ * far down as the depth allows.
+ */
+void
+DotMatrix::print_tree(ostream &s, const NodeBase &r) const
+{
+    vector<const NodeBase*> pending(1, &r); // The last is printed next
+
+    while (!pending.empty()) {
+        const NodeBase &n = *pending.back();
 
         /*
-         * Recursively print the child nodes (depth-first traverse)
+         * Use the pointer addresses as the Node IDs
          */
-        for (size_t i = 0 ; i < n.size() ; ++i)
-            print(s, n.child(i));
-    } else if (!trail->empty()) {
-        const NodeBase *p = &n, /* p may get re-assigned here -------------*/
-                       *q = const_cast<DotMatrix*>(this)->node_from_trail(p);
-
-        if (q) {
-            edge[0] = reinterpret_cast<ptrdiff_t>(&(*q));
-            edge[1] = reinterpret_cast<ptrdiff_t>(&(*p));
-            print_edge(s, edge);
-            print(s, *q);
+        const ptrdiff_t edge[2] = {
+            reinterpret_cast<ptrdiff_t>(&n),
+            &n == &r ? 0 : reinterpret_cast<ptrdiff_t>(n.parent)
+        };
+
+        pending.pop_back();
+        print_vertex(s, n);
+        print_edge(s, edge);
+
+        if (depth && n.path_idx - r.path_idx >= depth) {
+            print_cut(s, n);
+            continue;
         }
+
+        for (size_t i = n.size() ; i > 0 ; --i)
+            pending.push_back(&n.child(i - 1));
     }
+}
 
-    /*
-     * Terminate the graph block
-     */
-    if (!n.parent)
-        s << "}\n";
+/*
+ * The nodes visited by a scheduling run in the order they were visited,
+ * each joined to the node it was reached from. The trail always begins at
+ * the root of the tree, only the nodes within r (and the depth) are shown.
+ */
+void
+DotMatrix::print_trail(ostream &s, const NodeBase &r) const
+{
+    const NodeBase *n = &tree.root();
 
-    return s;
+    print_vertex(s, r);
+
+    while (!trail->empty()) {
+        const NodeBase *p = n, /* p may get re-assigned here -------------*/
+                       *q = node_from_trail(p);
+
+        n = q;
+
+        if (!q->parent || !within(*q, r))
+            continue;
+
+        ptrdiff_t edge[2] = {reinterpret_cast<ptrdiff_t>(q),
+                             reinterpret_cast<ptrdiff_t>(p)};
+
+        if (q == &r)
+            edge[1] = 0; // Reached from outside of the subtree
+
+        print_vertex(s, *q);
+        print_edge(s, edge);
+    }
 }
 
 const NodeBase*
-DotMatrix::node_from_trail(const NodeBase *&n)
+DotMatrix::node_from_trail(const NodeBase *&n) const
 {
-    BreadCrumbTrail::Point i = trail->gather_crumb();
-
-    if (!n->parent)
-        i = trail->gather_crumb(); // Discard the root crumb
+    const BreadCrumbTrail::Point i = trail->gather_crumb();
 
     /*
-     * Determine the direction of travel; If the crumb path index is less
-     * than that of the current node path index we're retreating back up
-     * the way we came - back up the path to where we forked (in the road).
+     * Determine the direction of travel; If the crumb path index is no
+     * greater than that of the current node path index we're retreating
+     * back up the way we came - back up the path to where we forked (in the
+     * road), i.e. to the parent of the node the crumb was left at.
      */
-    while (!trail->empty() && i.first < n->path_idx) {
-        i = trail->gather_crumb(); // Gather until we reach the fork
+    while (n->parent && n->path_idx >= i.first)
         n = n->parent;
-    }
 
-    if (trail->empty())
-        return NULL;
+    if (i.first < 0)
+        return n; // The root crumb
 
     /*
      * The crumb point cannot exceed the number of child nodes
@@ -143,6 +192,26 @@ DotMatrix::node_from_trail(const NodeBase *&n)
     return &n->child(i.second); // Next node located by the current crumb
 }
 
+/*
+ * Returns true if n is r or one of its descendants within the depth
+ */
+bool
+DotMatrix::within(const NodeBase &n, const NodeBase &r) const
+{
+    if (depth && n.path_idx - r.path_idx > depth)
+        return false;
+
+    if (!r.parent)
+        return true; // Everything is below the root
+
+    const NodeBase *a = &n;
+
+    while (a && a->path_idx > r.path_idx)
+        a = a->parent;
+
+    return a == &r;
+}
+
 void
 DotMatrix::print_vertex(ostream &s, const NodeBase &n) const
 {
@@ -166,6 +235,22 @@ DotMatrix::print_edge(ostream &s, const ptrdiff_t e[2]) const
     s << ";\n";
 }
 
+/*
+ * Note the no. of children of n that are not shown
+ */
+void
+DotMatrix::print_cut(ostream &s, const NodeBase &n) const
+{
+    if (n.size() == 0)
+        return;
+
+    const ptrdiff_t nid = reinterpret_cast<ptrdiff_t>(&n);
+
+    s << '"' << nid << "+\" [label=\"" << n.size()
+      << " more\", shape=plaintext];\n"
+      << nid << " -> \"" << nid << "+\";\n";
+}
+
 ostream&
 operator<< (ostream &s, const PrinterBase &p)
 {
@@ -50,6 +50,11 @@ class ASCIIArt : public PrinterBase
  * Ha ha ha, see what I did here?
  * Printer for Nodes that outputs
  * in the DOT language format ;)
+ *
+ * The graph is written as the tree (or trail) is walked, without recursion,
+ * so any size of tree may be streamed out. It may be bounded to the subtree
+ * of a node and to a no. of levels below it; a node whose children are cut
+ * off by the depth is followed by a note of how many it has.
  */
 class DotMatrix : public PrinterBase
 {
@@ -58,16 +63,24 @@ class DotMatrix : public PrinterBase
         DotMatrix(const TreeBase &t);
 
         void set_trail(BreadCrumbTrail &t);
+        void set_root(const NodeBase &n) { top = &n; } // Of the subtree
+        void set_depth(int levels) { depth = levels; } // Below it, 0 is all
     private:
         /* Member functions/methods */
         std::ostream& print(std::ostream &s, const NodeBase &n) const;
+        void print_tree(std::ostream &s, const NodeBase &n) const;
+        void print_trail(std::ostream &s, const NodeBase &n) const;
 
-        const NodeBase* node_from_trail(const NodeBase *&n);
+        const NodeBase* node_from_trail(const NodeBase *&n) const;
+        bool within(const NodeBase &n, const NodeBase &r) const;
         void print_vertex(std::ostream &s, const NodeBase &n) const;
         void print_edge(std::ostream &s, const ptrdiff_t e[2]) const;
+        void print_cut(std::ostream &s, const NodeBase &n) const;
 
         /* Member variables/attributes */
         BreadCrumbTrail *trail;
+        const NodeBase *top; // Root of the subtree printed, if not the tree
+        int depth; // Levels printed below the root, 0 for every level
 };
 
 std::ostream&
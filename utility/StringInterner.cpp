@@ -0,0 +1,147 @@
+// oodles
+#include "hash.hpp"
+#include "StringInterner.hpp"
+
+// Boost.thread
+#include <boost/thread/locks.hpp>
+
+// STL
+#include <new>
+#include <algorithm>
+
+// libc
+#include <string.h> // For memcmp(), memcpy()
+#include <stdlib.h> // For calloc(), free()
+#include <assert.h> // For assert()
+
+// Boost
+using boost::lock_guard;
+
+namespace oodles {
+
+/*
+ * The table of chunks is allocated zeroed in one go so it never moves
+ * (and its pages are only touched once a chunk is needed). The empty
+ * string is interned first, as id 0.
+ */
+StringInterner::StringInterner() :
+    chunks(static_cast<Entry**>(calloc(Chunks, sizeof(Entry*)))),
+    ids(0),
+    next(NULL),
+    end(NULL)
+{
+    if (!chunks)
+        throw std::bad_alloc();
+
+    intern("", 0);
+}
+
+StringInterner::~StringInterner()
+{
+    for (size_t i = 0 ; i < Chunks && chunks[i] ; ++i)
+        delete [] chunks[i];
+
+    for (size_t i = 0 ; i < slabs.size() ; ++i)
+        delete [] slabs[i];
+
+    free(chunks);
+}
+
+StringInterner::id_t
+StringInterner::intern(const char *s, size_t n)
+{
+    const lock_guard<boost::mutex> lock(mutex);
+    const Entry e = {s, static_cast<uint32_t>(n)};
+    const id_t *known = index.find(e);
+
+    if (known)
+        return *known;
+
+    assert(ids < 0xffffffff);
+
+    const id_t id = ids;
+    Entry *&chunk = chunks[id >> ChunkBits];
+
+    if (!chunk)
+        chunk = new Entry[ChunkMask + 1];
+
+    chunk[id & ChunkMask].data = store(s, n);
+    chunk[id & ChunkMask].size = e.size;
+    index.insert(chunk[id & ChunkMask], id);
+    ++ids;
+
+    return id;
+}
+
+size_t
+StringInterner::memory() const
+{
+    const size_t c = (ids + ChunkMask) >> ChunkBits;
+
+    return Chunks * sizeof(Entry*) + c * (ChunkMask + 1) * sizeof(Entry) +
+           slabs.size() * SlabSize + index.memory();
+}
+
+StringInterner&
+StringInterner::global()
+{
+    static StringInterner labels;
+    return labels;
+}
+
+/*
+ * Copy n characters of s, and a NUL, to the current slab; a string too
+ * long for a slab is given one of its own.
+ */
+const char*
+StringInterner::store(const char *s, size_t n)
+{
+    char *d = NULL;
+
+    if (n + 1 > SlabSize) {
+        d = new char[n + 1];
+        slabs.push_back(d);
+    } else {
+        if (next + n + 1 > end) {
+            next = new char[SlabSize];
+            end = next + SlabSize;
+            slabs.push_back(next);
+        }
+
+        d = next;
+        next += n + 1;
+    }
+
+    memcpy(d, s, n);
+    d[n] = '\0';
+
+    return d;
+}
+
+bool
+StringInterner::Entry::operator== (const Entry &e) const
+{
+    return size == e.size && memcmp(data, e.data, size) == 0;
+}
+
+size_t
+StringInterner::hash_entry::operator() (const Entry &e) const
+{
+    return fnv32(e.data, e.size);
+}
+
+// Label
+
+bool
+Label::less_text(const Label &lhs, const Label &rhs)
+{
+    if (lhs.label == rhs.label)
+        return false;
+
+    const size_t l = lhs.size(), r = rhs.size();
+    const int c = memcmp(lhs.data(), rhs.data(), std::min(l, r));
+
+    return c < 0 || (c == 0 && l < r);
+}
+
+} // oodles
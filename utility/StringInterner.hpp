@@ -0,0 +1,145 @@
+#ifndef OODLES_STRINGINTERNER_HPP
+#define OODLES_STRINGINTERNER_HPP
+
+// oodles
+#include "FlatHashMap.hpp"
+
+// Boost.thread
+#include <boost/thread/mutex.hpp>
+
+// STL
+#include <string>
+#include <vector>
+#include <iostream>
+
+// libc
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+
+/*
+ * Maps strings to dense 32-bit ids, each string being held just once for
+ * the life of the interner; nothing is ever removed. Id 0 is always the
+ * empty string.
+ *
+ * Interning a string takes a lock but looking up the text of an id never
+ * does. The text of every id is NUL terminated and stays at the address
+ * first given out for it, as the characters are copied into slabs that are
+ * never moved and the (pointer, size) entry of each id is held in chunks
+ * that are never moved either.
+ */
+class StringInterner
+{
+    public:
+        /* Dependent typedefs */
+        typedef uint32_t id_t;
+
+        /* Member functions/methods */
+        StringInterner();
+        ~StringInterner();
+
+        id_t intern(const char *s, size_t n);
+        id_t intern(const std::string &s) { return intern(s.data(), s.size()); }
+
+        const char* data(id_t id) const { return entry(id).data; }
+        size_t size(id_t id) const { return entry(id).size; }
+
+        size_t count() const { return ids; } // No. of strings interned
+        size_t memory() const; // Bytes held, roughly
+
+        static StringInterner& global(); // That of every Label
+    private:
+        /* Internal Data Structures */
+        enum {
+            ChunkBits = 16, // Entries per chunk: 65536
+            ChunkMask = (1 << ChunkBits) - 1,
+            Chunks = 1 << (32 - ChunkBits),
+            SlabSize = 64 << 10 // Bytes of text per slab, bar longer strings
+        };
+
+        struct Entry
+        {
+            const char *data;
+            uint32_t size;
+
+            bool operator== (const Entry &e) const;
+        };
+
+        struct hash_entry
+        {
+            size_t operator() (const Entry &e) const;
+        };
+
+        /* Member variables/attributes */
+        Entry **chunks; // Of ChunkMask + 1 entries each, by id
+        id_t ids; // No. of ids given out
+        char *next, *end; // Remainder of the current slab
+        std::vector<char*> slabs;
+        FlatHashMap<Entry, id_t, hash_entry> index; // By text
+        boost::mutex mutex; // Held to intern a string
+
+        /* Member functions/methods */
+        const Entry& entry(id_t id) const
+        {
+            return chunks[id >> ChunkBits][id & ChunkMask];
+        }
+
+        const char* store(const char *s, size_t n);
+
+        StringInterner(const StringInterner &s); // Do not allow...
+        StringInterner& operator= (const StringInterner &s); // ... copying.
+};
+
+/*
+ * A string interned by the global StringInterner, held (and compared) as
+ * its id. Labels are ordered by id, which is the order they were first
+ * interned in, not that of their text; less_text() orders them by text.
+ */
+class Label
+{
+    public:
+        /* Dependent typedefs */
+        typedef StringInterner::id_t id_t;
+
+        /* Member functions/methods */
+        Label() : label(0) {}
+        explicit Label(const std::string &s) :
+            label(StringInterner::global().intern(s)) {}
+        Label(const char *s, size_t n) :
+            label(StringInterner::global().intern(s, n)) {}
+
+        id_t id() const { return label; }
+        bool empty() const { return label == 0; }
+        const char* data() const
+        {
+            return StringInterner::global().data(label);
+        }
+        size_t size() const { return StringInterner::global().size(label); }
+        std::string str() const { return std::string(data(), size()); }
+
+        bool operator< (const Label &rhs) const { return label < rhs.label; }
+        bool operator== (const Label &rhs) const { return label == rhs.label; }
+        bool operator!= (const Label &rhs) const { return label != rhs.label; }
+        bool operator== (const std::string &rhs) const
+        {
+            return rhs.compare(0, rhs.size(), data(), size()) == 0;
+        }
+
+        static bool less_text(const Label &lhs, const Label &rhs);
+    private:
+        /* Member variables/attributes */
+        id_t label;
+};
+
+static
+inline
+std::ostream&
+operator<< (std::ostream &stream, const Label &label)
+{
+    return stream.write(label.data(), label.size());
+}
+
+} // oodles
+
+#endif
@@ -43,8 +43,10 @@ Subscriber::unsubscribe_from(Event &e)
     map<Event*, Locator>::iterator i = events.find(&e);
     bool found = i != events.end();
 
-    if (found)
+    if (found) {
         e.subscribers.erase(i->second);
+        events.erase(i); // Else our destructor visits an Event now gone
+    }
 
     return found;
 }
@@ -0,0 +1,76 @@
+#ifndef OODLES_TIMINGWHEEL_HPP // Interface
+#define OODLES_TIMINGWHEEL_HPP
+
+// STL
+#include <vector>
+
+// libc
+#include <stddef.h> // For size_t
+#include <stdint.h> // For uint64_t
+
+namespace oodles {
+
+/*
+ * A hierarchical timing wheel (Varghese & Lauck). Timers are bucketed by
+ * the tick they expire on into one of Levels wheels of Slots slots each;
+ * the lowest wheel has single tick slots and each wheel above it slots
+ * Slots times as wide. As time advances past a slot in an upper wheel the
+ * timers within it are cascaded down to the finer wheels beneath it.
+ *
+ * Scheduling a timer is O(1) as is the amortised cost of expiring one.
+ * Timers cannot be cancelled; the owner of T should ignore stale timers.
+ */
+template<class T>
+class TimingWheel
+{
+    public:
+        /* Dependent typedefs */
+        typedef uint64_t tick_t;
+
+        /* Member functions/methods */
+        TimingWheel(tick_t now = 0);
+
+        void schedule(const T &item, tick_t expiry);
+        void advance(tick_t now, std::vector<T> &expired);
+
+        tick_t current() const { return ticks; }
+        size_t size() const { return count; }
+    private:
+        /* Internal Data Structures */
+        enum {
+            LevelBits = 8,
+            Slots = 1 << LevelBits,
+            Levels = 4
+        };
+
+        struct Timer {
+            T item;
+            tick_t expiry;
+
+            Timer(const T &i, tick_t e) : item(i), expiry(e) {}
+        };
+
+        typedef std::vector<Timer> Slot;
+
+        /* Member variables/attributes */
+        tick_t ticks; // Current time
+        size_t count; // No. of timers pending
+        size_t pending[Levels + 1]; // No. of timers on each wheel/overflow
+        Slot wheels[Levels][Slots];
+        Slot overflow; // Timers beyond the range of the upper wheel
+
+        /* Member functions/methods */
+        static tick_t mask(int levels)
+        {
+            return (tick_t(1) << (LevelBits * levels)) - 1; // Low order ticks
+        }
+
+        void insert(const Timer &t);
+        void cascade(Slot &s, int level);
+};
+
+} // oodles
+
+#include "TimingWheel.ipp" // Implementation
+
+#endif
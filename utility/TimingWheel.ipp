@@ -0,0 +1,130 @@
+#ifndef OODLES_TIMINGWHEEL_IPP // Implementation
+#define OODLES_TIMINGWHEEL_IPP
+
+namespace oodles {
+
+template<class T>
+TimingWheel<T>::TimingWheel(tick_t now) : ticks(now), count(0)
+{
+    for (int i = 0 ; i <= Levels ; ++i)
+        pending[i] = 0;
+}
+
+/*
+ * Any timer at or before the current time expires on the next advance()
+ */
+template<class T>
+void
+TimingWheel<T>::schedule(const T &item, tick_t expiry)
+{
+    insert(Timer(item, expiry > ticks ? expiry : ticks + 1));
+    ++count;
+}
+
+/*
+ * Move the current time forward to now, appending the item of every timer
+ * that expires in doing so to expired (in order of expiry).
+ */
+template<class T>
+void
+TimingWheel<T>::advance(tick_t now, std::vector<T> &expired)
+{
+    while (ticks < now) {
+        int lowest = 0;
+
+        while (lowest <= Levels && pending[lowest] == 0)
+            ++lowest;
+
+        if (lowest > Levels) {
+            ticks = now; // Nothing to expire, jump straight there
+            break;
+        }
+
+        /*
+         * With the lower wheels empty nothing can happen until the next
+         * slot of the lowest occupied wheel is entered, so skip to it.
+         */
+        if (lowest > 0) {
+            const tick_t last = ticks | mask(lowest);
+
+            if (last >= now) {
+                ticks = now;
+                break;
+            }
+
+            ticks = last;
+        }
+
+        ++ticks;
+
+        /*
+         * Cascade each upper wheel whose slot has just been entered. The
+         * wheel above is always cascaded first so its timers can reach
+         * the wheel beneath before that too is cascaded.
+         */
+        if ((ticks & (Slots - 1)) == 0) {
+            int level = 1;
+
+            while (level < Levels && (ticks & mask(level + 1)) == 0)
+                ++level;
+
+            if (level == Levels) { // The upper wheel has turned full circle
+                cascade(overflow, Levels);
+                --level;
+            }
+
+            for ( ; level > 0 ; --level)
+                cascade(wheels[level][(ticks >> (LevelBits * level)) &
+                                      (Slots - 1)], level);
+        }
+
+        Slot &s = wheels[0][ticks & (Slots - 1)];
+
+        for (size_t i = 0 ; i < s.size() ; ++i)
+            expired.push_back(s[i].item);
+
+        count -= s.size();
+        pending[0] -= s.size();
+        s.clear();
+    }
+}
+
+/*
+ * A timer is placed on the lowest wheel whose span (from the start of the
+ * current slot of the wheel above) includes its expiry.
+ */
+template<class T>
+void
+TimingWheel<T>::insert(const Timer &t)
+{
+    for (int level = 0 ; level < Levels ; ++level) {
+        const int shift = LevelBits * (level + 1);
+
+        if ((t.expiry >> shift) == (ticks >> shift)) {
+            wheels[level][(t.expiry >> (LevelBits * level)) &
+                          (Slots - 1)].push_back(t);
+            ++pending[level];
+            return;
+        }
+    }
+
+    overflow.push_back(t);
+    ++pending[Levels];
+}
+
+template<class T>
+void
+TimingWheel<T>::cascade(Slot &s, int level)
+{
+    Slot timers;
+
+    timers.swap(s); // Timers may be re-inserted into this very slot
+    pending[level] -= timers.size();
+
+    for (size_t i = 0 ; i < timers.size() ; ++i)
+        insert(timers[i]);
+}
+
+} // oodles
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef OODLES_TOURNAMENTTREE_HPP // Interface
+#define OODLES_TOURNAMENTTREE_HPP
+
+// STL
+#include <vector>
+#include <functional>
+
+// libc
+#include <stdint.h> // For uint32_t
+
+namespace oodles {
+
+/*
+ * An indexed tournament (winner) tree. Every slot may hold a key or be
+ * disabled. The slot holding the greatest key (according to Compare) always
+ * sits at the apex so is found in O(1). Updating, enabling or disabling any
+ * slot only replays the matches along its path to the apex, O(log n).
+ *
+ * Ties are won by the higher slot index so the result matches a linear scan
+ * over the slots that keeps the last of any equally weighted candidates.
+ */
+template<class Key, class Compare = std::less<Key> >
+class TournamentTree
+{
+    public:
+        /* Dependent typedefs */
+        typedef uint32_t slot_t;
+
+        /* Member functions/methods */
+        TournamentTree();
+
+        void clear();
+        void disable(slot_t slot);
+        void update(slot_t slot, const Key &key);
+
+        int32_t top() const; // Winning slot or -1 if no slot is enabled
+        size_t size() const { return slots; }
+        bool enabled(slot_t slot) const;
+    private:
+        /* Internal Data Structures */
+        struct Entry {
+            Key key;
+            bool active;
+
+            Entry() : key(), active(false) {}
+        };
+
+        /* Member variables/attributes */
+        Compare cmp;
+        slot_t slots; // Highest slot ever used + 1
+        slot_t capacity; // Always a power of two
+        std::vector<Entry> entries;
+
+        /*
+         * Winners of each match. Leaves live at [capacity, 2 * capacity) and
+         * the overall winner (the apex) at subscript 1.
+         */
+        std::vector<slot_t> matches;
+
+        /* Member functions/methods */
+        void grow(slot_t slot);
+        void replay(slot_t slot);
+        slot_t winner(slot_t a, slot_t b) const;
+};
+
+} // oodles
+
+#include "TournamentTree.ipp" // Implementation
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef OODLES_TOURNAMENTTREE_IPP // Implementation
+#define OODLES_TOURNAMENTTREE_IPP
+
+// libc
+#include <assert.h> // For assert()
+
+namespace oodles {
+
+template<class Key, class Compare>
+TournamentTree<Key, Compare>::TournamentTree() : slots(0), capacity(0)
+{
+}
+
+template<class Key, class Compare>
+void
+TournamentTree<Key, Compare>::clear()
+{
+    slots = capacity = 0;
+    entries.clear();
+    matches.clear();
+}
+
+template<class Key, class Compare>
+void
+TournamentTree<Key, Compare>::disable(slot_t slot)
+{
+    if (slot >= slots || !entries[slot].active)
+        return; // Never enabled, so there is nothing to replay
+
+    entries[slot].active = false;
+    replay(slot);
+}
+
+template<class Key, class Compare>
+void
+TournamentTree<Key, Compare>::update(slot_t slot, const Key &key)
+{
+    if (slot >= capacity)
+        grow(slot);
+
+    if (slot >= slots)
+        slots = slot + 1;
+
+    Entry &e = entries[slot];
+
+    /*
+     * Avoid replaying the matches when nothing has changed
+     */
+    if (e.active && !cmp(e.key, key) && !cmp(key, e.key))
+        return;
+
+    e.key = key;
+    e.active = true;
+    replay(slot);
+}
+
+template<class Key, class Compare>
+int32_t
+TournamentTree<Key, Compare>::top() const
+{
+    if (!capacity)
+        return -1;
+
+    const slot_t s = matches[1];
+
+    return entries[s].active ? static_cast<int32_t>(s) : -1;
+}
+
+template<class Key, class Compare>
+bool
+TournamentTree<Key, Compare>::enabled(slot_t slot) const
+{
+    return slot < slots && entries[slot].active;
+}
+
+/*
+ * Double the capacity until slot fits and replay every match. The cost
+ * is amortised across all of the insertions that caused the growth.
+ */
+template<class Key, class Compare>
+void
+TournamentTree<Key, Compare>::grow(slot_t slot)
+{
+    slot_t c = capacity ? capacity : 1;
+
+    while (c <= slot)
+        c <<= 1;
+
+    capacity = c;
+    entries.resize(c);
+    matches.resize(c << 1);
+
+    for (slot_t i = 0 ; i < c ; ++i)
+        matches[c + i] = i;
+
+    for (slot_t i = c - 1 ; i > 0 ; --i)
+        matches[i] = winner(matches[i << 1], matches[(i << 1) + 1]);
+}
+
+template<class Key, class Compare>
+void
+TournamentTree<Key, Compare>::replay(slot_t slot)
+{
+    assert(slot < capacity);
+
+    for (slot_t i = (capacity + slot) >> 1 ; i > 0 ; i >>= 1)
+        matches[i] = winner(matches[i << 1], matches[(i << 1) + 1]);
+}
+
+template<class Key, class Compare>
+typename TournamentTree<Key, Compare>::slot_t
+TournamentTree<Key, Compare>::winner(slot_t a, slot_t b) const
+{
+    const Entry &x = entries[a], &y = entries[b];
+
+    if (!x.active)
+        return b;
+
+    if (!y.active)
+        return a;
+
+    if (cmp(x.key, y.key))
+        return b;
+
+    if (cmp(y.key, x.key))
+        return a;
+
+    return a > b ? a : b; // Prefer the later slot on a tie
+}
+
+} // oodles
+
+#endif
@@ -61,13 +61,8 @@ Tree<Type>::depth_first_traverse(Node<Type> &n) const
 {
     visit(n);
 
-    if (n.leaf())
-        return;
-
-    typename Node<Type>::const_iterator i = n.children.begin(),
-                                        j = n.children.end();
-    for ( ; i != j ; ++i)
-        depth_first_traverse(*(*i));
+    for (size_t i = 0 ; i < n.size() ; ++i)
+        depth_first_traverse(static_cast<Node<Type>&>(n.child(i)));
 }
 
 template<class Type>
@@ -77,16 +72,14 @@ Tree<Type>::breadth_first_traverse(Node<Type> &n) const
     if (n.leaf())
         return;
 
-    typename Node<Type>::const_iterator i = n.children.begin(),
-                                        j = n.children.end();
-    for ( ; i != j ; ++i)
-        visit(*(*i));
+    for (size_t i = 0 ; i < n.size() ; ++i)
+        visit(static_cast<Node<Type>&>(n.child(i)));
 
     visit(n);
 
     /* FIXME: Pretty lame having to loop twice! */
-    for (i = n.children.begin() ; i != j ; ++i)
-        breadth_first_traverse(*(*i));
+    for (size_t i = 0 ; i < n.size() ; ++i)
+        breadth_first_traverse(static_cast<Node<Type>&>(n.child(i)));
 }
 
 template<class Type>
@@ -0,0 +1,87 @@
+#ifndef OODLES_BYTES_HPP
+#define OODLES_BYTES_HPP
+
+/*
+ * Packing and unpacking of fixed-width integers and length-prefixed
+ * strings to and from raw byte buffers (in host byte order).
+ */
+
+// oodles
+#include "common/Exceptions.hpp"
+
+// STL
+#include <string>
+
+// libc
+#include <stdint.h> // For uint32_t
+#include <string.h> // For memcpy()
+
+namespace oodles {
+
+template<typename Type>
+inline
+void
+put_bytes(std::string &output, const Type &value)
+{
+    output.append(reinterpret_cast<const char*>(&value), sizeof(Type));
+}
+
+inline
+void
+put_string(std::string &output, const std::string &value)
+{
+    put_bytes(output, static_cast<uint32_t>(value.size()));
+    output.append(value);
+}
+
+class ByteReader
+{
+    public:
+        /* Member functions/methods */
+        ByteReader(const char *buffer, size_t size) :
+            begin(buffer),
+            cursor(buffer),
+            end(buffer + size)
+        {}
+
+        bool empty() const { return cursor == end; }
+        size_t offset() const { return cursor - begin; }
+        size_t remaining() const { return end - cursor; }
+
+        template<typename Type>
+        Type get() throw (ReadError)
+        {
+            Type value;
+
+            memcpy(&value, take(sizeof(Type)), sizeof(Type)); // Unaligned
+
+            return value;
+        }
+
+        std::string get_string() throw (ReadError)
+        {
+            const uint32_t n = get<uint32_t>();
+            return std::string(take(n), n);
+        }
+
+        const char* take(size_t n) throw (ReadError)
+        {
+            if (n > remaining())
+                throw ReadError("ByteReader::take", 0,
+                                "Read of %lu bytes exceeds the %lu remaining.",
+                                static_cast<unsigned long>(n),
+                                static_cast<unsigned long>(remaining()));
+
+            const char *p = cursor;
+            cursor += n;
+
+            return p;
+        }
+    private:
+        /* Member variables/attributes */
+        const char *begin, *cursor, *end;
+};
+
+} // oodles
+
+#endif
@@ -46,5 +46,24 @@ fnv32(const char *input, size_t size, uint32_t seed)
     return f(input, size, seed);
 }
 
+/*
+ * Jump consistent hash (Lamping & Veach), without any table. When n grows
+ * to n + 1 only 1/(n + 1) of the keys move, every one to the new bucket.
+ */
+uint32_t
+jump(uint64_t key, uint32_t n)
+{
+    int64_t b = -1, j = 0;
+
+    while (j < n) {
+        b = j;
+        key = key * 2862933555777941757U + 1;
+        j = static_cast<int64_t>((b + 1) * (double(1U << 31) /
+                                            double((key >> 33) + 1)));
+    }
+
+    return static_cast<uint32_t>(b);
+}
+
 } // oodles
 
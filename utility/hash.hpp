@@ -19,6 +19,11 @@ uint32_t fnv32(const char *input, size_t size, uint32_t seed = 0);
 uint64_t fnv64(const char *input, size_t size, uint64_t seed = 0);
 #endif
 
+/*
+ * Consistent hash (jump) of key to one of n buckets
+ */
+uint32_t jump(uint64_t key, uint32_t n);
+
 } // oodles
 
 #endif